@@ -31,6 +31,7 @@
 #include <mutex>
 #include <functional> //std::functions
 #include <stack>
+#include <set>
 #include <condition_variable>
 
 /**
@@ -70,8 +71,12 @@ class MessageProcessor
 
         std::condition_variable data_cond;
 
-        BPApiRepSysMsgHdl       m_last_msgHdl;
-        BPApiTime               m_last_ts; // unused but maybe usefull
+        // cursor of NewMsgRetriever : last message seen, its timestamp,
+        // the messages already seen with this timestamp and the message count at the last scan
+        BPApiRepSysMsgHdl               m_last_msgHdl;
+        BPApiTime                       m_last_ts;
+        std::set<BPApiRepSysMsgHdl>     m_last_tsHdls;
+        uint32_t                        m_last_msgCount;
     
         std::thread             m_msgQSetterThread;
         std::thread             m_msgQGetterThread;
@@ -80,6 +85,15 @@ class MessageProcessor
         // in progress
         bool                    init(void);
 
+        // messages arrived after the cursor, oldest first (walk back from the last message)
+        std::vector<Message *>  retrieveNewMsgs(BPApiRepSysMsgClass p_msgClassId, uint32_t p_msgCount);
+
+        // the message was already seen : same timestamp as the cursor, handle seen with it
+        bool                    isCursor(Message &p_msg) const;
+
+        // move the cursor on a message seen
+        void                    setCursor(Message &p_msg);
+
 };
 
 #endif
\ No newline at end of file
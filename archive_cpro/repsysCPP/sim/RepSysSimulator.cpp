@@ -0,0 +1,457 @@
+/**
+ * SEPRO ROBOTIQUE SAS © 2020 - 2021
+ * Ce contenu est la propriété pleine, entière et exclusive de SEPRO GROUP.
+ *
+ * INFORMATIONS CONFIDENTIELLES.
+ * Ce contenu ne peut être communiqué ou divulgué à des tiers que sous réserve
+ * de la signature préalable d’un accord de confidentialité avec SEPRO GROUP
+ * et avec l’autorisation préalable et écrite de SEPRO GROUP.
+ *
+ * This content is the full, sole and exclusive property of SEPRO GROUP.
+ *
+ * CONFIDENTIAL INFORMATION.
+ * This content may only be communicated or disclosed to third parties after
+ * signing a confidentiality agreement with SEPRO GROUP and with the
+ * written permission of SEPRO GROUP
+ *
+ * @file RepSysSimulator.cpp
+ * @version 0.1
+ */
+
+#include "RepSysSimulator.hpp"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#define SAFETY_COMP_NR		100
+#define OTHER_COMP_NR		50
+#define GENERATOR_TICK		1 // ms
+
+/**
+ * @brief
+ * Construct the simulator with the default configuration
+ *
+ */
+RepSysSimulator::RepSysSimulator() : m_nextHdl(1), m_nextArrival(1), m_nextInstNr(1), m_random(1), m_running(false){
+}
+
+RepSysSimulator	&RepSysSimulator::instance(void){
+	static RepSysSimulator *simulator = new RepSysSimulator();
+
+	return *simulator;
+}
+
+void	RepSysSimulator::configure(const RepSysSimConfig &config){
+	stop();
+
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	m_config = config;
+	m_stats = RepSysSimStats();
+	m_msgs.clear();
+	m_hdls.clear();
+	m_freeHdls.clear();
+	m_createdUs.clear();
+	m_nextHdl = 1;
+	m_nextArrival = 1;
+	m_nextInstNr = 1;
+	m_random = config.seed ? config.seed : 1;
+}
+
+void	RepSysSimulator::start(void){
+	if (m_running.exchange(true))
+		return;
+	m_generatorThread = std::thread(&RepSysSimulator::generatorLoop, this);
+}
+
+void	RepSysSimulator::stop(void){
+	m_running = false;
+	if (m_generatorThread.joinable())
+		m_generatorThread.join();
+}
+
+BPApiRepSysMsgHdl	RepSysSimulator::generate(uint32_t p_count){
+	std::lock_guard<std::mutex>	guard(m_mutex);
+	BPApiRepSysMsgHdl			msgHdl = 0;
+	uint64_t					now = nowUs();
+
+	for (uint32_t i = 0; i < p_count; i++)
+		msgHdl = addGenerated(now);
+	return msgHdl;
+}
+
+RepSysSimStats	RepSysSimulator::stats(void){
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	return m_stats;
+}
+
+/**
+ * @brief
+ * Each BPApiRepSys function starts here : the configured latency (IPC to the controller) and its call counter
+ * the latency is spent outside the lock, like concurrent calls to the controller
+ *
+ * @param p_function
+ */
+void	RepSysSimulator::call(const char *p_function){
+	uint32_t latencyUs;
+
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+
+		m_stats.calls[p_function]++;
+		latencyUs = m_config.callLatencyUs;
+	}
+	if (latencyUs)
+		std::this_thread::sleep_for(std::chrono::microseconds(latencyUs));
+}
+
+/**
+ * @brief
+ * A message set by the application (the reporter forwards in classes 13 to 15) : counted, not listed
+ * the forwarding latency is measured for the generated messages (same instNr)
+ *
+ */
+BPApiState	RepSysSimulator::setMsg(BPApiRepSysMsgClass classId, uint32_t compNr, uint32_t instNr, uint32_t msgNr, const std::string &text){
+	std::lock_guard<std::mutex>	guard(m_mutex);
+	auto						created = m_createdUs.find(instNr);
+
+	m_stats.forwarded++;
+	if (compNr == SAFETY_COMP_NR && created != m_createdUs.end())
+	{
+		m_stats.forwardedKnown++;
+		m_stats.latenciesUs.push_back(nowUs() - created->second);
+		m_createdUs.erase(created);
+	}
+	return BPApiStateOk;
+}
+
+BPApiState	RepSysSimulator::quitMsg(BPApiRepSysMsgClass classId, uint32_t compNr, uint32_t instNr, uint32_t msgNr){
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	for (auto msg = m_msgs.begin(); msg != m_msgs.end(); ++msg)
+	{
+		if (msg->second.classId != classId || msg->second.compNr != compNr ||
+			msg->second.instNr != instNr || msg->second.msgNr != msgNr)
+			continue;
+
+		// a message to reset and quit stays until its reset
+		if (msg->second.state == BPApiRepSysMsgStateToResetAndQuit)
+			msg->second.state = BPApiRepSysMsgStateToReset;
+		else
+			eraseMsg(msg);
+		return BPApiStateOk;
+	}
+	return BPApiStateRepSysInvalidHandle;
+}
+
+BPApiState	RepSysSimulator::firstMsg(uint32_t classMask, BPApiRepSysMsgHdl *msgHdl){
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	for (auto msg = m_msgs.begin(); msg != m_msgs.end(); ++msg)
+		if (msg->second.classId & classMask)
+		{
+			*msgHdl = msg->second.hdl;
+			return BPApiStateOk;
+		}
+	return BPApiStateRepSysFunctionFaild;
+}
+
+BPApiState	RepSysSimulator::lastMsg(uint32_t classMask, BPApiRepSysMsgHdl *msgHdl){
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	for (auto msg = m_msgs.rbegin(); msg != m_msgs.rend(); ++msg)
+		if (msg->second.classId & classMask)
+		{
+			*msgHdl = msg->second.hdl;
+			return BPApiStateOk;
+		}
+	return BPApiStateRepSysFunctionFaild;
+}
+
+/**
+ * @brief
+ * Next message of the mask after *msgHdl, which must still be in the list
+ *
+ */
+BPApiState	RepSysSimulator::nextMsg(uint32_t classMask, BPApiRepSysMsgHdl *msgHdl){
+	std::lock_guard<std::mutex>	guard(m_mutex);
+	auto						msg = findMsg(*msgHdl);
+
+	if (msg == m_msgs.end())
+		return BPApiStateRepSysInvalidHandle;
+	for (++msg; msg != m_msgs.end(); ++msg)
+		if (msg->second.classId & classMask)
+		{
+			*msgHdl = msg->second.hdl;
+			return BPApiStateOk;
+		}
+	return BPApiStateRepSysFunctionFaild;
+}
+
+BPApiState	RepSysSimulator::prevMsg(uint32_t classMask, BPApiRepSysMsgHdl *msgHdl){
+	std::lock_guard<std::mutex>	guard(m_mutex);
+	auto						msg = findMsg(*msgHdl);
+
+	if (msg == m_msgs.end())
+		return BPApiStateRepSysInvalidHandle;
+	while (msg != m_msgs.begin())
+	{
+		--msg;
+		if (msg->second.classId & classMask)
+		{
+			*msgHdl = msg->second.hdl;
+			return BPApiStateOk;
+		}
+	}
+	return BPApiStateRepSysFunctionFaild;
+}
+
+BPApiState	RepSysSimulator::msgCount(uint32_t classMask, uint32_t *count){
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	*count = 0;
+	for (const auto &msg : m_msgs)
+		if (msg.second.classId & classMask)
+			(*count)++;
+	return BPApiStateOk;
+}
+
+BPApiState	RepSysSimulator::msgDataValues(BPApiRepSysMsgHdl msgHdl, BPApiRepSysMsgClass *classId, uint32_t *compNr, uint32_t *instNr,
+										   uint32_t *msgNr, BPApiTime *timeStamp, uint32_t *paramCount, BPApiRepSysMsgState *msgState,
+										   uint32_t *protocolVar){
+	std::lock_guard<std::mutex>	guard(m_mutex);
+	auto						msg = findMsg(msgHdl);
+
+	if (msg == m_msgs.end())
+		return BPApiStateRepSysInvalidHandle;
+
+	*classId = msg->second.classId;
+	*compNr = msg->second.compNr;
+	*instNr = msg->second.instNr;
+	*msgNr = msg->second.msgNr;
+	*timeStamp = msg->second.ts;
+	*paramCount = 0;
+	*msgState = msg->second.state;
+	msg->second.isRead = true;
+	if (protocolVar)
+		*protocolVar = 0;
+	return BPApiStateOk;
+}
+
+BPApiState	RepSysSimulator::formatMsg(BPApiRepSysMsgHdl msgHdl, char *buffer, uint32_t bufLen){
+	std::lock_guard<std::mutex>	guard(m_mutex);
+	auto						msg = findMsg(msgHdl);
+
+	if (msg == m_msgs.end())
+		return BPApiStateRepSysInvalidHandle;
+	if (bufLen == 0)
+		return BPApiStateRepSysBufferTooSmall;
+	snprintf(buffer, bufLen, "%s", msg->second.text.c_str());
+	return BPApiStateOk;
+}
+
+/**
+ * @brief
+ * Launched in a new thread
+ * every GENERATOR_TICK : the messages due by the rate since the start, a burst when its period is over,
+ * the messages older than lifetimeMs are quitted
+ *
+ */
+void	RepSysSimulator::generatorLoop(void){
+	uint64_t	startUs = nowUs();
+	uint64_t	nextBurstUs = startUs;
+	uint64_t	steadyCount = 0;
+
+	while (m_running)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(GENERATOR_TICK));
+
+		std::lock_guard<std::mutex>	guard(m_mutex);
+		uint64_t					now = nowUs();
+		uint64_t					due = (uint64_t)(m_config.rate * (double)(now - startUs) / 1e6);
+
+		for (; steadyCount < due; steadyCount++)
+			addGenerated(now);
+
+		if (m_config.burstSize && now >= nextBurstUs)
+		{
+			for (uint32_t i = 0; i < m_config.burstSize; i++)
+				addGenerated(now);
+			nextBurstUs = now + (uint64_t)m_config.burstPeriodMs * 1000;
+		}
+
+		// the oldest messages first
+		while (m_config.lifetimeMs && !m_msgs.empty() &&
+			   m_msgs.begin()->second.createdUs + (uint64_t)m_config.lifetimeMs * 1000 <= now)
+			eraseMsg(m_msgs.begin());
+	}
+}
+
+/**
+ * @brief
+ * A new message, class drawn from classMix, compNr 100 for safetyPercent of them
+ * the oldest message leaves a full list (capacity), counted in evictedUnread if the reporter never read it
+ * reuseHandles : the new message takes the last handle released, the one of the oldest message if the list was full
+ *
+ * @param p_nowUs
+ * @return BPApiRepSysMsgHdl
+ */
+BPApiRepSysMsgHdl	RepSysSimulator::addGenerated(uint64_t p_nowUs){
+	SimMsg		msg;
+	uint32_t	totalWeight = 0;
+	uint32_t	draw;
+	timespec	now;
+
+	msg.classId = BPApiRepSysMsgClassError;
+	for (const auto &weight : m_config.classMix)
+		totalWeight += weight.second;
+	if (totalWeight)
+	{
+		draw = nextRandom() % totalWeight;
+		for (const auto &weight : m_config.classMix)
+		{
+			if (draw < weight.second)
+			{
+				msg.classId = weight.first;
+				break;
+			}
+			draw -= weight.second;
+		}
+	}
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	msg.compNr = nextRandom() % 100 < m_config.safetyPercent ? SAFETY_COMP_NR : OTHER_COMP_NR;
+	msg.instNr = m_nextInstNr++;
+	msg.msgNr = 1000 + msg.classId;
+	msg.ts = { (uint32_t)now.tv_sec, (uint32_t)now.tv_nsec };
+	msg.state = (msg.instNr % 2) ? BPApiRepSysMsgStateToQuit : BPApiRepSysMsgStateToReset;
+	msg.text = "SIM " + std::to_string(msg.compNr) + "/" + std::to_string(msg.msgNr) + " inst " + std::to_string(msg.instNr);
+	msg.createdUs = p_nowUs;
+	msg.isRead = false;
+
+	// a message already read can still be forwarded : its creation time is kept until setMsg
+	if (m_config.capacity && m_msgs.size() >= m_config.capacity)
+	{
+		const SimMsg	&oldest = m_msgs.begin()->second;
+
+		if (!oldest.isRead && oldest.compNr == SAFETY_COMP_NR)
+		{
+			m_createdUs.erase(oldest.instNr);
+			m_stats.evictedUnread++;
+		}
+		eraseMsg(m_msgs.begin());
+		m_stats.evicted++;
+	}
+
+	m_stats.generated++;
+	if (msg.compNr == SAFETY_COMP_NR)
+	{
+		m_stats.generatedSafety++;
+		m_createdUs[msg.instNr] = p_nowUs;
+	}
+
+	if (m_config.reuseHandles && !m_freeHdls.empty())
+	{
+		msg.hdl = m_freeHdls.back();
+		m_freeHdls.pop_back();
+	}
+	else
+		msg.hdl = m_nextHdl++;
+
+	BPApiRepSysMsgHdl msgHdl = msg.hdl;
+
+	m_hdls[msgHdl] = m_nextArrival;
+	m_msgs.emplace(m_nextArrival++, std::move(msg));
+	return msgHdl;
+}
+
+std::map<uint64_t, RepSysSimulator::SimMsg>::iterator	RepSysSimulator::findMsg(BPApiRepSysMsgHdl p_msgHdl){
+	auto arrival = m_hdls.find(p_msgHdl);
+
+	return arrival == m_hdls.end() ? m_msgs.end() : m_msgs.find(arrival->second);
+}
+
+void	RepSysSimulator::eraseMsg(std::map<uint64_t, SimMsg>::iterator p_msg){
+	m_hdls.erase(p_msg->second.hdl);
+	if (m_config.reuseHandles)
+		m_freeHdls.push_back(p_msg->second.hdl);
+	m_msgs.erase(p_msg);
+}
+
+// xorshift32, reproductible par seed
+uint32_t	RepSysSimulator::nextRandom(void){
+	m_random ^= m_random << 13;
+	m_random ^= m_random >> 17;
+	m_random ^= m_random << 5;
+	return m_random;
+}
+
+uint64_t	RepSysSimulator::nowUs(void){
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// --- BPApiRepSys.h functions, in place of libBPApi.so ---
+
+BPApiState BPApiRepSysSetMsgA(BPApiRepSysMsgClass classId, uint32_t compNr, uint32_t instNr, uint32_t msgNr, const char *format, ...){
+	char	text[512];
+	va_list	args;
+
+	RepSysSimulator::instance().call(__func__);
+	va_start(args, format);
+	vsnprintf(text, sizeof(text), format, args);
+	va_end(args);
+	return RepSysSimulator::instance().setMsg(classId, compNr, instNr, msgNr, text);
+}
+
+BPApiState BPApiRepSysQuitMsg(BPApiRepSysMsgClass classId, uint32_t compNr, uint32_t instNr, uint32_t msgNr){
+	RepSysSimulator::instance().call(__func__);
+	return RepSysSimulator::instance().quitMsg(classId, compNr, instNr, msgNr);
+}
+
+BPApiState BPApiRepSysGetFirstMsg(uint32_t classMask, BPApiRepSysMsgHdl *msgHdl){
+	RepSysSimulator::instance().call(__func__);
+	return RepSysSimulator::instance().firstMsg(classMask, msgHdl);
+}
+
+BPApiState BPApiRepSysGetNextMsg(uint32_t classMask, BPApiRepSysMsgHdl *msgHdl){
+	RepSysSimulator::instance().call(__func__);
+	return RepSysSimulator::instance().nextMsg(classMask, msgHdl);
+}
+
+BPApiState BPApiRepSysGetPrevMsg(uint32_t classMask, BPApiRepSysMsgHdl *msgHdl){
+	RepSysSimulator::instance().call(__func__);
+	return RepSysSimulator::instance().prevMsg(classMask, msgHdl);
+}
+
+BPApiState BPApiRepSysGetLastMsg(uint32_t classMask, BPApiRepSysMsgHdl *msgHdl){
+	RepSysSimulator::instance().call(__func__);
+	return RepSysSimulator::instance().lastMsg(classMask, msgHdl);
+}
+
+BPApiState BPApiRepSysGetMsgCount(uint32_t classMask, uint32_t *count){
+	RepSysSimulator::instance().call(__func__);
+	return RepSysSimulator::instance().msgCount(classMask, count);
+}
+
+BPApiState BPApiRepSysGetMsgDataValues(BPApiRepSysMsgHdl msgHdl, BPApiRepSysMsgClass *classId, uint32_t *compNr, uint32_t *instNr,
+									   uint32_t *msgNr, BPApiTime *timeStamp, uint32_t *paramCount, BPApiRepSysMsgState *msgState){
+	RepSysSimulator::instance().call(__func__);
+	return RepSysSimulator::instance().msgDataValues(msgHdl, classId, compNr, instNr, msgNr, timeStamp, paramCount, msgState, nullptr);
+}
+
+BPApiState BPApiRepSysGetMsgDataValues2(BPApiRepSysMsgHdl msgHdl, BPApiRepSysMsgClass *classId, uint32_t *compNr, uint32_t *instNr,
+										uint32_t *msgNr, BPApiTime *timeStamp, uint32_t *paramCount, BPApiRepSysMsgState *msgState,
+										uint32_t *protocolVar){
+	RepSysSimulator::instance().call(__func__);
+	return RepSysSimulator::instance().msgDataValues(msgHdl, classId, compNr, instNr, msgNr, timeStamp, paramCount, msgState, protocolVar);
+}
+
+BPApiState BPApiRepSysFormatMsgA(BPApiRepSysMsgHdl msgHdl, char *buffer, uint32_t bufLen){
+	RepSysSimulator::instance().call(__func__);
+	return RepSysSimulator::instance().formatMsg(msgHdl, buffer, bufLen);
+}
@@ -0,0 +1,169 @@
+/**
+ * SEPRO ROBOTIQUE SAS © 2020 - 2021
+ * Ce contenu est la propriété pleine, entière et exclusive de SEPRO GROUP.
+ *
+ * INFORMATIONS CONFIDENTIELLES.
+ * Ce contenu ne peut être communiqué ou divulgué à des tiers que sous réserve
+ * de la signature préalable d’un accord de confidentialité avec SEPRO GROUP
+ * et avec l’autorisation préalable et écrite de SEPRO GROUP.
+ *
+ * This content is the full, sole and exclusive property of SEPRO GROUP.
+ *
+ * CONFIDENTIAL INFORMATION.
+ * This content may only be communicated or disclosed to third parties after
+ * signing a confidentiality agreement with SEPRO GROUP and with the
+ * written permission of SEPRO GROUP
+ *
+ * @file RepSysSimulator.hpp
+ * @version 0.1
+ */
+
+#ifndef _REPSYS_SIMULATOR_HPP_
+#define _REPSYS_SIMULATOR_HPP_
+
+#include "BPApiRepSys.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief
+ * parametres du generateur de messages
+ * - flux regulier (rate) + rafales (burstSize messages toutes les burstPeriodMs)
+ * - repartition par classe (classMix : classe, poids)
+ * - part des messages safety (compNr 100, ceux que le reporter renvoie)
+ * - latence ajoutee a chaque appel BPApi (simule l aller retour vers le controleur)
+ */
+struct RepSysSimConfig
+{
+    double                                                  rate = 10; // msg/s, 0 : pas de flux regulier
+    uint32_t                                                burstSize = 0; // messages d une rafale, 0 : pas de rafale
+    uint32_t                                                burstPeriodMs = 1000;
+    std::vector<std::pair<BPApiRepSysMsgClass, uint32_t>>   classMix = { { BPApiRepSysMsgClassError, 1 },
+                                                                         { BPApiRepSysMsgClassWarning, 1 },
+                                                                         { BPApiRepSysMsgClass8, 1 } };
+    uint32_t                                                safetyPercent = 100; // % de messages compNr 100
+    uint32_t                                                callLatencyUs = 0; // ajoute a chaque appel BPApiRepSys
+    uint32_t                                                capacity = 256; // messages actifs gardes, le plus ancien part en premier
+    uint32_t                                                lifetimeMs = 0; // message quitte apres ce delai, 0 : jamais
+    bool                                                    reuseHandles = false; // un nouveau message reprend le dernier handle libere (quitte, expire, sorti)
+    uint32_t                                                seed = 1;
+};
+
+// compteurs du simulateur, lus par le benchmark
+struct RepSysSimStats
+{
+    uint64_t                generated = 0; // messages generes
+    uint64_t                generatedSafety = 0; // dont compNr 100
+    uint64_t                evicted = 0; // sortis de la liste pleine
+    uint64_t                evictedUnread = 0; // dont compNr 100 jamais lus par le reporter (perdus par la liste, pas par le reporter)
+    uint64_t                forwarded = 0; // BPApiRepSysSetMsgA de l application
+    uint64_t                forwardedKnown = 0; // dont messages generes (latence mesuree)
+    std::map<std::string, uint64_t> calls; // appels BPApiRepSys par fonction
+    std::vector<uint64_t>   latenciesUs; // generation -> renvoi par l application, par message
+};
+
+/**
+ * @brief
+ * Simulateur en memoire des fonctions BPApiRepSys utilisees par le reporter
+ * (GetFirst/Next/Prev/LastMsg, GetMsgCount, GetMsgDataValues(2), FormatMsgA, SetMsgA, QuitMsg)
+ * lie a la place de libBPApi.so (make sim) pour tester et mesurer MessageProcessor hors controleur
+ *
+ * la liste est dans l ordre d arrivee, les handles sont croissants sauf en mode reuseHandles
+ * (comme le controleur : le handle d un message quitte peut etre donne au suivant, nombre de messages egal)
+ * les messages poses par l application (SetMsgA) sont comptes mais pas ajoutes a la liste
+ */
+class RepSysSimulator
+{
+    public:
+
+        // jamais detruit : les threads du reporter peuvent encore appeler l api a la sortie du programme
+        static RepSysSimulator  &instance(void);
+
+        RepSysSimulator(const RepSysSimulator &src) = delete;
+        RepSysSimulator &operator=(const RepSysSimulator &src) = delete;
+
+        // vide la liste et les compteurs, prend la configuration (generateur arrete)
+        void                    configure(const RepSysSimConfig &config);
+
+        // lance / arrete le thread generateur
+        void                    start(void);
+        void                    stop(void);
+
+        // ajoute p_count messages tout de suite (rafale manuelle), retourne le dernier handle
+        BPApiRepSysMsgHdl       generate(uint32_t p_count);
+
+        RepSysSimStats          stats(void);
+
+        // --- implementation des fonctions BPApiRepSys ---
+
+        // latence configuree + compteur de la fonction
+        void                    call(const char *p_function);
+
+        BPApiState              setMsg(BPApiRepSysMsgClass classId, uint32_t compNr, uint32_t instNr, uint32_t msgNr, const std::string &text);
+        BPApiState              quitMsg(BPApiRepSysMsgClass classId, uint32_t compNr, uint32_t instNr, uint32_t msgNr);
+        BPApiState              firstMsg(uint32_t classMask, BPApiRepSysMsgHdl *msgHdl);
+        BPApiState              lastMsg(uint32_t classMask, BPApiRepSysMsgHdl *msgHdl);
+        BPApiState              nextMsg(uint32_t classMask, BPApiRepSysMsgHdl *msgHdl);
+        BPApiState              prevMsg(uint32_t classMask, BPApiRepSysMsgHdl *msgHdl);
+        BPApiState              msgCount(uint32_t classMask, uint32_t *count);
+        BPApiState              msgDataValues(BPApiRepSysMsgHdl msgHdl, BPApiRepSysMsgClass *classId, uint32_t *compNr, uint32_t *instNr,
+                                              uint32_t *msgNr, BPApiTime *timeStamp, uint32_t *paramCount, BPApiRepSysMsgState *msgState,
+                                              uint32_t *protocolVar);
+        BPApiState              formatMsg(BPApiRepSysMsgHdl msgHdl, char *buffer, uint32_t bufLen);
+
+    private:
+
+        struct SimMsg
+        {
+            BPApiRepSysMsgHdl   hdl;
+            BPApiRepSysMsgClass classId;
+            uint32_t            compNr;
+            uint32_t            instNr;
+            uint32_t            msgNr;
+            BPApiTime           ts;
+            BPApiRepSysMsgState state;
+            std::string         text;
+            uint64_t            createdUs; // horloge monotone, pour la latence
+            bool                isRead; // valeurs lues par le reporter (GetMsgDataValues)
+        };
+
+        RepSysSimulator();
+
+        std::mutex                          m_mutex;
+        RepSysSimConfig                     m_config;
+        RepSysSimStats                      m_stats;
+        std::map<uint64_t, SimMsg>          m_msgs; // liste active, par numero d arrivee
+        std::map<BPApiRepSysMsgHdl, uint64_t> m_hdls; // handle -> numero d arrivee
+        std::vector<BPApiRepSysMsgHdl>      m_freeHdls; // handles liberes, repris en mode reuseHandles (le dernier d abord)
+        std::map<uint32_t, uint64_t>        m_createdUs; // instNr des messages generes -> creation (latence au renvoi), garde jusqu au renvoi
+        BPApiRepSysMsgHdl                   m_nextHdl;
+        uint64_t                            m_nextArrival;
+        uint32_t                            m_nextInstNr;
+        uint32_t                            m_random;
+
+        std::thread                         m_generatorThread;
+        std::atomic<bool>                   m_running;
+
+        // boucle du generateur : flux regulier, rafales, messages expires
+        void                                generatorLoop(void);
+
+        // ajoute un message genere, m_mutex pris
+        BPApiRepSysMsgHdl                   addGenerated(uint64_t p_nowUs);
+
+        // message d un handle de la liste, m_msgs.end() sinon, m_mutex pris
+        std::map<uint64_t, SimMsg>::iterator    findMsg(BPApiRepSysMsgHdl p_msgHdl);
+
+        // retire un message de la liste, son handle est libere, m_mutex pris
+        void                                eraseMsg(std::map<uint64_t, SimMsg>::iterator p_msg);
+
+        uint32_t                            nextRandom(void);
+        static uint64_t                     nowUs(void);
+};
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * SEPRO ROBOTIQUE SAS © 2020 - 2021
+ * Ce contenu est la propriété pleine, entière et exclusive de SEPRO GROUP.
+ *
+ * INFORMATIONS CONFIDENTIELLES.
+ * Ce contenu ne peut être communiqué ou divulgué à des tiers que sous réserve
+ * de la signature préalable d’un accord de confidentialité avec SEPRO GROUP
+ * et avec l’autorisation préalable et écrite de SEPRO GROUP.
+ *
+ * This content is the full, sole and exclusive property of SEPRO GROUP.
+ *
+ * CONFIDENTIAL INFORMATION.
+ * This content may only be communicated or disclosed to third parties after
+ * signing a confidentiality agreement with SEPRO GROUP and with the
+ * written permission of SEPRO GROUP
+ *
+ * @file benchRetriever.cpp
+ * @version 0.1
+ */
+
+#include "MessageProcessor.hpp"
+#include "RepSysSimulator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// defines
+#define MSG_LEN 60
+#define DRAIN_DELAY 2 // s, after the generator stops
+
+#define CLASS_ID_RANGE				\
+	(									\
+		BPApiRepSysMsgClassErrorFatal |	\
+		BPApiRepSysMsgClassError |		\
+		BPApiRepSysMsgClassErrorMinor |	\
+		BPApiRepSysMsgClassWarning |	\
+		BPApiRepSysMsgClassInfo |		\
+		BPApiRepSysMsgClassErrorApp |	\
+		BPApiRepSysMsgClass7 |			\
+		BPApiRepSysMsgClass8 |			\
+		BPApiRepSysMsgClass9 |			\
+		BPApiRepSysMsgClass10 |			\
+		BPApiRepSysMsgClass11 |			\
+		BPApiRepSysMsgClass12			\
+	)
+
+static void	usage(const char *p_name){
+	printf("usage: %s [--rate msg/s] [--burst n] [--burst-period ms] [--safety %%] [--latency us]\n"
+		   "          [--capacity n] [--lifetime ms] [--reuse-handles 0|1] [--existing n] [--rescan n] [--duration s] [--seed n]\n", p_name);
+}
+
+/**
+ * @brief
+ * MessageProcessor on the RepSys simulator : messages generated by the simulator during --duration,
+ * forwarded by NewMsgRetriever, then the messages lost, the forwarding latency and the BPApi calls
+ * the traces of MessageProcessor (std::cout) are discarded, the report is printed with printf
+ *
+ */
+int main(int argc, char **argv){
+	RepSysSimConfig	config;
+	uint32_t		duration = 10;
+	uint32_t		existing = 0;
+	uint32_t		rescan = 1;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const char	*option = argv[i];
+		const char	*value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+		if (value == nullptr)
+		{
+			usage(argv[0]);
+			return 1;
+		}
+		i++;
+		if (!strcmp(option, "--rate"))
+			config.rate = atof(value);
+		else if (!strcmp(option, "--burst"))
+			config.burstSize = (uint32_t)atoi(value);
+		else if (!strcmp(option, "--burst-period"))
+			config.burstPeriodMs = (uint32_t)atoi(value);
+		else if (!strcmp(option, "--safety"))
+			config.safetyPercent = (uint32_t)atoi(value);
+		else if (!strcmp(option, "--latency"))
+			config.callLatencyUs = (uint32_t)atoi(value);
+		else if (!strcmp(option, "--capacity"))
+			config.capacity = (uint32_t)atoi(value);
+		else if (!strcmp(option, "--lifetime"))
+			config.lifetimeMs = (uint32_t)atoi(value);
+		else if (!strcmp(option, "--reuse-handles"))
+			config.reuseHandles = atoi(value) != 0;
+		else if (!strcmp(option, "--existing"))
+			existing = (uint32_t)atoi(value);
+		else if (!strcmp(option, "--rescan"))
+			rescan = (uint32_t)atoi(value);
+		else if (!strcmp(option, "--duration"))
+			duration = (uint32_t)atoi(value);
+		else if (!strcmp(option, "--seed"))
+			config.seed = (uint32_t)atoi(value);
+		else
+		{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	RepSysSimulator &simulator = RepSysSimulator::instance();
+
+	simulator.configure(config);
+	if (existing)
+		simulator.generate(existing);
+
+	// never deleted : its threads never end
+	MessageProcessor *msgProc = new MessageProcessor(CLASS_ID_RANGE, MSG_LEN);
+
+	std::cout.setstate(std::ios_base::badbit);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	// the existing messages scanned --rescan times
+	for (uint32_t i = 0; i < rescan; i++)
+	{
+		msgProc->displayAllMsg();
+		printf("existing messages : %u forwarded in %lld us\n", existing,
+			   (long long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+		start = std::chrono::steady_clock::now();
+	}
+
+	msgProc->NewMsgRetriever(CLASS_ID_RANGE);
+	simulator.start();
+	std::this_thread::sleep_for(std::chrono::seconds(duration));
+	simulator.stop();
+	std::this_thread::sleep_for(std::chrono::seconds(DRAIN_DELAY));
+
+	RepSysSimStats		stats = simulator.stats();
+	std::vector<uint64_t> &latencies = stats.latenciesUs;
+
+	std::sort(latencies.begin(), latencies.end());
+	// lost : safety messages never forwarded, the ones evicted before the reporter read them are counted apart
+	printf("generated %llu (safety %llu), evicted %llu (unread safety %llu), forwarded %llu (safety %llu), lost %llu\n",
+		   (unsigned long long)stats.generated, (unsigned long long)stats.generatedSafety,
+		   (unsigned long long)stats.evicted, (unsigned long long)stats.evictedUnread,
+		   (unsigned long long)stats.forwarded, (unsigned long long)stats.forwardedKnown,
+		   (unsigned long long)(stats.generatedSafety - stats.forwardedKnown - stats.evictedUnread));
+	if (!latencies.empty())
+		printf("forwarding latency (us) : p50 %llu, p99 %llu, max %llu\n",
+			   (unsigned long long)latencies[latencies.size() / 2],
+			   (unsigned long long)latencies[latencies.size() * 99 / 100],
+			   (unsigned long long)latencies.back());
+	for (const auto &call : stats.calls)
+		printf("%-32s %llu\n", call.first.c_str(), (unsigned long long)call.second);
+
+	fflush(stdout);
+	return 0;
+}
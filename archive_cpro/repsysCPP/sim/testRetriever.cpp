@@ -0,0 +1,122 @@
+/**
+ * SEPRO ROBOTIQUE SAS © 2020 - 2021
+ * Ce contenu est la propriété pleine, entière et exclusive de SEPRO GROUP.
+ *
+ * INFORMATIONS CONFIDENTIELLES.
+ * Ce contenu ne peut être communiqué ou divulgué à des tiers que sous réserve
+ * de la signature préalable d’un accord de confidentialité avec SEPRO GROUP
+ * et avec l’autorisation préalable et écrite de SEPRO GROUP.
+ *
+ * This content is the full, sole and exclusive property of SEPRO GROUP.
+ *
+ * CONFIDENTIAL INFORMATION.
+ * This content may only be communicated or disclosed to third parties after
+ * signing a confidentiality agreement with SEPRO GROUP and with the
+ * written permission of SEPRO GROUP
+ *
+ * @file testRetriever.cpp
+ * @version 0.1
+ */
+
+#include "MessageProcessor.hpp"
+#include "RepSysSimulator.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+// defines
+#define MSG_LEN 60
+#define FORWARD_TIMEOUT 3000 // ms, the retriever scans at least every POLL_INTERVAL_MAX
+
+#define CLASS_ID_RANGE				\
+	(									\
+		BPApiRepSysMsgClassErrorFatal |	\
+		BPApiRepSysMsgClassError |		\
+		BPApiRepSysMsgClassWarning		\
+	)
+
+/**
+ * @brief
+ * Wait until the application forwarded p_count generated messages
+ *
+ * @param p_count
+ * @return true
+ * @return false : not within FORWARD_TIMEOUT
+ */
+static bool	waitForwarded(uint64_t p_count){
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::milliseconds(FORWARD_TIMEOUT);
+
+	while (RepSysSimulator::instance().stats().forwardedKnown < p_count)
+	{
+		if (std::chrono::steady_clock::now() >= end)
+			return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	return true;
+}
+
+static bool	check(const char *p_name, bool p_isOk){
+	printf("%-64s %s\n", p_name, p_isOk ? "ok" : "FAILED");
+	return p_isOk;
+}
+
+/**
+ * @brief
+ * NewMsgRetriever on the simulator in reuseHandles mode : a new message takes the handle of a message
+ * which left the list, the message count can stay the same, every new message must still be forwarded once
+ * the traces of MessageProcessor (std::cout) are discarded
+ *
+ */
+int main(void){
+	RepSysSimulator		&simulator = RepSysSimulator::instance();
+	RepSysSimConfig		config;
+	bool				isOk = true;
+
+	// messages only from generate, all forwarded (compNr 100), one class : quit by its fields
+	config.rate = 0;
+	config.safetyPercent = 100;
+	config.classMix = { { BPApiRepSysMsgClassError, 1 } };
+	config.reuseHandles = true;
+	config.capacity = 1;
+	simulator.configure(config);
+
+	// never deleted : its threads never end
+	MessageProcessor *msgProc = new MessageProcessor(CLASS_ID_RANGE, MSG_LEN);
+
+	std::cout.setstate(std::ios_base::badbit);
+	msgProc->NewMsgRetriever(CLASS_ID_RANGE);
+
+	// a list of one message : the new message takes the handle of the cursor, the count stays 1
+	BPApiRepSysMsgHdl first = simulator.generate(1);
+
+	isOk &= check("first message", waitForwarded(1));
+	isOk &= check("same handle, same count : forwarded", simulator.generate(1) == first && waitForwarded(2));
+
+	// the handle of the cursor (1) is given again in the walk back : 3, 2, then 1 is new too
+	config.capacity = 3;
+	simulator.configure(config);
+	simulator.generate(3);
+	isOk &= check("cursor handle reused in the walk back : forwarded", waitForwarded(3));
+
+	// the cursor (3) is quitted, its handle goes to the next message, the oldest leaves the full list for the last one :
+	// list 2, 3, 1, same count
+	BPApiRepSysMsgClass	classId;
+	uint32_t			compNr, instNr, msgNr, paramCount, protocolVar;
+	BPApiTime			ts;
+	BPApiRepSysMsgState	msgState;
+
+	BPApiRepSysGetMsgDataValues2(3, &classId, &compNr, &instNr, &msgNr, &ts, &paramCount, &msgState, &protocolVar);
+	BPApiRepSysQuitMsg(classId, compNr, instNr, msgNr);
+	simulator.generate(2);
+	isOk &= check("cursor quitted, its handle before the last message : forwarded", waitForwarded(5));
+
+	// nothing forwarded twice
+	std::this_thread::sleep_for(std::chrono::milliseconds(FORWARD_TIMEOUT));
+	isOk &= check("each message forwarded once", simulator.stats().forwarded == 5);
+
+	printf("%s\n", isOk ? "all scenarios ok" : "FAILED");
+	fflush(stdout);
+	return isOk ? 0 : 1;
+}
@@ -111,11 +111,9 @@ Message::~Message(){
  * @param msgHdl 
  */
 Message::Message(const BPApiRepSysMsgHdl &msgHdl) {
-    // BPApiState retCode;
-
     m_msgHdl = msgHdl;
 
-	BPApiRepSysGetMsgDataValues2(  // on recupere les infos : classId, compNr, instNr, msgNr ... correspondant au handler
+	if (BPApiRepSysGetMsgDataValues2(  // on recupere les infos : classId, compNr, instNr, msgNr ... correspondant au handler
 			msgHdl, // [in]
 			&m_msgClassId, // ex. 256 <=> 0x100ul donc class9
 			&m_compNr, // ex. 50
@@ -124,7 +122,18 @@ Message::Message(const BPApiRepSysMsgHdl &msgHdl) {
 			&m_ts, 
 			&m_paramCount, // ex. 1 
 			&m_msgState, // ex. BPApiRepSysMsgStateToQuit
-			&m_protocol_var);
+			&m_protocol_var) != BPApiStateOk)
+    {
+        // invalid handle : all fields to 0
+        m_msgClassId = {};
+        m_compNr = 0;
+        m_instNr = 0;
+        m_msgNr = 0;
+        m_ts = {};
+        m_paramCount = 0;
+        m_msgState = {};
+        m_protocol_var = 0;
+    }
 
     // si tu mets __FUNCTION__ tu vas afficher le nom de la classe mais pas le nom de la methode
 	// DisplayChecker::DisplayBPApiState(__PRETTY_FUNCTION__, retCode);
@@ -30,9 +30,11 @@
 #include <chrono>
 #include <functional>
 #include <csignal>
+#include <algorithm>
 
-// #define TIME_INTERVAL 100 // ms ?
-#define TIME_INTERVAL 3 // ms ?
+// polling interval of NewMsgRetriever : back to the min as soon as a message arrives, doubled at each idle scan up to the max
+#define POLL_INTERVAL_MIN 50 // ms
+#define POLL_INTERVAL_MAX 1000 // ms
 
 // clib
 #include <string.h>
@@ -63,6 +65,8 @@
 MessageProcessor::MessageProcessor(BPApiRepSysMsgClass p_classId, size_t p_len){
 	m_classRange = p_classId;
 	m_last_msgHdl = 0;
+	m_last_ts = {0, 0};
+	m_last_msgCount = 0;
 	init();
 }
 
@@ -99,43 +103,145 @@ MessageProcessor::~MessageProcessor(){
 
 /**
  * @brief 
- * [ WIP ] Operationnal POC for retrieving existing messages and new one
+ * Forward every new message (compNr == COMP_NR) in its arrival order
+ * each scan compares the message count and the last message (handle and timestamp) with the cursor, and only when one of them changed
+ * walks back from the last message (BPApiRepSysGetPrevMsg) to the cursor : a burst between two scans is not lost
+ * a handle is not enough : the controller gives the handle of a quitted message to a new one, the message count can stay the same
+ * the interval goes down to POLL_INTERVAL_MIN when messages arrive and doubles up to POLL_INTERVAL_MAX when idle
  * 
  * @param p_msgClassId 
  * @return true 
  * @return false 
  */
 bool	MessageProcessor::NewMsgRetriever(BPApiRepSysMsgClass p_msgClassId){
-	BPApiState retCode(void); // void permets d eviter les erreur de "unused parameter" [comment to be deleted]
 
 	m_msgQSetterThread = std::thread([=]() mutable {
 		std::cout << "enter NewMsgRetriever " << std::endl;
 
+		std::chrono::milliseconds interval(POLL_INTERVAL_MIN);
+
 		while (true)
 		{
-			BPApiRepSysMsgHdl msgHdl;
-			// std::this_thread::sleep_for(std::chrono::milliseconds(TIME_INTERVAL));
-			std::this_thread::sleep_for(std::chrono::seconds(TIME_INTERVAL));
+			BPApiRepSysMsgHdl	lastHdl;
+			uint32_t			msgCount = 0;
+
+			std::this_thread::sleep_for(interval);
+			interval = std::min(interval * 2, std::chrono::milliseconds(POLL_INTERVAL_MAX));
+
+			BPApiRepSysGetMsgCount(p_msgClassId, &msgCount);
 
-			if (BPApiRepSysGetLastMsg(p_msgClassId, &msgHdl) == BPApiStateOk && msgHdl != m_last_msgHdl)
+			// empty list
+			if (msgCount == 0 || BPApiRepSysGetLastMsg(p_msgClassId, &lastHdl) != BPApiStateOk)
 			{
-				Message *msg = new Message(msgHdl);
-				if (msg->getCompNr() == 100)
-				{
-					messageModifier(msg, MSG_LEN);
+				m_last_msgCount = msgCount;
+				continue;
+			}
 
-					std::lock_guard<std::mutex> guard_1(m_msgQMutex);
-					m_msgQ.push(msg);
-					m_last_msgHdl = msgHdl;
-				}
+			// nothing new : same count, same last message (handle and timestamp)
+			if (msgCount == m_last_msgCount)
+			{
+				Message lastMsg(lastHdl);
+
+				if (isCursor(lastMsg))
+					continue;
 			}
 
+			std::vector<Message *> newMsgs = retrieveNewMsgs(p_msgClassId, msgCount);
+
+			m_last_msgCount = msgCount;
+			if (!newMsgs.empty())
+				interval = std::chrono::milliseconds(POLL_INTERVAL_MIN);
+
+			for (Message *msg : newMsgs)
+			{
+				setCursor(*msg);
+				if (msg->getCompNr() != COMP_NR)
+				{
+					delete msg;
+					continue;
+				}
+
+				messageModifier(msg, MSG_LEN);
+
+				std::lock_guard<std::mutex> guard_1(m_msgQMutex);
+				m_msgQ.push(msg);
+			}
 		}
 	});
 
 	return true; // todo : define condition for returning true or false
 }
 
+/**
+ * @brief 
+ * Walk back from the last message until the cursor
+ * the cursor handle alone does not end the walk (it may hold a new message) : its timestamp too,
+ * a message older than the cursor, or seen with the same timestamp, ends the walk too (the cursor message was removed from the list)
+ * at most p_msgCount steps : the list never holds more
+ * 
+ * @param p_msgClassId 
+ * @param p_msgCount : message count of the class mask
+ * @return std::vector<Message *> : new messages, oldest first, to be deleted by the caller
+ */
+std::vector<Message *>	MessageProcessor::retrieveNewMsgs(BPApiRepSysMsgClass p_msgClassId, uint32_t p_msgCount){
+	std::vector<Message *>	newMsgs;
+	BPApiRepSysMsgHdl		msgHdl;
+
+	if (BPApiRepSysGetLastMsg(p_msgClassId, &msgHdl) != BPApiStateOk)
+		return newMsgs;
+
+	for (uint32_t i = 0; i < p_msgCount; i++)
+	{
+		Message		*msg = new Message(msgHdl);
+		BPApiTime	ts = msg->getTime();
+
+		if (ts.sec < m_last_ts.sec || (ts.sec == m_last_ts.sec && ts.nsec < m_last_ts.nsec) || isCursor(*msg))
+		{
+			delete msg;
+			break;
+		}
+		newMsgs.push_back(msg);
+
+		if (BPApiRepSysGetPrevMsg(p_msgClassId, &msgHdl) != BPApiStateOk)
+			break;
+	}
+
+	std::reverse(newMsgs.begin(), newMsgs.end());
+	return newMsgs;
+}
+
+/**
+ * @brief 
+ * The message was already seen : the cursor timestamp, and its handle among the ones seen with this timestamp
+ * 
+ * @param p_msg 
+ * @return true 
+ * @return false 
+ */
+bool	MessageProcessor::isCursor(Message &p_msg) const {
+	BPApiTime ts = p_msg.getTime();
+
+	return ts.sec == m_last_ts.sec && ts.nsec == m_last_ts.nsec && m_last_tsHdls.count(p_msg.getHdl());
+}
+
+/**
+ * @brief 
+ * The cursor moves on the given message, the handles seen with the same timestamp are kept
+ * 
+ * @param p_msg 
+ */
+void	MessageProcessor::setCursor(Message &p_msg){
+	BPApiTime ts = p_msg.getTime();
+
+	if (ts.sec != m_last_ts.sec || ts.nsec != m_last_ts.nsec)
+	{
+		m_last_ts = ts;
+		m_last_tsHdls.clear();
+	}
+	m_last_tsHdls.insert(p_msg.getHdl());
+	m_last_msgHdl = p_msg.getHdl();
+}
+
 /**
  * @brief 
  * print message from the message queue
@@ -196,9 +302,8 @@ void	MessageProcessor::displayAllMsg()
 
 			std::cout << "\nafter changing classID" << std::endl;
 			std::cout << GREEN_COLOR << firstMsg << END_COLOR << std::endl;
-
-			m_last_msgHdl = msgHdl;
 		}
+		setCursor(firstMsg);
 
 		while (BPApiRepSysGetNextMsg(m_classRange, &msgHdl) == BPApiStateOk)
 		{
@@ -220,9 +325,11 @@ void	MessageProcessor::displayAllMsg()
 				std::cout << "\nafter changing classID" << std::endl;
 				std::cout << GREEN_COLOR << nextMsg << END_COLOR << std::endl << std::endl;
 			}
+			setCursor(nextMsg);
 		}
 
-		m_last_msgHdl = msgHdl;
+		// NewMsgRetriever starts after the last message forwarded here
+		BPApiRepSysGetMsgCount(m_classRange, &m_last_msgCount);
 	}
 }
 
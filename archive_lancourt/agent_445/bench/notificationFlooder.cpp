@@ -0,0 +1,636 @@
+#include "notifications.pb.h"
+#include "json.hpp"
+
+#include <arpa/inet.h>
+#include <getopt.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Flood the protobuf port of a running agent with Notifications, then compare what was sent
+// with what the controller saw (read on the metrics socket of the agent, "metrics_socketPath")
+// a collector is flooded the same way, its snapshot socket ("snapshot_socketPath") given to --metrics
+//
+// usage: ./bench/notificationFlooder --rate 50000 --duration 10 --sources 500
+//            --metrics /run/agent/metrics.sock --pid `pidof agent-release`
+//        ./bench/notificationFlooder --port 2525 --sockets 16 --rate 400000 --sources 5000
+//            --metrics /run/collector/snapshot.sock --pid `pidof collector-release`
+
+# define FLOOD_BATCH 64 // notifications sent by one sendmmsg
+# define FLOOD_KIND_COUNT 5 // STATS, ALERT WARNING, ALERT ERROR, ALERT FATAL, CONFIG
+# define SETTLE_PERIOD 100 // ms between two reads of the metrics while the agent drains its queue
+
+struct FlooderOptions
+{
+    std::string         host = "127.0.0.1";
+    int                 port = 2424;
+    std::string         unixPath; // Unix datagram socket instead of host:port
+    int                 socketCount = 1; // sending sockets, each one a sender for the SO_REUSEPORT of a collector
+    u_int64_t           rate = 10000; // notifications / s
+    int                 duration = 10; // s
+    u_int32_t           sourceCount = 100;
+    u_int32_t           firstSourceID = 1000;
+    int                 weights[3] = { 95, 5, 0 }; // STATS, ALERT, CONFIG
+    std::string         metricsSocketPath;
+    pid_t               agentPid = -1;
+    int                 settleTime = 2000; // ms
+};
+
+struct FlooderResult
+{
+    u_int64_t           sent = 0;
+    u_int64_t           sendErrors = 0;
+    u_int64_t           sentByType[3] = { 0, 0, 0 };
+    double              elapsed = 0; // s
+};
+
+static void                 usage(const char *p_name)
+{
+    std::cout << "usage: " << p_name << " [options]" << std::endl
+              << "  --host <address>        agent protobuf_host (127.0.0.1)" << std::endl
+              << "  --port <port>           agent protobuf_port (2424)" << std::endl
+              << "  --unix <path>           Unix datagram socket of a collector (unix_socketPath), instead of --host / --port" << std::endl
+              << "  --sockets <n>           sending sockets, used in turn by the batches (1)" << std::endl
+              << "  --rate <n>              notifications per second (10000)" << std::endl
+              << "  --duration <s>          flooding duration (10)" << std::endl
+              << "  --sources <n>           distinct sourceIDs (100)" << std::endl
+              << "  --mix <s,a,c>           weights of STATS, ALERT and CONFIG (95,5,0)" << std::endl
+              << "  --metrics <path>        metrics socket of the agent or snapshot socket of the collector" << std::endl
+              << "                          (no receiver side report without it)" << std::endl
+              << "  --pid <pid>             pid of the agent or of the collector, for its cpu usage" << std::endl
+              << "  --settle <ms>           time left to the receiver to drain its queue (2000)" << std::endl;
+}
+
+static bool                 parseOptions(int p_argc, char **p_argv, FlooderOptions &p_options)
+{
+    static const struct option  l_longOptions[] = {
+        { "host",       required_argument, nullptr, 'h' },
+        { "port",       required_argument, nullptr, 'p' },
+        { "unix",       required_argument, nullptr, 'u' },
+        { "sockets",    required_argument, nullptr, 'n' },
+        { "rate",       required_argument, nullptr, 'r' },
+        { "duration",   required_argument, nullptr, 'd' },
+        { "sources",    required_argument, nullptr, 's' },
+        { "mix",        required_argument, nullptr, 'x' },
+        { "metrics",    required_argument, nullptr, 'm' },
+        { "pid",        required_argument, nullptr, 'P' },
+        { "settle",     required_argument, nullptr, 'S' },
+        { "help",       no_argument,       nullptr, '?' },
+        { nullptr,      0,                 nullptr, 0 }
+    };
+    int                         l_option;
+
+    while ((l_option = getopt_long(p_argc, p_argv, "h:p:u:n:r:d:s:x:m:P:S:", l_longOptions, nullptr)) != -1)
+    {
+        switch (l_option)
+        {
+            case 'h': p_options.host = optarg; break;
+            case 'p': p_options.port = std::atoi(optarg); break;
+            case 'u': p_options.unixPath = optarg; break;
+            case 'n': p_options.socketCount = std::atoi(optarg); break;
+            case 'r': p_options.rate = std::strtoull(optarg, nullptr, 10); break;
+            case 'd': p_options.duration = std::atoi(optarg); break;
+            case 's': p_options.sourceCount = (u_int32_t)std::strtoul(optarg, nullptr, 10); break;
+            case 'm': p_options.metricsSocketPath = optarg; break;
+            case 'P': p_options.agentPid = (pid_t)std::atoi(optarg); break;
+            case 'S': p_options.settleTime = std::atoi(optarg); break;
+            case 'x':
+                if (std::sscanf(optarg, "%d,%d,%d", &p_options.weights[0], &p_options.weights[1], &p_options.weights[2]) != 3)
+                    return false;
+                break;
+            default:
+                return false;
+        }
+    }
+
+    return p_options.rate > 0 && p_options.duration > 0 && p_options.sourceCount > 0 && p_options.socketCount > 0 &&
+           p_options.weights[0] >= 0 && p_options.weights[1] >= 0 && p_options.weights[2] >= 0 &&
+           p_options.weights[0] + p_options.weights[1] + p_options.weights[2] > 0;
+}
+
+/**
+ * @brief
+ * Serialize the notifications of every source, the kind (FLOOD_KIND_COUNT) is the minor index
+ * rebuilt each second for the sendingDate, the payloads are not rebuilt for each notification :
+ * the flooder has to go faster than the agent
+ * the CONFIG payload has no "magellan-agent:agent" module list : the controller refuses it
+ * (getModulesListFromJson throws) and leaves the running modules untouched,
+ * only sent when --mix gives CONFIG a weight
+ *
+ * @param p_options
+ * @param p_startTime
+ * @param p_notifications [out]
+ */
+static void                 buildNotifications(const FlooderOptions &p_options, time_t p_startTime,
+                                               std::vector<std::string> &p_notifications)
+{
+    static const Notifications_SourceType   l_sourceTypes[] = { Notifications_SourceType_CAPTURE,
+                                                                Notifications_SourceType_VISION,
+                                                                Notifications_SourceType_DETECTION,
+                                                                Notifications_SourceType_COLLECTOR };
+    static const Notifications_Priority     l_alertPriorities[] = { Notifications_Priority_WARNING,
+                                                                    Notifications_Priority_ERROR,
+                                                                    Notifications_Priority_FATAL };
+    time_t                                  l_now = std::time(nullptr);
+    Notifications                           l_notification;
+    char                                    l_message[256];
+
+    p_notifications.resize((size_t)p_options.sourceCount * FLOOD_KIND_COUNT);
+
+    for (u_int32_t l_source = 0; l_source < p_options.sourceCount; l_source++)
+    {
+        u_int32_t   l_sourceID = p_options.firstSourceID + l_source;
+
+        l_notification.Clear();
+        l_notification.set_sourceid(l_sourceID);
+        l_notification.set_sourcetype(l_sourceTypes[l_source % 4]);
+        l_notification.set_cpuusage(std::to_string(l_source % 100));
+        l_notification.set_ramusage(std::to_string(10000 + l_source));
+        l_notification.set_uptime((u_int64_t)(l_now - p_startTime));
+        l_notification.set_sendingdate((u_int64_t)l_now);
+
+        for (int l_kind = 0; l_kind < FLOOD_KIND_COUNT; l_kind++)
+        {
+            if (l_kind == 0)
+            {
+                l_notification.set_notificationtype(Notifications_NotificationType_STATS);
+                l_notification.set_priority(Notifications_Priority_DEFAULT_PRIORITY);
+                std::snprintf(l_message, sizeof(l_message),
+                              "{\"packets\":%ld,\"bytes\":%ld,\"drops\":0,\"bench\":true}",
+                              (long)(l_now - p_startTime) * 1000, (long)(l_now - p_startTime) * 1500000);
+            }
+            else if (l_kind < FLOOD_KIND_COUNT - 1)
+            {
+                l_notification.set_notificationtype(Notifications_NotificationType_ALERT);
+                l_notification.set_priority(l_alertPriorities[l_kind - 1]);
+                std::snprintf(l_message, sizeof(l_message),
+                              "{\"event\":\"benchAlert\",\"sourceID\":%u,\"bench\":true}", l_sourceID);
+            }
+            else
+            {
+                l_notification.set_notificationtype(Notifications_NotificationType_CONFIG);
+                l_notification.set_priority(Notifications_Priority_DEFAULT_PRIORITY);
+                std::snprintf(l_message, sizeof(l_message), "{\"bench\":true}");
+            }
+            l_notification.set_message(l_message);
+            l_notification.SerializeToString(&p_notifications[(size_t)l_source * FLOOD_KIND_COUNT + l_kind]);
+        }
+    }
+}
+
+/**
+ * @brief
+ * Send p_options.rate notifications per second during p_options.duration
+ * the notifications due since the start are sent by batches of FLOOD_BATCH, one sendmmsg each :
+ * a late flooder catches up instead of lowering the rate
+ * the notification n goes to the source n % sourceCount, its type is drawn with the weights of --mix
+ * the batches go to the sockets in turn
+ *
+ * @param p_options
+ * @param p_socketfds connected datagram sockets
+ * @param p_result [out]
+ */
+static void                 flood(const FlooderOptions &p_options, const std::vector<int> &p_socketfds, FlooderResult &p_result)
+{
+    std::vector<std::string>    l_notifications;
+    mmsghdr                     l_messages[FLOOD_BATCH];
+    iovec                       l_iovecs[FLOOD_BATCH];
+    int                         l_types[FLOOD_BATCH];
+    int                         l_weightSum = p_options.weights[0] + p_options.weights[1] + p_options.weights[2];
+    u_int64_t                   l_random = 88172645463325252ULL;
+    u_int64_t                   l_attempted = 0;
+    u_int64_t                   l_total = p_options.rate * (u_int64_t)p_options.duration;
+    time_t                      l_startTime = std::time(nullptr);
+    time_t                      l_buildTime = l_startTime;
+    u_int64_t                   l_lastReport = 0;
+    size_t                      l_batch = 0;
+    auto                        l_start = std::chrono::steady_clock::now();
+
+    buildNotifications(p_options, l_startTime, l_notifications);
+    std::memset(l_messages, 0, sizeof(l_messages));
+
+    while (l_attempted < l_total)
+    {
+        double      l_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - l_start).count();
+        u_int64_t   l_due = std::min(l_total, (u_int64_t)(l_elapsed * (double)p_options.rate));
+
+        if (l_due <= l_attempted)
+        {
+            // wait for the next notification, at most 1 ms
+            std::this_thread::sleep_for(std::chrono::microseconds(std::min<u_int64_t>(1000, 1000000 / p_options.rate + 1)));
+            continue;
+        }
+
+        if (std::time(nullptr) != l_buildTime)
+        {
+            l_buildTime = std::time(nullptr);
+            buildNotifications(p_options, l_startTime, l_notifications);
+        }
+
+        int l_count = (int)std::min<u_int64_t>(l_due - l_attempted, FLOOD_BATCH);
+
+        for (int i = 0; i < l_count; i++)
+        {
+            u_int64_t   l_index = l_attempted + i;
+            int         l_draw;
+            int         l_kind;
+
+            // xorshift64, the same sequence of types for every run
+            l_random ^= l_random << 13;
+            l_random ^= l_random >> 7;
+            l_random ^= l_random << 17;
+            l_draw = (int)(l_random % (u_int64_t)l_weightSum);
+
+            if (l_draw < p_options.weights[0])
+                l_types[i] = 0, l_kind = 0;
+            else if (l_draw < p_options.weights[0] + p_options.weights[1])
+                l_types[i] = 1, l_kind = 1 + (int)((l_random >> 32) % 3);
+            else
+                l_types[i] = 2, l_kind = FLOOD_KIND_COUNT - 1;
+
+            const std::string &l_notification = l_notifications[(l_index % p_options.sourceCount) * FLOOD_KIND_COUNT + l_kind];
+
+            l_iovecs[i].iov_base = const_cast<char *>(l_notification.data());
+            l_iovecs[i].iov_len = l_notification.size();
+            l_messages[i].msg_hdr.msg_iov = &l_iovecs[i];
+            l_messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int l_sent = sendmmsg(p_socketfds[l_batch++ % p_socketfds.size()], l_messages, l_count, 0);
+
+        if (l_sent < 0)
+            l_sent = 0; // ECONNREFUSED (nothing bound on the port) or ENOBUFS, the batch is lost
+        for (int i = 0; i < l_sent; i++)
+            p_result.sentByType[l_types[i]]++;
+        p_result.sent += (u_int64_t)l_sent;
+        p_result.sendErrors += (u_int64_t)(l_count - l_sent);
+        l_attempted += (u_int64_t)l_count;
+
+        if ((u_int64_t)l_elapsed > l_lastReport)
+        {
+            l_lastReport = (u_int64_t)l_elapsed;
+            std::printf("  %3llu s  sent %llu (%.0f /s)\n", (unsigned long long)l_lastReport,
+                        (unsigned long long)p_result.sent, (double)p_result.sent / l_elapsed);
+            std::fflush(stdout);
+        }
+    }
+
+    p_result.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - l_start).count();
+}
+
+/**
+ * @brief
+ * Connect to the metrics socket of the agent and read its json until the agent closes the socket
+ *
+ * @param p_socketPath
+ * @param p_metrics [out]
+ * @return bool
+ */
+static bool                 readMetrics(const std::string &p_socketPath, nlohmann::json &p_metrics)
+{
+    struct sockaddr_un  l_address;
+    std::string         l_answer;
+    char                l_buffer[4096];
+    ssize_t             l_length;
+    int                 l_socketfd;
+
+    std::memset(&l_address, 0, sizeof(l_address));
+    l_address.sun_family = AF_UNIX;
+    std::strncpy(l_address.sun_path, p_socketPath.c_str(), sizeof(l_address.sun_path) - 1);
+
+    if ((l_socketfd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0)
+        return false;
+    if (connect(l_socketfd, (struct sockaddr *)&l_address, sizeof(l_address)) < 0)
+    {
+        std::fprintf(stderr, "connect [%s] : %s\n", p_socketPath.c_str(), std::strerror(errno));
+        close(l_socketfd);
+        return false;
+    }
+
+    while ((l_length = read(l_socketfd, l_buffer, sizeof(l_buffer))) > 0)
+        l_answer.append(l_buffer, (size_t)l_length);
+    close(l_socketfd);
+
+    try
+    {
+        p_metrics = nlohmann::json::parse(l_answer);
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "invalid metrics [%s] : %s\n", p_socketPath.c_str(), e.what());
+        return false;
+    }
+    return true;
+}
+
+// utime + stime of a process, in clock ticks, -1 if it does not exist
+static long long            readCpuTicks(pid_t p_pid)
+{
+    std::ifstream       l_file("/proc/" + std::to_string(p_pid) + "/stat");
+    std::string         l_stat;
+    unsigned long long  l_utime;
+    unsigned long long  l_stime;
+
+    if (p_pid <= 0 || !std::getline(l_file, l_stat))
+        return -1;
+
+    // the name of the process (field 2) may hold spaces, the fields are counted after the last ')'
+    size_t l_end = l_stat.rfind(')');
+
+    if (l_end == std::string::npos ||
+        std::sscanf(l_stat.c_str() + l_end + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu",
+                    &l_utime, &l_stime) != 2)
+        return -1;
+    return (long long)(l_utime + l_stime);
+}
+
+static u_int64_t            queueCounter(const nlohmann::json &p_metrics, const char *p_name)
+{
+    return p_metrics.at("eventQueue").at(p_name).get<u_int64_t>();
+}
+
+static u_int64_t            queueLanesSum(const nlohmann::json &p_metrics, const char *p_name)
+{
+    u_int64_t   l_sum = 0;
+
+    for (const nlohmann::json &l_lane : p_metrics.at("eventQueue").at(p_name))
+        l_sum += l_lane.get<u_int64_t>();
+    return l_sum;
+}
+
+/**
+ * @brief
+ * Percentiles of the values recorded by a histogram of the agent between two reads of its metrics
+ * (the histograms of the agent count from its start) : difference of the buckets, then the upper bound
+ * of the bucket holding each percentile, like Histogram::percentile
+ *
+ * @param p_before
+ * @param p_after
+ * @param p_percentiles
+ * @param p_values [out] same size as p_percentiles
+ * @return u_int64_t count of values recorded between the two reads
+ */
+static u_int64_t            histogramPercentiles(const nlohmann::json &p_before, const nlohmann::json &p_after,
+                                                 const std::vector<double> &p_percentiles, std::vector<u_int64_t> &p_values)
+{
+    std::map<u_int64_t, u_int64_t>  l_buckets;
+    u_int64_t                       l_count = 0;
+
+    for (const nlohmann::json &l_bucket : p_after.at("buckets"))
+        l_buckets[l_bucket.at(0).get<u_int64_t>()] += l_bucket.at(1).get<u_int64_t>();
+    for (const nlohmann::json &l_bucket : p_before.at("buckets"))
+        l_buckets[l_bucket.at(0).get<u_int64_t>()] -= l_bucket.at(1).get<u_int64_t>();
+    for (const auto &l_bucket : l_buckets)
+        l_count += l_bucket.second;
+
+    p_values.assign(p_percentiles.size(), 0);
+    for (size_t i = 0; i < p_percentiles.size() && l_count > 0; i++)
+    {
+        u_int64_t   l_rank = std::max<u_int64_t>(1, (u_int64_t)(p_percentiles[i] * (double)l_count / 100.0 + 0.5));
+        u_int64_t   l_seen = 0;
+
+        for (const auto &l_bucket : l_buckets)
+        {
+            l_seen += l_bucket.second;
+            if (l_seen >= l_rank)
+            {
+                p_values[i] = std::min(l_bucket.first, p_after.at("max").get<u_int64_t>());
+                break;
+            }
+        }
+    }
+    return l_count;
+}
+
+// counter of the snapshot of a collector
+static u_int64_t            collectorCounter(const nlohmann::json &p_metrics, const char *p_name)
+{
+    return p_metrics.at("collector").at(p_name).get<u_int64_t>();
+}
+
+/**
+ * @brief
+ * Wait until the agent has drained its queue (empty lanes and no more pop),
+ * or the collector its rings (no byte pending and no more decoding), or the settle time is over
+ *
+ * @param p_options
+ * @param p_metrics [out] last metrics read
+ * @return bool the queue was drained
+ */
+static bool                 settle(const FlooderOptions &p_options, nlohmann::json &p_metrics)
+{
+    auto        l_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(p_options.settleTime);
+    u_int64_t   l_popped = 0;
+
+    while (readMetrics(p_options.metricsSocketPath, p_metrics))
+    {
+        bool        l_isCollector = p_metrics.count("collector") != 0;
+        u_int64_t   l_depth = l_isCollector ? collectorCounter(p_metrics, "pendingBytes") : queueLanesSum(p_metrics, "depth");
+        u_int64_t   l_done = l_isCollector ? collectorCounter(p_metrics, "decoded") : queueCounter(p_metrics, "popped");
+
+        if (l_depth == 0 && l_done == l_popped)
+            return true;
+        if (std::chrono::steady_clock::now() >= l_deadline)
+            return false;
+
+        l_popped = l_done;
+        std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_PERIOD));
+    }
+    return false;
+}
+
+/**
+ * @brief
+ * Report of a collector : the notifications received by its receivers, decoded by its shards,
+ * and the losses on the way (receive buffers of the sockets, full rings)
+ *
+ * @param p_result
+ * @param p_before
+ * @param p_after
+ * @param p_isDrained
+ */
+static void                 reportCollector(const FlooderResult &p_result, const nlohmann::json &p_before,
+                                            const nlohmann::json &p_after, bool p_isDrained)
+{
+    u_int64_t   l_received = collectorCounter(p_after, "received") - collectorCounter(p_before, "received");
+    u_int64_t   l_decoded = collectorCounter(p_after, "decoded") - collectorCounter(p_before, "decoded");
+    u_int64_t   l_dropped = collectorCounter(p_after, "dropped") - collectorCounter(p_before, "dropped");
+    u_int64_t   l_invalid = collectorCounter(p_after, "invalid") - collectorCounter(p_before, "invalid");
+    // other senders may flood the collector at the same time : the loss is a lower bound
+    u_int64_t   l_lost = l_received < p_result.sent ? p_result.sent - l_received : 0;
+
+    std::printf("received    %llu (%.0f /s), lost in the socket buffers %llu (%.2f %%)\n",
+                (unsigned long long)l_received, (double)l_received / p_result.elapsed,
+                (unsigned long long)l_lost, p_result.sent ? 100.0 * (double)l_lost / (double)p_result.sent : 0.0);
+    std::printf("decoded     %llu (%.0f /s), dropped by full rings %llu, invalid %llu%s\n",
+                (unsigned long long)l_decoded, (double)l_decoded / p_result.elapsed,
+                (unsigned long long)l_dropped, (unsigned long long)l_invalid,
+                p_isDrained ? "" : " (not drained at the end of --settle)");
+
+    for (const nlohmann::json &l_receiver : p_after.at("collector").at("receivers"))
+        std::printf("  receiver %d : %llu received\n", l_receiver.at("id").get<int>(),
+                    (unsigned long long)l_receiver.at("received").get<u_int64_t>());
+    for (const nlohmann::json &l_shard : p_after.at("collector").at("shards"))
+        std::printf("  shard %d    : %llu decoded, %llu sources\n", l_shard.at("id").get<int>(),
+                    (unsigned long long)l_shard.at("decoded").get<u_int64_t>(),
+                    (unsigned long long)l_shard.at("sources").get<u_int64_t>());
+}
+
+/**
+ * @brief
+ * Connect a datagram socket to --unix, or to --host / --port
+ * a full Unix socket blocks sendmmsg : the flooder slows down instead of losing notifications
+ *
+ * @param p_options
+ * @return int -1 on failure
+ */
+static int                  openSocket(const FlooderOptions &p_options)
+{
+    sockaddr_in l_address;
+    int         l_sendBufferSize = 4 * 1024 * 1024;
+    int         l_socketfd;
+
+    if (!p_options.unixPath.empty())
+    {
+        struct sockaddr_un  l_unixAddress;
+
+        std::memset(&l_unixAddress, 0, sizeof(l_unixAddress));
+        l_unixAddress.sun_family = AF_UNIX;
+        std::strncpy(l_unixAddress.sun_path, p_options.unixPath.c_str(), sizeof(l_unixAddress.sun_path) - 1);
+        if ((l_socketfd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0)) < 0 ||
+            connect(l_socketfd, (struct sockaddr *)&l_unixAddress, sizeof(l_unixAddress)) < 0)
+        {
+            std::fprintf(stderr, "socket [%s] : %s\n", p_options.unixPath.c_str(), std::strerror(errno));
+            return -1;
+        }
+        setsockopt(l_socketfd, SOL_SOCKET, SO_SNDBUF, &l_sendBufferSize, sizeof(l_sendBufferSize));
+        return l_socketfd;
+    }
+
+    std::memset(&l_address, 0, sizeof(l_address));
+    l_address.sin_family = AF_INET;
+    l_address.sin_port = htons((u_int16_t)p_options.port);
+    if (inet_pton(AF_INET, p_options.host.c_str(), &l_address.sin_addr) != 1)
+    {
+        std::fprintf(stderr, "invalid host [%s]\n", p_options.host.c_str());
+        return -1;
+    }
+
+    if ((l_socketfd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)) < 0 ||
+        connect(l_socketfd, reinterpret_cast<sockaddr *>(&l_address), sizeof(l_address)) < 0)
+    {
+        std::fprintf(stderr, "socket [%s:%d] : %s\n", p_options.host.c_str(), p_options.port, std::strerror(errno));
+        return -1;
+    }
+    setsockopt(l_socketfd, SOL_SOCKET, SO_SNDBUF, &l_sendBufferSize, sizeof(l_sendBufferSize));
+
+    return l_socketfd;
+}
+
+int                         main(int argc, char **argv)
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    FlooderOptions  l_options;
+    FlooderResult   l_result;
+    nlohmann::json  l_before;
+    nlohmann::json  l_after;
+    bool            l_hasMetrics;
+    bool            l_isDrained = false;
+    long long       l_ticksBefore;
+    long long       l_ticksAfter;
+    std::vector<int> l_socketfds;
+
+    if (!parseOptions(argc, argv, l_options))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (int i = 0; i < l_options.socketCount; i++)
+    {
+        l_socketfds.push_back(openSocket(l_options));
+        if (l_socketfds.back() < 0)
+            return EXIT_FAILURE;
+    }
+
+    l_hasMetrics = !l_options.metricsSocketPath.empty() && readMetrics(l_options.metricsSocketPath, l_before);
+    if (!l_options.metricsSocketPath.empty() && !l_hasMetrics)
+        return EXIT_FAILURE;
+
+    std::printf("flooding %s : %llu notifications/s during %d s from %u sources over %d sockets (mix %d,%d,%d)\n",
+                l_options.unixPath.empty() ? (l_options.host + ":" + std::to_string(l_options.port)).c_str() : l_options.unixPath.c_str(),
+                (unsigned long long)l_options.rate, l_options.duration, l_options.sourceCount, l_options.socketCount,
+                l_options.weights[0], l_options.weights[1], l_options.weights[2]);
+
+    auto l_start = std::chrono::steady_clock::now();
+
+    l_ticksBefore = readCpuTicks(l_options.agentPid);
+    flood(l_options, l_socketfds, l_result);
+    for (int l_socketfd : l_socketfds)
+        close(l_socketfd);
+
+    if (l_hasMetrics)
+        l_isDrained = settle(l_options, l_after);
+    l_ticksAfter = readCpuTicks(l_options.agentPid);
+
+    double l_wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - l_start).count();
+
+    std::printf("\nsent        %llu in %.2f s (%.0f /s) : %llu stats, %llu alerts, %llu configs, %llu send errors\n",
+                (unsigned long long)l_result.sent, l_result.elapsed, (double)l_result.sent / l_result.elapsed,
+                (unsigned long long)l_result.sentByType[0], (unsigned long long)l_result.sentByType[1],
+                (unsigned long long)l_result.sentByType[2], (unsigned long long)l_result.sendErrors);
+
+    if (l_hasMetrics && l_after.count("collector"))
+        reportCollector(l_result, l_before, l_after, l_isDrained);
+    else if (l_hasMetrics)
+    {
+        std::vector<double>     l_percentiles = { 50, 90, 99, 99.9 };
+        std::vector<u_int64_t>  l_latencies;
+        u_int64_t               l_pushed = queueCounter(l_after, "pushed") - queueCounter(l_before, "pushed");
+        u_int64_t               l_popped = queueCounter(l_after, "popped") - queueCounter(l_before, "popped");
+        u_int64_t               l_coalesced = queueCounter(l_after, "coalesced") - queueCounter(l_before, "coalesced");
+        u_int64_t               l_aged = queueCounter(l_after, "aged") - queueCounter(l_before, "aged");
+        u_int64_t               l_shed = queueLanesSum(l_after, "shed") - queueLanesSum(l_before, "shed");
+        // the observer of the agent pushes its own events : the loss is a lower bound
+        u_int64_t               l_lost = l_pushed < l_result.sent ? l_result.sent - l_pushed : 0;
+        u_int64_t               l_dispatched;
+
+        l_dispatched = histogramPercentiles(l_before.at("dispatchLatency_us"), l_after.at("dispatchLatency_us"),
+                                            l_percentiles, l_latencies);
+
+        std::printf("ingested    %llu (%.0f /s), lost before the queue %llu (%.2f %%)\n",
+                    (unsigned long long)l_pushed, (double)l_pushed / l_result.elapsed,
+                    (unsigned long long)l_lost, l_result.sent ? 100.0 * (double)l_lost / (double)l_result.sent : 0.0);
+        std::printf("queue       popped %llu, coalesced %llu, shed %llu, aged %llu%s\n",
+                    (unsigned long long)l_popped, (unsigned long long)l_coalesced, (unsigned long long)l_shed,
+                    (unsigned long long)l_aged, l_isDrained ? "" : " (not drained at the end of --settle)");
+        std::printf("dispatch    %llu events, latency us : p50 %llu, p90 %llu, p99 %llu, p99.9 %llu\n",
+                    (unsigned long long)l_dispatched, (unsigned long long)l_latencies[0], (unsigned long long)l_latencies[1],
+                    (unsigned long long)l_latencies[2], (unsigned long long)l_latencies[3]);
+    }
+
+    if (l_ticksBefore >= 0 && l_ticksAfter >= 0)
+        std::printf("cpu         %.1f %% of a core\n",
+                    100.0 * (double)(l_ticksAfter - l_ticksBefore) / (double)sysconf(_SC_CLK_TCK) / l_wall);
+
+    google::protobuf::ShutdownProtobufLibrary();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+#ifndef _AGENT_METRICS_HPP_
+#define _AGENT_METRICS_HPP_
+
+#include "commonTools.hpp"
+#include "eventQueue.hpp"
+
+#include <atomic>
+
+# define HISTOGRAM_BUCKET_COUNT 40 // bucket 0 : 0, bucket i : [2^(i-1), 2^i[, the last one is unbounded
+
+// Histogram with power of 2 buckets, recorded without lock by any thread
+class Histogram
+{
+
+public:
+
+    Histogram(void);
+
+    Histogram(const Histogram &p_source) = delete;
+    Histogram &operator=(const Histogram &p_source) = delete;
+
+    void                                record(u_int64_t p_value);
+
+    u_int64_t                           count(void) const;
+    u_int64_t                           max(void) const;
+
+    // upper bound of the bucket holding the p_percentile (0 - 100) value
+    u_int64_t                           percentile(double p_percentile) const;
+
+    // count, sum, max, mean, p50, p90, p99 and the non empty buckets [upper bound, count]
+    nlohmann::json                      toJson(void) const;
+
+    static size_t                       bucketOf(u_int64_t p_value);
+    static u_int64_t                    bucketUpperBound(size_t p_bucket);
+
+private:
+
+    std::atomic<u_int64_t>              i_buckets[HISTOGRAM_BUCKET_COUNT];
+    std::atomic<u_int64_t>              i_count;
+    std::atomic<u_int64_t>              i_sum;
+    std::atomic<u_int64_t>              i_max;
+
+}; // end class Histogram
+
+// Metrics of the agent itself, recorded by the controller for each event it dispatches
+class AgentMetrics
+{
+
+public:
+
+    // the drops and the depth of each lane are read from the queue
+    explicit AgentMetrics(const EventQueue *p_eventList);
+
+    AgentMetrics(const AgentMetrics &p_source) = delete;
+    AgentMetrics &operator=(const AgentMetrics &p_source) = delete;
+
+    // an event just popped : source -> reception and reception -> dispatch latencies, queue depth
+    void                                recordDispatch(const Event &p_event, size_t p_queueDepth);
+
+    // time spent by the controller on an event
+    void                                recordProcessing(e_eventType p_eventType, u_int64_t p_duration);
+
+    // every histogram and the counters of the queue
+    nlohmann::json                      toJson(void) const;
+
+private:
+
+    const EventQueue                    *i_eventList;
+
+    Histogram                           i_sourceLatency; // s, sendingDate -> eventReceptionTime (both in seconds)
+    Histogram                           i_dispatchLatency; // us, EventQueue::push -> controller
+    Histogram                           i_processingTime[EVENT_TYPE_COUNT]; // us, by event type
+    Histogram                           i_queueDepth; // events still waiting when one is popped
+
+}; // end class AgentMetrics
+
+#endif
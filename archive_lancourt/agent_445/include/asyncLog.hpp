@@ -0,0 +1,119 @@
+#ifndef _ASYNC_LOG_HPP_
+#define _ASYNC_LOG_HPP_
+
+#include "iLog.hpp"
+
+#include <atomic>
+#include <cstdarg>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+// levels above AGENT_LOG_LEVEL are compiled out of the AGENT_LOG calls, their arguments are not evaluated
+// (ex. -DAGENT_LOG_LEVEL=LOG_INFO in release)
+#ifndef AGENT_LOG_LEVEL
+# define AGENT_LOG_LEVEL LOG_DEBUG
+#endif
+
+# define AGENT_LOG(p_log, p_level, ...) \
+    do { if ((p_level) <= AGENT_LOG_LEVEL) (p_log).log((p_level), __VA_ARGS__); } while (0)
+
+# define LOG_RING_SLOTS 1024 // records waiting in the ring of one thread, the next ones are dropped
+# define LOG_RECORD_SIZE 256 // bytes of a record, a call whose arguments do not fit is formatted by the calling thread
+# define LOG_LINE_SIZE 1024 // formatted line given to the sink
+# define LOG_DRAIN_PERIOD 10 // ms between two drains of the rings by the writing thread
+
+// One log call : the format (a string literal, kept as a pointer) and its arguments in binary,
+// formatted later by the writing thread
+struct LogRecord
+{
+    const char                          *format;
+    u_int64_t                           sequence; // order of the calls across the threads
+    int                                 priority;
+    u_int16_t                           length; // bytes used in arguments
+    char                                arguments[LOG_RECORD_SIZE - 2 * sizeof(u_int64_t) - sizeof(int) - sizeof(u_int16_t)];
+};
+
+// Asynchronous ILog : the callers copy their arguments in a lock free ring of their thread,
+// one thread formats the records and writes them to the sink (ex. Syslog)
+// a full ring drops the record (droppedCount), a log call never waits
+// before start and after stop, the calls are written to the sink by the calling thread :
+// stop waits for the pushes in progress, a record is either drained or written directly, never lost
+class AsyncLog : public ILog
+{
+
+public:
+
+    explicit AsyncLog(ILog &p_sink);
+    ~AsyncLog(void);
+
+    AsyncLog(const AsyncLog &p_source) = delete;
+    AsyncLog &operator=(const AsyncLog &p_source) = delete;
+
+    // launch the writing thread
+    bool                                start(void);
+
+    // write the records left, then stop the writing thread
+    void                                stop(void);
+
+    // printf like, the format must outlive the call (string literal)
+    void                                log(int p_priority, const char *p_format, ...);
+
+    // records dropped by a full ring
+    u_int64_t                           droppedCount(void) const;
+
+    // copy the arguments described by p_format in p_record, false if an argument does not fit
+    static bool                         encode(LogRecord &p_record, const char *p_format, va_list p_arguments);
+
+    // format a record like vsnprintf(p_format, arguments)
+    static void                         format(const LogRecord &p_record, char *p_line, size_t p_size);
+
+private:
+
+    // single producer (the thread) single consumer (the writing thread) ring
+    struct Ring
+    {
+        std::atomic<u_int64_t>          head; // next record written by the thread
+        std::atomic<bool>               isPushing; // the thread is between its check of i_isRunning and its push
+        char                            headPadding[64]; // head and tail on their own cache lines
+        std::atomic<u_int64_t>          tail; // next record read by the writing thread
+        char                            tailPadding[64];
+        LogRecord                       records[LOG_RING_SLOTS];
+
+        Ring(void) : head(0), isPushing(false), tail(0) {}
+    };
+
+    ILog                                &i_sink;
+    const u_int64_t                     i_id; // the rings of the threads are found by the id of their AsyncLog
+
+    std::mutex                          i_ringsMutex;
+    std::vector<std::unique_ptr<Ring>>  i_rings; // one per thread which logged, kept after its end
+
+    std::atomic<bool>                   i_isRunning; // the calls go to the rings
+    std::atomic<bool>                   i_isWriting; // the writing thread drains, until its last drain
+    std::atomic<u_int64_t>              i_sequence;
+    std::atomic<u_int64_t>              i_droppedCount;
+
+    std::mutex                          i_wakeMutex;
+    std::condition_variable             i_wakeCondition;
+    std::thread                         i_writerThread;
+
+    // ring of the calling thread, created at its first call
+    Ring                                *threadRing(void);
+
+    // write a call to the sink from the calling thread, before start and after stop
+    void                                logNow(int p_priority, const char *p_format, va_list p_arguments);
+
+    // writing thread : drain the rings every LOG_DRAIN_PERIOD
+    void                                write(void);
+
+    // move the records of every ring to the sink, in the order of the calls
+    void                                drain(std::vector<LogRecord> &p_records);
+
+}; // end class AsyncLog
+
+#endif
@@ -3,6 +3,7 @@
 #include <iostream> // std::cout | std::endl
 #include <list> // std::list
 #include <ctime> // std::time_t
+#include <chrono>
 #include <thread>
 #include <mutex>
 #include <list>
@@ -21,6 +22,7 @@
 
 #include "json.hpp"
 #include "jsonTools.hpp"
+#include "eventPayload.hpp"
 
 #include <map>
 #include <iterator>
@@ -87,6 +89,23 @@ struct  Module
     int                         id;
     std::string                 name;
     std::string                 parameters; // informations associated to a module (launch parameters, stats of running)
+    std::string                 cpuset; // cpu list the module is pinned on (ex. "0-3,8"), empty == no pinning
+    int                         numaNode = -1; // numa node the module memory is bound to, -1 == no binding
+};
+
+// module launched by the controller, kept to compare the next configuration with
+struct  RunningModule
+{
+    Module                      module;
+    size_t                      parametersHash; // std::hash of module.parameters
+    pid_t                       pid;
+};
+
+// process of a module to stop : its pid and the pidfd the observer supervised it with
+struct  ModuleProcess
+{
+    pid_t                       pid;
+    int                         pidfd = -1; // -1 : not supervised, the stopper opens its own and reaps the module
 };
 
 struct  Event
@@ -100,15 +119,19 @@ struct  Event
     e_eventType                         eventType; // notifType --> Notifications_NotificationType
     u_int64_t                           sendingDate;
     std::time_t                         eventReceptionTime;
-    nlohmann::json                      jsonData;    
+    EventPayload                        jsonData; // parsed on the first access (jsonData.json())
+    std::chrono::steady_clock::time_point   queuedTime; // set by EventQueue::push
 };
 
-// comparison the i_eventList priority queue
+// order of the i_eventList lanes : by type (CONFIG first), then by priority (FATAL first)
+// true when p_newEvent goes after p_oldEvent
 struct  compareEventPriority
 {
     bool operator()(const Event &p_newEvent, const Event &p_oldEvent) const
     {
-        return ((int)p_newEvent.eventType > (int)p_oldEvent.eventType);
+        if (p_newEvent.eventType != p_oldEvent.eventType)
+            return ((int)p_newEvent.eventType > (int)p_oldEvent.eventType);
+        return ((int)p_newEvent.eventPriority < (int)p_oldEvent.eventPriority);
     }
 };
 
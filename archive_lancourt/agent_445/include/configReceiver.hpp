@@ -2,6 +2,7 @@
 #include "iLog.hpp"
 
 #include "commonTools.hpp"
+#include "eventQueue.hpp"
 
 #ifndef _CONFIG_RECEIVER_HPP_
 #define _CONFIG_RECEIVER_HPP_
@@ -13,7 +14,7 @@ class ConfigReceiver : public IConfigReceiver
  
 public: // -------------------------------------------------------------------------------- [ PUBLIC ]
 
-    ConfigReceiver(INetconfServer &p_netconfServer, std::priority_queue<Event, std::vector<Event>, compareEventPriority> *p_eventList, ILog &p_log); 
+    ConfigReceiver(INetconfServer &p_netconfServer, EventQueue *p_eventList, ILog &p_log); 
 
     ~ConfigReceiver(void);
  
@@ -37,7 +38,6 @@ private: // --------------------------------------------------------------------
     INetconfServer                  &i_netconfServer;
     ILog                            &i_log;
     std::thread                     i_eventThread;
-    std::mutex                      i_eventMutex;
     bool                            i_isRunning;
     
     enum class                      eInitNetconfServer { SUCCESS, FAILURE };
@@ -54,7 +54,7 @@ private: // --------------------------------------------------------------------
     eAddEvent                       addEvent(nlohmann::json p_json, e_eventType p_type);
 
     // i_eventList
-    std::priority_queue<Event, std::vector<Event>, compareEventPriority> *i_eventList;
+    EventQueue                      *i_eventList;
 
 #endif
 };
@@ -5,6 +5,21 @@
 #include "iLog.hpp"
 #include "iController.hpp"
 #include "commonTools.hpp"
+#include "eventQueue.hpp"
+#include "agentMetrics.hpp"
+#include "metricsServer.hpp"
+#include "statsStore.hpp"
+#include "statsServer.hpp"
+
+// modules to stop, start and restart to go from the running modules to a new configuration
+struct  ModuleDiff
+{
+    std::list<int>                      toStop; // id of the modules removed from the configuration
+    std::list<Module>                   toStart; // new modules
+    std::list<Module>                   toRestart; // same id, other name or parameters
+    std::list<int>                      duplicateIds; // given more than once, only the first module of the id is compared
+    int                                 unchangedCount = 0;
+};
 
 class Controller : public IController
 {
@@ -13,7 +28,7 @@ public:
 
 // ----------------------------------------------------------------------------------------------- [ function ]
 
-    Controller(std::priority_queue<Event, std::vector<Event>, compareEventPriority> *p_eventList,
+    Controller(EventQueue *p_eventList,
                 IConfigReceiver &p_configReceiver, 
                 IStatusReceiver &p_statusReceiver,
                 ILauncher &p_launcher, 
@@ -35,6 +50,10 @@ public:
     // brief : stop all the classes references , according to the given signal
     IController::eStopAll               stopAll(int p_sigNum);
 
+    // compare the running modules (keyed by id) with the modules of a new configuration
+    static ModuleDiff                   diffModules(const std::map<int, RunningModule> &p_runningModules,
+                                                    const std::list<Module> &p_newModules);
+
 private: // =================================================================================================== //
 
     void                                printEventDebug(Event p_event);
@@ -47,9 +66,10 @@ private: // ====================================================================
     // and give it to the controller method "eventProcessing"
     void                                eventHandler(void); // onEvent
 
-    // get the top event (the highest priority), and pop it from the i_eventList
+    // wait for the top event (the highest priority), and move it out of the i_eventList
+    // return false when the i_eventList is closed
     // see i_eventList at the bottom of the page
-    Event                               getEvent(void);
+    bool                                getEvent(Event &p_event);
 
     // get the module list and loop on each module to call
     // the launchModule method of the launcher class
@@ -57,9 +77,13 @@ private: // ====================================================================
 
     // retrieve modules (see commonTools.hpp) from a json file push each one in a list
     // set the "module" fields by parsing the json file given to the program
-    std::list<Module>                   getModulesListFromJson(nlohmann::json    &p_json);
+    std::list<Module>                   getModulesListFromJson(const nlohmann::json &p_json);
+
+    // launch a module and add it to i_runningModules
+    void                                startModule(const Module &p_module);
 
-    void                                pushPid(pid_t modulePid);
+    // stop the given running modules and remove them from i_runningModules
+    void                                stopModules(const std::list<int> &p_moduleIds);
 // ----------------------------------------------------------------------------------------------- [ attribute ]
 
     IConfigReceiver                     &i_configReceiver;
@@ -71,16 +95,26 @@ private: // ====================================================================
     bool                                i_running;
 
     std::thread                         i_eventThread;
-    std::mutex                          i_eventMutex;
 
     // MAP
     std::map<std::string, std::string>  i_map;
     
-    // module pid
-    std::list<pid_t>                    i_modulePidList;
+    // running modules by id
+    std::map<int, RunningModule>        i_runningModules;
 
     // i_eventList
-    std::priority_queue<Event, std::vector<Event>, compareEventPriority> *i_eventList;
+    EventQueue                          *i_eventList;
+
+    // latencies, processing times and queue depth, read through the "metrics_socketPath" Unix socket
+    AgentMetrics                        i_metrics;
+    MetricsServer                       i_metricsServer;
+
+    // history of the STATS events by source and metric, read through the "stats_socketPath" Unix socket
+    StatsStore                          i_statsStore;
+    StatsServer                         i_statsServer;
+
+    // syslog level of the configuration ("logLevel"), the events are printed from LOG_DEBUG
+    int                                 i_logLevel;
 
 }; // end class Controller
 
@@ -0,0 +1,60 @@
+#ifndef _EVENT_PAYLOAD_HPP_
+#define _EVENT_PAYLOAD_HPP_
+
+#include "json.hpp"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+// json payload of an event, kept as the raw bytes received and parsed on the first access
+// the copies of an event share the same buffer (and the same parsed json)
+class EventPayload
+{
+
+public:
+
+    EventPayload(void);
+
+    // raw json text, not parsed before json() or get()
+    explicit EventPayload(std::string p_raw);
+
+    // json already parsed (config received through netconf)
+    explicit EventPayload(nlohmann::json p_json);
+
+    // parse the whole payload on the first call, throw nlohmann::json::parse_error if invalid (at every call)
+    const nlohmann::json                &json(void) const;
+
+    // value of a top level key, only this key is built when the payload is not parsed yet
+    // null for an empty payload, like json(), throw nlohmann::json::out_of_range if the key is missing
+    nlohmann::json                      get(const std::string &p_key) const;
+
+    const std::string                   &raw(void) const;
+    bool                                empty(void) const;
+    bool                                isParsed(void) const;
+
+private:
+
+    enum class eParse { PENDING, PARSED, FAILED };
+
+    // not std::call_once : it does not retry after an exception with libstdc++ (GCC bug 66146), it hangs
+    struct State
+    {
+        std::string                     raw;
+        nlohmann::json                  json;
+        std::mutex                      parseMutex;
+        std::atomic<eParse>             parse{eParse::PENDING};
+        std::exception_ptr              parseError; // FAILED : thrown again by the next calls
+    };
+
+    std::shared_ptr<State>              i_state;
+
+}; // end class EventPayload
+
+// the raw text, or the json when it was given already parsed
+std::ostream                            &operator<<(std::ostream &p_stream, const EventPayload &p_payload);
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef _EVENT_QUEUE_HPP_
+#define _EVENT_QUEUE_HPP_
+
+#include "commonTools.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <tuple>
+
+# define EVENT_QUEUE_CAPACITY   4096    // events waiting in the queue, the lowest lanes are shed beyond
+# define EVENT_AGING_DELAY      500     // ms, an event waiting longer goes before the higher lanes
+# define EVENT_TYPE_COUNT       4       // CONFIG .. UNDEFINED
+# define EVENT_PRIORITY_COUNT   4       // DEFAULT_PRIORITY .. FATAL
+# define EVENT_LANE_COUNT       (EVENT_TYPE_COUNT * EVENT_PRIORITY_COUNT)
+
+// counters of the queue, by lane (see EventQueue::laneOf)
+struct  EventQueueCounters
+{
+    u_int64_t                           pushed;
+    u_int64_t                           popped;
+    u_int64_t                           coalesced; // STATS replaced by a newer one of the same source
+    u_int64_t                           aged; // popped before a higher lane because of their waiting time
+    u_int64_t                           shed[EVENT_LANE_COUNT]; // dropped because the queue was full
+    size_t                              depth[EVENT_LANE_COUNT];
+};
+
+// Bounded priority queue of the events shared by the receivers (producers) and the controller (consumer)
+// one FIFO lane per event type and priority, popped in the compareEventPriority order :
+// CONFIG before ALERT before STATS, then FATAL before ERROR before WARNING before DEFAULT_PRIORITY
+// an event waiting more than the aging delay goes first, so the low lanes still progress
+// when the queue is full, the oldest event of the lowest lane is dropped (shed)
+// one mutex for every producer and the consumer, the consumer sleeps until an event is pushed
+// the STATS events are coalesced : only the latest one of each source waits in the queue
+class EventQueue
+{
+
+public:
+
+    explicit EventQueue(size_t p_capacity = EVENT_QUEUE_CAPACITY, int p_agingDelay = EVENT_AGING_DELAY);
+    ~EventQueue(void);
+
+    EventQueue(const EventQueue &p_source) = delete;
+    EventQueue &operator=(const EventQueue &p_source) = delete;
+
+    // push an event and wake up the consumer
+    // a STATS event replaces the STATS of the same source still waiting (same place in the queue),
+    // or takes its place at the back of its own lane when its priority changed
+    // when the queue is full, the oldest event of the lowest lane (the pushed one if it is the lowest) is shed
+    void                                push(Event p_event);
+
+    // wait for the highest priority event and move it out of the queue
+    // return false when the queue is closed
+    bool                                pop(Event &p_event);
+
+    // same as pop without waiting, return false when the queue is empty
+    bool                                tryPop(Event &p_event);
+
+    // wake up the consumer waiting in pop, the next pops return false
+    void                                close(void);
+
+    // remove all the events
+    void                                clear(void);
+
+    bool                                empty(void) const;
+    size_t                              size(void) const;
+
+    // count of STATS events replaced by a newer one before being popped
+    u_int64_t                           coalescedCount(void) const;
+
+    // count of events dropped because the queue was full, every lane
+    u_int64_t                           shedCount(void) const;
+
+    EventQueueCounters                  counters(void) const;
+
+    // lane of an event, 0 is popped first (out of range types and priorities are clamped)
+    static size_t                       laneOf(e_eventType p_eventType, e_eventPriority p_eventPriority);
+
+private:
+
+    // source of a coalesced event
+    typedef std::tuple<int, u_int32_t, int>     StatsKey; // sourceType, sourceID, eventType
+
+    // the deque keeps the references to its elements on push_back and pop_front
+    std::deque<Event>                   i_lanes[EVENT_LANE_COUNT];
+    size_t                              i_size;
+    size_t                              i_capacity;
+    std::chrono::milliseconds           i_agingDelay;
+
+    // latest STATS of each source, in its lane
+    std::map<StatsKey, Event *>         i_latestStats;
+
+    EventQueueCounters                  i_counters;
+
+    mutable std::mutex                  i_mutex;
+    std::condition_variable             i_condition;
+    bool                                i_isClosed;
+
+    static bool                         isCoalesced(const Event &p_event);
+    static StatsKey                     statsKey(const Event &p_event);
+
+    // move the next event out of the queue, the queue is locked and not empty
+    void                                popLocked(Event &p_event);
+
+    // drop the oldest event of a lane, the queue is locked
+    void                                shedLocked(size_t p_lane);
+
+    // remove a waiting STATS from its lane, the queue is locked
+    void                                eraseLocked(size_t p_lane, const Event *p_event);
+
+}; // end class EventQueue
+
+#endif
@@ -18,14 +18,14 @@ public:
     enum class                      eStopAll { SUCCESS, FAILURE };
     virtual eStopAll                stopAll(int p_sigNum) = 0;
 
-    virtual std::list<Module>       getModulesListFromJson(nlohmann::json &p_json) = 0;
+    virtual std::list<Module>       getModulesListFromJson(const nlohmann::json &p_json) = 0;
     
     enum class                      eThreadManager { SUCCESS, FAILURE };
     virtual eThreadManager          threadManager(void) = 0;
 
     virtual void                    eventHandler(void) = 0; // a virer
 
-    virtual Event                   getEvent(void) = 0;
+    virtual bool                    getEvent(Event &p_event) = 0;
 
 }; // end class Balancer
 
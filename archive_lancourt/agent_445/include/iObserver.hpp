@@ -5,15 +5,24 @@
 
 class IObserver
 {
- 
+
 public:
 
     enum class                              eInit { SUCCESS, FAILURE };
-    virtual eInit                           init(void) = 0;
+    virtual eInit                           init(const nlohmann::json &p_json) = 0;
+
+    enum class                              eStart { SUCCESS, FAILURE };
+    virtual eStart                          start(void) = 0;
 
     enum class                              eStop { SUCCESS, FAILURE };
     virtual eStop                           stop(int p_sigNum) = 0;
- 
+
+    enum class                              eWatchModule { SUCCESS, FAILURE };
+    virtual eWatchModule                    watchModule(const Module &p_module, pid_t p_modulePid) = 0;
+
+    enum class                              eUnwatchModule { SUCCESS, FAILURE };
+    virtual eUnwatchModule                  unwatchModule(int p_moduleId, ModuleProcess *p_moduleProcess) = 0;
+
 }; // end class Observer
 
-#endif
\ No newline at end of file
+#endif
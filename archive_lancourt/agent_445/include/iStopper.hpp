@@ -12,7 +12,7 @@ public:
     virtual eInit                           init(void) = 0;
 
     enum class                              eStopModule { SUCCESS, FAILURE };
-    virtual eStopModule                     stopModule(std::list<pid_t> p_modulePidList) = 0;
+    virtual eStopModule                     stopModule(std::list<ModuleProcess> p_moduleProcessList) = 0;
  
 }; // end class Stopper
 
@@ -4,13 +4,27 @@
 #include "agent.hpp"
 #include "commonTools.hpp"
 #include "iLog.hpp"
+#include "statusPages.hpp"
+
+#include <sched.h> // cpu_set_t
+
+// placement of the spawning thread, saved while a module is spawned with its own placement
+struct  ThreadPlacement
+{
+    bool                        hasCpuSet;
+    cpu_set_t                   cpuSet;
+    bool                        hasMemoryPolicy;
+    int                         memoryPolicy;
+    unsigned long               nodeMask[1024 / (8 * sizeof(unsigned long))]; // MAX_NUMNODES of the kernel
+};
 
 class Launcher : public ILauncher
 {
  
 public:
 
-    Launcher(ILog &p_log, char **envp);
+    // p_statusPages : a status page is created for each launched module (nullptr : none)
+    Launcher(ILog &p_log, char **envp, StatusPages *p_statusPages = nullptr);
     ~Launcher(void);
 
     Launcher(const Launcher& p_source) = delete;
@@ -26,11 +40,27 @@ public:
     ILauncher::eStop                   stop(int p_sigNum);
 
     // Launch a program pointed to by module.name (module define in the include/commonTools.hpp)
-    // with its given parameters pointed to by module.parameters
+    // with its given parameters pointed to by module.parameters, with posix_spawn
     ILauncher::eLaunchModule           launchModule(Module p_module, pid_t *p_modulePid);
 
-    ILog                                &i_log; 
+    // Fill p_cpuSet from a cpu list string (ex. "0-3,8,10-11"), same format as cpuset / taskset -c
+    static bool                        parseCpuList(const std::string &p_cpuList, cpu_set_t *p_cpuSet);
+
+    // Build the cpu set and the numa node mask of a module
+    bool                               getPlacement(const Module &p_module, cpu_set_t *p_cpuSet, bool *p_hasCpuSet,
+                                                    unsigned long *p_nodeMask, bool *p_hasNodeMask);
+
+    // Apply a placement to the calling thread (inherited by the spawned module), save the previous one
+    bool                               setThreadPlacement(const cpu_set_t *p_cpuSet, bool p_hasCpuSet,
+                                                          const unsigned long *p_nodeMask, bool p_hasNodeMask,
+                                                          ThreadPlacement *p_previous);
+
+    // Restore the placement saved by setThreadPlacement
+    void                               restoreThreadPlacement(ThreadPlacement *p_previous);
+
+    ILog                                &i_log;
     char                                **i_envp;
+    StatusPages                         *i_statusPages;
     bool                                i_isLauncherRunning;
  
 }; // end class Launcher
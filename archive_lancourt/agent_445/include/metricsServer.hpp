@@ -0,0 +1,31 @@
+#ifndef _METRICS_SERVER_HPP_
+#define _METRICS_SERVER_HPP_
+
+#include "agentMetrics.hpp"
+#include "unixSocketServer.hpp"
+
+#include <string>
+
+# define METRICS_SEND_TIMEOUT 100 // ms, a reader not reading its socket is dropped
+
+// Local endpoint of the agent metrics : a Unix stream socket,
+// each client connecting gets the json of AgentMetrics::toJson, then the socket is closed
+// (ex. socat - UNIX-CONNECT:/run/agent/metrics.sock)
+class MetricsServer : public UnixSocketServer
+{
+
+public:
+
+    MetricsServer(const AgentMetrics &p_metrics, ILog &p_log);
+    ~MetricsServer(void);
+
+private:
+
+    const AgentMetrics                  &i_metrics;
+
+    // the metrics, the client sends nothing
+    std::string                         answer(const std::string &p_request) override;
+
+}; // end class MetricsServer
+
+#endif
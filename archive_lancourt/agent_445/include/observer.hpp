@@ -3,29 +3,108 @@
 
 #include "agent.hpp"
 #include "iLog.hpp"
+#include "iLauncher.hpp"
+#include "eventQueue.hpp"
+#include "procSampler.hpp"
+#include "statusPages.hpp"
+
+#include <chrono>
+
+# define RESTART_DELAY_MIN      10      // ms, first restart of a module
+# define RESTART_DELAY_MAX      30000   // ms, the delay doubles at each crash up to this one
+# define RESTART_STABLE_TIME    60000   // ms, a module running longer gets back the minimum delay
+# define OBSERVER_MAX_EVENTS    16
+# define SAMPLE_PERIOD          100     // ms, default "observer_samplePeriod" : cpu / ram / timeslices of the modules pushed as STATS events
+
+// module supervised through a pidfd
+struct  WatchedModule
+{
+    Module                                  module;
+    pid_t                                   pid;
+    int                                     pidfd;
+    std::chrono::steady_clock::time_point   startTime;
+    bool                                    isRestartPending;
+    std::chrono::steady_clock::time_point   restartTime;
+    int                                     restartDelay; // ms
+    bool                                    isHung; // running in its status page, but no heartbeat since STATUS_HEARTBEAT_TIMEOUT
+};
 
 class Observer : public IObserver
 {
- 
+
 public:
 
-    Observer(ILog &p_log);
+    // p_statusPages : status pages of the modules (created by the launcher), read at each sample
+    Observer(EventQueue *p_eventList, ILauncher &p_launcher, ILog &p_log, StatusPages *p_statusPages = nullptr);
     ~Observer(void);
 
     Observer(const Observer& p_source) = delete;
     Observer &operator=(const Observer& p_source) = delete;
 
-    // useless for the moment -> TODO : delete it
-    IObserver::eInit                init(void);  
+    // create the epoll set and the eventfd waking up the observer thread,
+    // "observer_samplePeriod" (ms) and "observer_schedstatInterval" (samples) set the cost of the sampling
+    IObserver::eInit                init(const nlohmann::json &p_json);
+
+    // launch the thread waiting for the end of the modules
+    IObserver::eStart               start(void);
 
-    // useless for the moment -> TODO : delete it
+    // stop the thread, the modules are not stopped
     IObserver::eStop                stop(int p_sigNum);
- 
+
+    // supervise a launched module : restarted when it ends
+    IObserver::eWatchModule         watchModule(const Module &p_module, pid_t p_modulePid);
+
+    // stop the supervision before stopping a module (its end is only reaped)
+    // p_moduleProcess gets the current pid of the module (it changes at each restart) and a dup of its pidfd
+    IObserver::eUnwatchModule       unwatchModule(int p_moduleId, ModuleProcess *p_moduleProcess);
+
 private:
-    
-    ILog                           &i_log;
-    bool                           i_isObserverRunning;
- 
+
+    EventQueue                      *i_eventList;
+    ILauncher                       &i_launcher;
+    ILog                            &i_log;
+    bool                            i_isObserverRunning;
+
+    std::thread                     i_observerThread;
+    std::mutex                      i_mutex;
+    int                             i_epollfd;
+    int                             i_wakeEventfd;
+
+    // supervised modules by id, pidfd of each module
+    std::map<int, WatchedModule>    i_watchedModules;
+    std::map<int, int>              i_pidfdModuleIds;
+
+    // pidfd of the modules stopped by the controller, only reaped
+    std::map<int, pid_t>            i_stoppingPids;
+
+    // resources of the running modules, sampled every i_samplePeriod
+    ProcSampler                                 i_sampler;
+    int                                         i_samplePeriod; // ms
+    std::vector<ProcSample>                     i_samples;
+    std::chrono::steady_clock::time_point       i_nextSampleTime;
+    StatusPages                                 *i_statusPages;
+
+    // wait on the pidfds and restart the modules when their delay is over
+    void                            observeModules(void);
+
+    // reap a module which ended and schedule its restart
+    void                            onModuleExit(int p_pidfd);
+
+    // restart the modules whose delay is over, return the ms to wait for the next one (-1 == none)
+    int                             restartModules(void);
+
+    // sample every module in one pass and push a STATS event for each one
+    // return the ms to wait for the next sample (-1 == no module)
+    int                             sampleModules(void);
+
+    // open the pidfd of a pid and add it to the epoll set, -1 on failure
+    int                             openPidfd(pid_t p_pid);
+    void                            closePidfd(int p_pidfd);
+
+    // push a module event (exit, restart) in the i_eventList
+    void                            addEvent(const WatchedModule &p_module, const nlohmann::json &p_json);
+    void                            addStatsEvent(const ProcSample &p_sample, const ModuleStatus *p_status);
+
 }; // end class Observer
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,92 @@
+#ifndef _PROC_SAMPLER_HPP_
+#define _PROC_SAMPLER_HPP_
+
+#include <sys/types.h>
+
+#include <vector>
+
+# define PROC_STAT_BUFFER_SIZE 1024 // /proc/<pid>/stat is about 300 bytes
+# define PROC_SCHEDSTAT_INTERVAL 10 // samples, /proc/<pid>/schedstat is read once every 10 samples
+
+// fields of /proc/<pid>/stat and /proc/<pid>/schedstat used by the sampler
+struct  ProcStat
+{
+    unsigned long long          cpuTicks; // utime + stime of every thread, in clock ticks
+    long                        threadCount;
+    long                        rssPages;
+    unsigned long long          runTime; // ns on a cpu (main thread)
+    unsigned long long          timeslices; // times the main thread was switched in
+};
+
+// one sample of a module, cpuUsage over the time since the previous sample
+struct  ProcSample
+{
+    int                         moduleId;
+    pid_t                       pid;
+    int                         cpuUsage; // % of one core
+    long                        ramUsage; // resident kB
+    long                        threadCount;
+    unsigned long long          cpuTicks; // total since the launch
+    unsigned long long          mainThreadTimeslices; // times the main thread got a cpu since the launch, not the other threads
+};
+
+// Sample the cpu, rss and main thread timeslices of the modules
+// the /proc files of each module stay open and are read again with pread,
+// every module is read in one pass over a contiguous array
+class ProcSampler
+{
+
+public:
+
+    ProcSampler(void);
+    ~ProcSampler(void);
+
+    ProcSampler(const ProcSampler &p_source) = delete;
+    ProcSampler &operator=(const ProcSampler &p_source) = delete;
+
+    // open the /proc files of a module (a module added again replaces its previous pid)
+    bool                                add(int p_moduleId, pid_t p_pid);
+
+    // close the /proc files of a module
+    void                                remove(int p_moduleId);
+
+    // read /proc/<pid>/schedstat once every p_interval samples, 0 : never (about a third of the cost of a sample),
+    // mainThreadTimeslices keeps its previous value in between
+    void                                setSchedstatInterval(unsigned int p_interval);
+
+    // read every module, p_samples is cleared and reused (no allocation once it is big enough)
+    // a module whose files can not be read anymore (ended) is skipped
+    size_t                              sample(std::vector<ProcSample> &p_samples);
+
+    size_t                              size(void) const;
+
+    // scan the content of /proc/<pid>/stat without allocating, false if malformed
+    static bool                         parseStat(const char *p_buffer, size_t p_length, ProcStat *p_stat);
+
+    // scan the content of /proc/<pid>/schedstat, false if malformed
+    static bool                         parseSchedstat(const char *p_buffer, size_t p_length, ProcStat *p_stat);
+
+private:
+
+    struct Entry
+    {
+        int                             moduleId;
+        pid_t                           pid;
+        int                             statfd;
+        int                             schedstatfd; // -1 without CONFIG_SCHED_INFO
+        ProcStat                        last;
+        long long                       lastTime; // ns, CLOCK_MONOTONIC
+    };
+
+    std::vector<Entry>                  i_entries;
+    long                                i_ticksPerSecond;
+    long                                i_pageSizeKb;
+    unsigned int                        i_schedstatInterval;
+    unsigned int                        i_sampleCount;
+
+    static void                         closeEntry(Entry &p_entry);
+    static bool                         readStat(Entry &p_entry, ProcStat *p_stat, bool p_withSchedstat);
+
+}; // end class ProcSampler
+
+#endif
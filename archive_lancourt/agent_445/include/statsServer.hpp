@@ -0,0 +1,32 @@
+#ifndef _STATS_SERVER_HPP_
+#define _STATS_SERVER_HPP_
+
+#include "statsStore.hpp"
+#include "unixSocketServer.hpp"
+
+#include <string>
+
+# define STATS_REQUEST_TIMEOUT 100 // ms, to send the request and to read the answer
+# define STATS_REQUEST_SIZE 4096 // bytes, longest request
+
+// Local endpoint of the StatsStore : a Unix stream socket,
+// each client sends one json request (a line) and gets the json of StatsStore::query, then the socket is closed
+// (ex. echo '{"sourceType": 3, "sourceID": 1, "metric": "cpuUsage", "resolution": "1m"}' | socat - UNIX-CONNECT:/run/agent/stats.sock)
+class StatsServer : public UnixSocketServer
+{
+
+public:
+
+    StatsServer(const StatsStore &p_store, ILog &p_log);
+    ~StatsServer(void);
+
+private:
+
+    const StatsStore                    &i_store;
+
+    // the json of StatsStore::query for the request
+    std::string                         answer(const std::string &p_request) override;
+
+}; // end class StatsServer
+
+#endif
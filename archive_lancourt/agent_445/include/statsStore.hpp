@@ -0,0 +1,133 @@
+#ifndef _STATS_STORE_HPP_
+#define _STATS_STORE_HPP_
+
+#include "commonTools.hpp"
+#include "statusPages.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+# define STATS_SECOND_SLOTS 300 // 1 s points : 5 min
+# define STATS_MINUTE_SLOTS 120 // 1 min buckets : 2 h
+# define STATS_HOUR_SLOTS 48 // 1 h buckets : 2 days
+# define STATS_FIXED_METRICS 3 // cpuUsage, ramUsage, upTime
+# define STATS_PAYLOAD_METRICS (3 + STATUS_PAGE_COUNTERS) // threads, mainThreadTimeslices, status.heartbeatAge, status.counters.<i>
+# define STATS_METRIC_COUNT (STATS_FIXED_METRICS + STATS_PAYLOAD_METRICS)
+# define STATS_SOURCE_CAPACITY 32 // default "stats_sourceCapacity"
+
+enum eStatsResolution
+{
+    STATS_SECOND = 0,
+    STATS_MINUTE,
+    STATS_HOUR
+};
+
+// value of a metric during one second, time 0 : empty slot
+struct StatsPoint
+{
+    int64_t                             time; // s
+    double                              value;
+};
+
+// values of a metric during one minute or one hour, updated at each value
+struct StatsBucket
+{
+    int64_t                             time; // s, start of the bucket, 0 : empty slot
+    double                              min;
+    double                              max;
+    double                              sum;
+    double                              last;
+    u_int32_t                           count;
+};
+
+// History of one metric : a ring by resolution, a slot is overwritten by the next period falling on it
+struct StatsSeries
+{
+    StatsPoint                          seconds[STATS_SECOND_SLOTS];
+    StatsBucket                         minutes[STATS_MINUTE_SLOTS];
+    StatsBucket                         hours[STATS_HOUR_SLOTS];
+
+    // the last value of a second replaces the previous ones, the buckets of its minute and hour are rolled up
+    void                                record(int64_t p_time, double p_value);
+};
+
+// Series of every metric of one source, allocated in one block at its registration
+// a metric has a fixed index (StatsStore::metricName), a payload metric is listed once it got a value
+struct SourceSeries
+{
+    u_int64_t                           key; // sourceType << 32 | sourceID
+    int64_t                             lastTime; // s, last value recorded
+    bool                                hasValues[STATS_METRIC_COUNT];
+    StatsSeries                         series[STATS_METRIC_COUNT];
+};
+
+// In-agent time-series of the STATS events : by source and metric, 1 s / 1 min / 1 h resolutions
+// the memory of a source is allocated once (sourceBytes), at most sourceCapacity sources :
+// the store never grows past capacity * sourceBytes, only the sources registered by the controller are kept
+// written by the controller, read by the StatsServer
+class StatsStore
+{
+
+public:
+
+    explicit StatsStore(size_t p_sourceCapacity = STATS_SOURCE_CAPACITY);
+
+    StatsStore(const StatsStore &p_source) = delete;
+    StatsStore &operator=(const StatsStore &p_source) = delete;
+
+    // change the capacity, before the first source
+    bool                                init(size_t p_sourceCapacity);
+
+    // a launched module : its series are allocated now and kept until unregisterSource
+    bool                                registerSource(e_sourceType p_sourceType, u_int32_t p_sourceID);
+
+    void                                unregisterSource(e_sourceType p_sourceType, u_int32_t p_sourceID);
+
+    // a STATS event in the series of a registered source : cpuUsage, ramUsage, upTime and the payload metrics
+    // (an identifier of the payload is not a metric), false if the source is not registered
+    bool                                record(e_sourceType p_sourceType, u_int32_t p_sourceID, const Event &p_event);
+
+    // values of a metric since p_since (s) : [time, value] at STATS_SECOND,
+    // [time, min, max, avg, last, count] otherwise, false if the source or the metric is unknown
+    bool                                query(e_sourceType p_sourceType, u_int32_t p_sourceID, const std::string &p_metric,
+                                              eStatsResolution p_resolution, int64_t p_since, nlohmann::json &p_values) const;
+
+    // request of the StatsServer : {"sourceType", "sourceID", "metric", "resolution": "1s" | "1m" | "1h", "since"},
+    // the list of the sources without "metric"
+    nlohmann::json                      query(const nlohmann::json &p_request) const;
+
+    // sources with their metrics and their last time
+    nlohmann::json                      sources(void) const;
+
+    size_t                              size(void) const;
+    size_t                              capacity(void) const;
+
+    // memory of one source
+    static size_t                       sourceBytes(void);
+
+private:
+
+    mutable std::mutex                  i_mutex;
+    size_t                              i_capacity;
+    std::map<u_int64_t, std::unique_ptr<SourceSeries>>  i_sources;
+    std::vector<std::unique_ptr<SourceSeries>>          i_freeSources; // unregistered, reused before allocating
+
+    // series of a source, allocated if there is room, nullptr otherwise
+    SourceSeries                        *acquire(u_int64_t p_key);
+
+    // name of the metric at p_index : the fixed ones, then the payload ones
+    static const std::string            &metricName(size_t p_index);
+
+    // index of a metric of the source, -1 if unknown or without value
+    static int                          metricIndex(const SourceSeries &p_source, const std::string &p_name);
+
+    static void                         recordMetric(SourceSeries &p_source, size_t p_index, int64_t p_time, double p_value);
+
+    static u_int64_t                    keyOf(e_sourceType p_sourceType, u_int32_t p_sourceID);
+
+}; // end class StatsStore
+
+#endif
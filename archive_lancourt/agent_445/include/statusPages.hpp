@@ -0,0 +1,92 @@
+#ifndef _STATUS_PAGES_HPP_
+#define _STATUS_PAGES_HPP_
+
+#include <sys/types.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+
+# define STATUS_PAGE_MAGIC 0x54534741 // "AGST"
+# define STATUS_PAGE_VERSION 1
+# define STATUS_PAGE_SIZE 4096
+# define STATUS_PAGE_COUNTERS 16
+# define STATUS_PAGE_ENV "AGENT_STATUS_PAGE" // name of the page (shm_open) in the environment of the module
+# define STATUS_PAGE_READ_ATTEMPTS 4 // reads of a page the module keeps writing, then it is read at the next tick
+# define STATUS_HEARTBEAT_TIMEOUT 3000 // ms, a running module not updating its page is reported
+
+// state written by the module in its page
+enum eModuleState
+{
+    MODULE_STARTING = 0, // set by the agent before the launch
+    MODULE_RUNNING,
+    MODULE_DEGRADED,
+    MODULE_STOPPING
+};
+
+// Status page shared by a module (the writer) and the agent (the reader), one per launched module
+// the same layout is declared by the modules (t_status_page, apishm.hpp) : change both with the version
+// the fields after sequence are protected by it (seqlock) : odd while the module writes them
+struct StatusPage
+{
+    u_int32_t                           magic;
+    u_int32_t                           version;
+    int32_t                             moduleId;
+    int32_t                             pid; // written by the module when it maps the page
+    u_int32_t                           sequence;
+    u_int32_t                           state; // eModuleState
+    u_int64_t                           heartbeat; // ns, CLOCK_MONOTONIC of the last write of the module
+    u_int32_t                           counterCount;
+    u_int32_t                           reserved;
+    u_int64_t                           counters[STATUS_PAGE_COUNTERS] __attribute__((aligned(64)));
+};
+
+// consistent copy of a status page
+struct ModuleStatus
+{
+    int                                 moduleId;
+    pid_t                               pid;
+    int                                 state;
+    long long                           heartbeatAge; // ms since the last write of the module, -1 if it never wrote
+    u_int32_t                           counterCount;
+    u_int64_t                           counters[STATUS_PAGE_COUNTERS];
+};
+
+// Status pages of the modules : created by the launcher before each launch,
+// read by the observer at each sample without any system call
+class StatusPages
+{
+
+public:
+
+    StatusPages(void);
+    ~StatusPages(void);
+
+    StatusPages(const StatusPages &p_source) = delete;
+    StatusPages &operator=(const StatusPages &p_source) = delete;
+
+    // create (or reset for a restart) the page of a module, p_name gets its name for STATUS_PAGE_ENV
+    bool                                create(int p_moduleId, std::string &p_name);
+
+    // unmap and unlink the page of a module (a module still running keeps its mapping)
+    void                                remove(int p_moduleId);
+
+    // copy the page of a module, false if it has no page or the module kept writing it
+    bool                                read(int p_moduleId, ModuleStatus &p_status);
+
+    size_t                              size(void);
+
+    // shm_open name of the page of a module, unique by agent
+    static std::string                  pageName(int p_moduleId);
+
+    // seqlock read of a page
+    static bool                         readPage(const StatusPage *p_page, ModuleStatus &p_status);
+
+private:
+
+    std::mutex                          i_mutex;
+    std::map<int, StatusPage *>         i_pages;
+
+}; // end class StatusPages
+
+#endif
@@ -2,21 +2,30 @@
 #include "iLog.hpp"
 
 #include "commonTools.hpp"
+#include "eventQueue.hpp"
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+
+#include <vector>
+
+#include <google/protobuf/arena.h>
 
 #ifndef _STATUS_RECEIVER_HPP_
 #define _STATUS_RECEIVER_HPP_
 
 # define BUFFER_LEN 2000
+# define RECEIVE_BATCH 64 // datagrams read by one recvmmsg
+# define ARENA_BLOCK_SIZE (RECEIVE_BATCH * 4096) // first block of the parsing arena, reused by every batch
 
 class StatusReceiver : public IStatusReceiver
 {
  
 public: // -------------------------------------------------------------------------------- [ PUBLIC ]
 
-    StatusReceiver(std::priority_queue<Event, std::vector<Event>, compareEventPriority> *p_eventList, ILog &p_log); 
+    StatusReceiver(EventQueue *p_eventList, ILog &p_log); 
 
     ~StatusReceiver(void);
  
@@ -44,23 +53,43 @@ private: // --------------------------------------------------------------------
     ILog                            &i_log;
     std::thread                     i_protobufThread;                     
     std::thread                     i_eventThread;
-    std::mutex                      i_eventMutex;
     bool                            i_isRunning;
 
     int                             i_udpSocketfd;
     sockaddr_in                     i_serverSocketAddress;
     bool                            i_isUdpSocketClosed;
 
+    // eventfd written by stop to wake up the receiving thread waiting in epoll_wait
+    int                             i_stopEventfd;
+
+    // preallocated reception buffers of recvmmsg, one per datagram of a batch
+    std::vector<char>               i_receiveBuffers;
+    std::vector<iovec>              i_receiveIovecs;
+    std::vector<mmsghdr>            i_receiveMessages;
+
+    // the notifications of a batch are parsed in the arena, reset after the batch
+    std::vector<char>               i_arenaBlock;
+    google::protobuf::Arena         *i_arena;
+
+    // syslog level of the configuration ("logLevel"), the notifications are dumped from LOG_DEBUG
+    int                             i_logLevel;
+
     enum class                      eAddEvent{ SUCCESS, FAILURE };
 
     // set and push an event in the i_eventList with the received informations
-    eAddEvent                       addEvent(Notifications p_notifications);
+    eAddEvent                       addEvent(const Notifications &p_notifications);
 
     //  Set and push an event in the i_eventList with the received informations
     void                            receiveProtobuf(void);
 
+    // read the socket with recvmmsg until it is empty, return the number of datagrams read
+    int                             receiveBatch(void);
+
+    // parse a datagram and add its event
+    void                            processDatagram(const char *p_datagram, size_t p_length);
+
     // i_eventList
-    std::priority_queue<Event, std::vector<Event>, compareEventPriority> *i_eventList;
+    EventQueue                      *i_eventList;
 
 #endif
 };
@@ -5,11 +5,17 @@
 #include "iStopper.hpp"
 #include "iLog.hpp"
 
+#include <chrono>
+#include <vector>
+
+# define STOP_DEADLINE          3000    // ms, a module still running after its SIGTERM gets a SIGKILL
+# define STOP_KILL_DEADLINE     1000    // ms, waited after the SIGKILL
+
 class Stopper : public IStopper
 {
  
 public:
-    Stopper(ILog &p_log);
+    Stopper(ILog &p_log, int p_deadline = STOP_DEADLINE);
     ~Stopper(void);
 
     Stopper &operator=(const Stopper& p_source) = delete;
@@ -18,15 +24,40 @@ public:
     // useless for the moment -> TODO : delete it
     IStopper::eInit              init(void);
 
-    // Kill a pid with the SIGTERM (15) signal 
-    IStopper::eStopModule        stopModule(std::list<pid_t> p_modulePidList);
+    // send SIGTERM to every module at once, wait for their end on their pidfds
+    // and SIGKILL the modules still running after the deadline
+    // return once every module ended : bounded by the slowest one
+    // the pidfds given are closed, the modules given without pidfd are reaped here
+    IStopper::eStopModule        stopModule(std::list<ModuleProcess> p_moduleProcessList);
 
 private:
 
+    // module being stopped
+    struct StopTarget
+    {
+        pid_t                                   pid;
+        int                                     pidfd; // -1 : pidfd_open failed, signaled with kill
+        bool                                    isReaped; // here : nobody else waits for the module
+        bool                                    isEnded;
+        bool                                    isKilled;
+        std::chrono::steady_clock::time_point   endTime;
+    };
+
     ILog                                &i_log;
     bool                                i_isStopRunning; // a little dumb and useless
+    std::chrono::milliseconds           i_deadline;
+
+    // send a signal through the pidfd (no pid reuse), kill without pidfd
+    static int                          sendSignal(const StopTarget &p_target, int p_sigNum);
+
+    // a target without pidfd ended : reaped if it is ours, or gone
+    static bool                         isPidlessEnded(const StopTarget &p_target);
+
+    // wait on the pidfds of the targets still running until they end or p_deadline
+    void                                waitTargets(std::vector<StopTarget> &p_targets,
+                                                    std::chrono::steady_clock::time_point p_deadline);
  
 }; // end class Stopper
 
 
-#endif
\ No newline at end of file
+#endif
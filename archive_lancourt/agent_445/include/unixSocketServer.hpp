@@ -0,0 +1,64 @@
+#ifndef _UNIX_SOCKET_SERVER_HPP_
+#define _UNIX_SOCKET_SERVER_HPP_
+
+#include "iLog.hpp"
+
+#include <string>
+#include <thread>
+
+// Local request / answer endpoint on a Unix stream socket, the clients are answered one by one by one thread :
+// a client sends one request (a line, when the server reads requests), gets the answer, then the socket is closed
+// the answer is built by the derived class when the client connects, nothing is done between two clients
+// used by the MetricsServer and the StatsServer of the agent, and the SnapshotServer of the collector
+class UnixSocketServer
+{
+
+public:
+
+    // p_name prefixes the logs, p_requestSize is the longest request (0 : no request is read),
+    // p_timeout (ms) to read the request and to send the answer, a client not reading its socket is dropped
+    UnixSocketServer(ILog &p_log, const std::string &p_name, size_t p_requestSize, int p_timeout);
+
+    // the derived class calls stop in its own destructor : answer must not run on a destroyed object
+    virtual ~UnixSocketServer(void);
+
+    UnixSocketServer(const UnixSocketServer &p_source) = delete;
+    UnixSocketServer &operator=(const UnixSocketServer &p_source) = delete;
+
+    // bind and listen on p_socketPath (a socket file left by a previous process is removed)
+    bool                                init(const std::string &p_socketPath);
+
+    // launch the thread answering the clients
+    bool                                start(void);
+
+    // stop the thread and remove the socket file
+    void                                stop(void);
+
+protected:
+
+    ILog                                &i_log;
+
+    // answer to a request, without its end of line (empty when no request is read or the client sent nothing)
+    virtual std::string                 answer(const std::string &p_request) = 0;
+
+private:
+
+    const std::string                   i_name;
+    const size_t                        i_requestSize;
+    const int                           i_timeout;
+
+    std::string                         i_socketPath;
+    int                                 i_listenfd;
+    int                                 i_stopEventfd;
+    bool                                i_isRunning;
+    std::thread                         i_serverThread;
+
+    // wait for the clients and answer them one by one
+    void                                serve(void);
+
+    // read the request of a client, write the answer, then close it
+    void                                reply(int p_clientfd);
+
+}; // end class UnixSocketServer
+
+#endif
@@ -97,20 +97,37 @@ IAgent::eInitSignalHandler           Agent::initSignalHandler()
 
 /**
  * @brief
- * start the controller and sleep each 5 ms
+ * start the controller and sleep until a stop signal
+ * the stop signals are blocked before the controller creates its threads (they inherit the mask),
+ * so they are only delivered to this thread, in sigsuspend
  *
  * @return Agent::eStartAgent 
  */
 IAgent::eStart                      Agent::start(void)
 {
     i_log.LOG(LOG_DEBUG, "Agent::%s", __func__);    
+
+    sigset_t    l_stopSignals;
+    sigset_t    l_previousMask;
+
+    sigemptyset(&l_stopSignals);
+    sigaddset(&l_stopSignals, SIGINT);
+    sigaddset(&l_stopSignals, SIGTERM);
+    sigaddset(&l_stopSignals, SIGQUIT);
+    pthread_sigmask(SIG_BLOCK, &l_stopSignals, &l_previousMask);
+
     if (i_controller.start() == IController::eStart::FAILURE) // NETCONF RUN
+    {
+        pthread_sigmask(SIG_SETMASK, &l_previousMask, nullptr);
         return IAgent::eStart::FAILURE;
+    }
 
     while (i_isAgentRunning)
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        sigsuspend(&l_previousMask); // returns after stopHandlerMethod
     }
+
+    pthread_sigmask(SIG_SETMASK, &l_previousMask, nullptr);
     return IAgent::eStart::SUCCESS;
 }
 
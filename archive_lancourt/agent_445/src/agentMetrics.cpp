@@ -0,0 +1,206 @@
+#include "agentMetrics.hpp"
+
+/**
+ * @brief
+ * Construct an empty histogram
+ *
+ */
+Histogram::Histogram(void) : i_count(0),
+                             i_sum(0),
+                             i_max(0)
+{
+    for (std::atomic<u_int64_t> &l_bucket : i_buckets)
+        l_bucket.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief
+ * Count a value in its bucket, relaxed atomics : the readers only need an approximate snapshot
+ *
+ * @param p_value
+ */
+void                                Histogram::record(u_int64_t p_value)
+{
+    i_buckets[bucketOf(p_value)].fetch_add(1, std::memory_order_relaxed);
+    i_count.fetch_add(1, std::memory_order_relaxed);
+    i_sum.fetch_add(p_value, std::memory_order_relaxed);
+
+    u_int64_t l_max = i_max.load(std::memory_order_relaxed);
+
+    while (p_value > l_max && !i_max.compare_exchange_weak(l_max, p_value, std::memory_order_relaxed))
+        ;
+}
+
+u_int64_t                           Histogram::count(void) const
+{
+    return i_count.load(std::memory_order_relaxed);
+}
+
+u_int64_t                           Histogram::max(void) const
+{
+    return i_max.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief
+ * Upper bound of the bucket holding the p_percentile value (the max for the last bucket)
+ *
+ * @param p_percentile 0 - 100
+ * @return u_int64_t 0 if nothing was recorded
+ */
+u_int64_t                           Histogram::percentile(double p_percentile) const
+{
+    u_int64_t   l_count = count();
+    u_int64_t   l_rank = (u_int64_t)(p_percentile * (double)l_count / 100.0 + 0.5);
+    u_int64_t   l_seen = 0;
+
+    if (l_count == 0)
+        return 0;
+    if (l_rank == 0)
+        l_rank = 1;
+
+    for (size_t l_bucket = 0; l_bucket < HISTOGRAM_BUCKET_COUNT; l_bucket++)
+    {
+        l_seen += i_buckets[l_bucket].load(std::memory_order_relaxed);
+        if (l_seen >= l_rank)
+            return std::min(bucketUpperBound(l_bucket), max());
+    }
+    return max();
+}
+
+nlohmann::json                      Histogram::toJson(void) const
+{
+    nlohmann::json  l_json;
+    nlohmann::json  l_buckets = nlohmann::json::array();
+    u_int64_t       l_count = count();
+
+    for (size_t l_bucket = 0; l_bucket < HISTOGRAM_BUCKET_COUNT; l_bucket++)
+    {
+        u_int64_t l_bucketCount = i_buckets[l_bucket].load(std::memory_order_relaxed);
+
+        if (l_bucketCount != 0)
+            l_buckets.push_back({bucketUpperBound(l_bucket), l_bucketCount});
+    }
+
+    l_json["count"] = l_count;
+    l_json["sum"] = i_sum.load(std::memory_order_relaxed);
+    l_json["max"] = max();
+    l_json["mean"] = l_count ? (double)i_sum.load(std::memory_order_relaxed) / (double)l_count : 0.0;
+    l_json["p50"] = percentile(50);
+    l_json["p90"] = percentile(90);
+    l_json["p99"] = percentile(99);
+    l_json["buckets"] = l_buckets;
+
+    return l_json;
+}
+
+/**
+ * @brief
+ * 0 -> 0, 1 -> 1, 2 and 3 -> 2, 4 to 7 -> 3 ...
+ *
+ * @param p_value
+ * @return size_t
+ */
+size_t                              Histogram::bucketOf(u_int64_t p_value)
+{
+    if (p_value == 0)
+        return 0;
+
+    size_t l_bucket = (size_t)(64 - __builtin_clzll(p_value));
+
+    return std::min(l_bucket, (size_t)HISTOGRAM_BUCKET_COUNT - 1);
+}
+
+/**
+ * @brief
+ * Highest value counted in a bucket
+ *
+ * @param p_bucket
+ * @return u_int64_t
+ */
+u_int64_t                           Histogram::bucketUpperBound(size_t p_bucket)
+{
+    if (p_bucket == 0)
+        return 0;
+    if (p_bucket >= HISTOGRAM_BUCKET_COUNT - 1)
+        return UINT64_MAX;
+    return (1ULL << p_bucket) - 1;
+}
+
+/**
+ * @brief
+ * Construct a new Agent Metrics:: Agent Metrics object
+ *
+ * @param p_eventList
+ */
+AgentMetrics::AgentMetrics(const EventQueue *p_eventList) : i_eventList(p_eventList)
+{
+}
+
+/**
+ * @brief
+ * Latencies of an event just popped by the controller
+ * the source latency is only known for the notifications (sendingDate set by the module)
+ *
+ * @param p_event
+ * @param p_queueDepth
+ */
+void                                AgentMetrics::recordDispatch(const Event &p_event, size_t p_queueDepth)
+{
+    if (p_event.sendingDate != 0 && (u_int64_t)p_event.eventReceptionTime >= p_event.sendingDate)
+        i_sourceLatency.record((u_int64_t)p_event.eventReceptionTime - p_event.sendingDate);
+
+    auto l_waiting = std::chrono::steady_clock::now() - p_event.queuedTime;
+
+    i_dispatchLatency.record((u_int64_t)std::chrono::duration_cast<std::chrono::microseconds>(l_waiting).count());
+    i_queueDepth.record(p_queueDepth);
+}
+
+void                                AgentMetrics::recordProcessing(e_eventType p_eventType, u_int64_t p_duration)
+{
+    size_t l_type = std::min((size_t)p_eventType, (size_t)EVENT_TYPE_COUNT - 1);
+
+    i_processingTime[l_type].record(p_duration);
+}
+
+/**
+ * @brief
+ * Every histogram, and the counters of the queue (drops by lane)
+ *
+ * @return nlohmann::json
+ */
+nlohmann::json                      AgentMetrics::toJson(void) const
+{
+    static const char   *l_typeNames[EVENT_TYPE_COUNT] = { "config", "alert", "stats", "undefined" };
+    static const char   *l_priorityNames[EVENT_PRIORITY_COUNT] = { "fatal", "error", "warning", "default" };
+    nlohmann::json      l_json;
+
+    l_json["sourceLatency_s"] = i_sourceLatency.toJson();
+    l_json["dispatchLatency_us"] = i_dispatchLatency.toJson();
+    l_json["queueDepth"] = i_queueDepth.toJson();
+    for (size_t l_type = 0; l_type < EVENT_TYPE_COUNT; l_type++)
+        l_json["processingTime_us"][l_typeNames[l_type]] = i_processingTime[l_type].toJson();
+
+    if (i_eventList == nullptr)
+        return l_json;
+
+    EventQueueCounters  l_counters = i_eventList->counters();
+    nlohmann::json      &l_queue = l_json["eventQueue"];
+
+    l_queue["pushed"] = l_counters.pushed;
+    l_queue["popped"] = l_counters.popped;
+    l_queue["coalesced"] = l_counters.coalesced;
+    l_queue["aged"] = l_counters.aged;
+
+    // lanes by EventQueue::laneOf : type major, FATAL first
+    for (size_t l_lane = 0; l_lane < EVENT_LANE_COUNT; l_lane++)
+    {
+        std::string l_name = std::string(l_typeNames[l_lane / EVENT_PRIORITY_COUNT]) + "." +
+                             l_priorityNames[l_lane % EVENT_PRIORITY_COUNT];
+
+        l_queue["shed"][l_name] = l_counters.shed[l_lane];
+        l_queue["depth"][l_name] = l_counters.depth[l_lane];
+    }
+
+    return l_json;
+}
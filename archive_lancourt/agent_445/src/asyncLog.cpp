@@ -0,0 +1,567 @@
+#include "asyncLog.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include <pthread.h>
+#include <signal.h>
+
+// one argument of a record : the integers are widened to 64 bits, the strings are copied with their '\0'
+enum class eArgument { NONE, SIGNED, UNSIGNED, DOUBLE, POINTER, STRING, UNSUPPORTED };
+
+// conversion specification of a format : %[flags][width][.precision][length]conversion
+struct Conversion
+{
+    const char  *end; // first character after the conversion
+    int         starCount; // width and precision given as arguments ('*')
+    eArgument   argument;
+    char        length[3]; // length modifier
+    char        conversion;
+};
+
+static std::atomic<u_int64_t>   g_nextAsyncLogId(1);
+
+/**
+ * @brief
+ * Parse the conversion specification starting after a '%'
+ *
+ * @param p_format character after the '%'
+ * @return Conversion
+ */
+static Conversion                   parseConversion(const char *p_format)
+{
+    Conversion  l_conversion;
+    const char  *l_cursor = p_format;
+    size_t      l_length = 0;
+
+    l_conversion.starCount = 0;
+    std::memset(l_conversion.length, 0, sizeof(l_conversion.length));
+
+    while (*l_cursor && std::strchr("-+ #0'", *l_cursor))
+        l_cursor++;
+    if (*l_cursor == '*')
+        l_conversion.starCount++, l_cursor++;
+    while (*l_cursor >= '0' && *l_cursor <= '9')
+        l_cursor++;
+    if (*l_cursor == '.')
+    {
+        l_cursor++;
+        if (*l_cursor == '*')
+            l_conversion.starCount++, l_cursor++;
+        while (*l_cursor >= '0' && *l_cursor <= '9')
+            l_cursor++;
+    }
+    while (*l_cursor && std::strchr("hljztLq", *l_cursor) && l_length < 2)
+        l_conversion.length[l_length++] = *l_cursor++;
+
+    l_conversion.conversion = *l_cursor;
+    l_conversion.end = *l_cursor ? l_cursor + 1 : l_cursor;
+
+    switch (l_conversion.conversion)
+    {
+        case 'd': case 'i':
+            l_conversion.argument = eArgument::SIGNED; break;
+        case 'u': case 'o': case 'x': case 'X':
+            l_conversion.argument = eArgument::UNSIGNED; break;
+        case 'c':
+            l_conversion.argument = l_length ? eArgument::UNSUPPORTED : eArgument::SIGNED; break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            l_conversion.argument = l_conversion.length[0] == 'L' ? eArgument::UNSUPPORTED : eArgument::DOUBLE; break;
+        case 's':
+            l_conversion.argument = l_length ? eArgument::UNSUPPORTED : eArgument::STRING; break;
+        case 'p':
+            l_conversion.argument = eArgument::POINTER; break;
+        case '%':
+            l_conversion.argument = eArgument::NONE; break;
+        default:
+            // %n, %m (errno of the caller), wide characters ...
+            l_conversion.argument = eArgument::UNSUPPORTED; break;
+    }
+    return l_conversion;
+}
+
+static bool                         pushValue(LogRecord &p_record, const void *p_value, size_t p_size)
+{
+    if (p_record.length + p_size > sizeof(p_record.arguments))
+        return false;
+    std::memcpy(p_record.arguments + p_record.length, p_value, p_size);
+    p_record.length += (u_int16_t)p_size;
+    return true;
+}
+
+static int64_t                      readSigned(const Conversion &p_conversion, va_list &p_arguments)
+{
+    switch (p_conversion.length[0])
+    {
+        case 'h':
+            if (p_conversion.length[1] == 'h')
+                return (signed char)va_arg(p_arguments, int);
+            return (short)va_arg(p_arguments, int);
+        case 'l':
+            if (p_conversion.length[1] == 'l')
+                return va_arg(p_arguments, long long);
+            return va_arg(p_arguments, long);
+        case 'q':
+            return va_arg(p_arguments, long long);
+        case 'j':
+            return va_arg(p_arguments, intmax_t);
+        case 'z':
+            return va_arg(p_arguments, ssize_t);
+        case 't':
+            return va_arg(p_arguments, ptrdiff_t);
+        default:
+            return va_arg(p_arguments, int);
+    }
+}
+
+static u_int64_t                    readUnsigned(const Conversion &p_conversion, va_list &p_arguments)
+{
+    switch (p_conversion.length[0])
+    {
+        case 'h':
+            if (p_conversion.length[1] == 'h')
+                return (unsigned char)va_arg(p_arguments, unsigned int);
+            return (unsigned short)va_arg(p_arguments, unsigned int);
+        case 'l':
+            if (p_conversion.length[1] == 'l')
+                return va_arg(p_arguments, unsigned long long);
+            return va_arg(p_arguments, unsigned long);
+        case 'q':
+            return va_arg(p_arguments, unsigned long long);
+        case 'j':
+            return va_arg(p_arguments, uintmax_t);
+        case 'z':
+            return va_arg(p_arguments, size_t);
+        case 't':
+            return (u_int64_t)va_arg(p_arguments, ptrdiff_t);
+        default:
+            return va_arg(p_arguments, unsigned int);
+    }
+}
+
+/**
+ * @brief
+ * Construct a new Async Log:: Async Log object
+ *
+ * @param p_sink written by the writing thread only, except before start and after stop
+ */
+AsyncLog::AsyncLog(ILog &p_sink) : i_sink(p_sink),
+                                   i_id(g_nextAsyncLogId++),
+                                   i_isRunning(false),
+                                   i_isWriting(false),
+                                   i_sequence(0),
+                                   i_droppedCount(0)
+{
+}
+
+AsyncLog::~AsyncLog(void)
+{
+    stop();
+}
+
+bool                                AsyncLog::start(void)
+{
+    if (i_isRunning)
+        return true;
+
+    i_isWriting = true;
+    i_isRunning = true;
+    i_writerThread = std::thread(&AsyncLog::write, this);
+
+    return i_writerThread.joinable();
+}
+
+/**
+ * @brief
+ * Wake up the writing thread, which writes the records left before ending
+ * the calls after i_isRunning is cleared are written by their thread, the pushes already started
+ * are waited for : the last drain of the writing thread comes after them
+ *
+ */
+void                                AsyncLog::stop(void)
+{
+    i_isRunning = false;
+    {
+        std::lock_guard<std::mutex> l_lock(i_ringsMutex);
+
+        for (std::unique_ptr<Ring> &l_ring : i_rings)
+            while (l_ring->isPushing.load(std::memory_order_acquire))
+                std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> l_lock(i_wakeMutex);
+        i_isWriting = false;
+    }
+    i_wakeCondition.notify_one();
+
+    if (i_writerThread.joinable())
+        i_writerThread.join();
+}
+
+/**
+ * @brief
+ * Copy the call in the ring of the thread : no formatting, no lock, no system call
+ * a call whose arguments do not fit in a record is formatted here, in a record of its own
+ *
+ * @param p_priority
+ * @param p_format string literal, read by the writing thread after the call
+ * @param ...
+ */
+void                                AsyncLog::log(int p_priority, const char *p_format, ...)
+{
+    va_list     l_arguments;
+
+    if (!i_isRunning)
+    {
+        va_start(l_arguments, p_format);
+        logNow(p_priority, p_format, l_arguments);
+        va_end(l_arguments);
+        return;
+    }
+
+    Ring        *l_ring = threadRing();
+
+    // checked again after the flag (both seq_cst) : either stop sees the push in progress, or the call sees the stop
+    l_ring->isPushing.store(true);
+    if (!i_isRunning.load())
+    {
+        l_ring->isPushing.store(false, std::memory_order_release);
+        va_start(l_arguments, p_format);
+        logNow(p_priority, p_format, l_arguments);
+        va_end(l_arguments);
+        return;
+    }
+
+    u_int64_t   l_head = l_ring->head.load(std::memory_order_relaxed);
+
+    if (l_head - l_ring->tail.load(std::memory_order_acquire) >= LOG_RING_SLOTS)
+    {
+        i_droppedCount.fetch_add(1, std::memory_order_relaxed);
+        l_ring->isPushing.store(false, std::memory_order_release);
+        return;
+    }
+
+    LogRecord   &l_record = l_ring->records[l_head % LOG_RING_SLOTS];
+    bool        l_isEncoded;
+
+    l_record.priority = p_priority;
+    l_record.sequence = i_sequence.fetch_add(1, std::memory_order_relaxed);
+
+    va_start(l_arguments, p_format);
+    l_isEncoded = encode(l_record, p_format, l_arguments);
+    va_end(l_arguments);
+
+    if (!l_isEncoded)
+    {
+        // the record holds the formatted line as the argument of a "%s"
+        va_start(l_arguments, p_format);
+        vsnprintf(l_record.arguments, sizeof(l_record.arguments), p_format, l_arguments);
+        va_end(l_arguments);
+        l_record.format = "%s";
+        l_record.length = (u_int16_t)(std::strlen(l_record.arguments) + 1);
+    }
+
+    l_ring->head.store(l_head + 1, std::memory_order_release);
+    l_ring->isPushing.store(false, std::memory_order_release);
+}
+
+void                                AsyncLog::logNow(int p_priority, const char *p_format, va_list p_arguments)
+{
+    char    l_line[LOG_LINE_SIZE];
+
+    vsnprintf(l_line, sizeof(l_line), p_format, p_arguments);
+    i_sink.log(p_priority, "%s", l_line);
+}
+
+u_int64_t                           AsyncLog::droppedCount(void) const
+{
+    return i_droppedCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief
+ * Copy the arguments of a call in a record, as described by its format
+ *
+ * @param p_record [out]
+ * @param p_format
+ * @param p_arguments
+ * @return bool false if an argument does not fit or is not supported (%m, %n, %ls, %Lf)
+ */
+bool                                AsyncLog::encode(LogRecord &p_record, const char *p_format, va_list p_arguments)
+{
+    va_list     l_arguments;
+    bool        l_isEncoded = true;
+
+    p_record.format = p_format;
+    p_record.length = 0;
+
+    va_copy(l_arguments, p_arguments);
+    for (const char *l_cursor = std::strchr(p_format, '%'); l_cursor && l_isEncoded; l_cursor = std::strchr(l_cursor, '%'))
+    {
+        Conversion  l_conversion = parseConversion(l_cursor + 1);
+
+        l_cursor = l_conversion.end;
+
+        for (int i = 0; i < l_conversion.starCount && l_isEncoded; i++)
+        {
+            int64_t l_star = va_arg(l_arguments, int);
+
+            l_isEncoded = pushValue(p_record, &l_star, sizeof(l_star));
+        }
+
+        switch (l_conversion.argument)
+        {
+            case eArgument::NONE:
+                break;
+            case eArgument::SIGNED:
+            {
+                int64_t     l_value = readSigned(l_conversion, l_arguments);
+
+                l_isEncoded = l_isEncoded && pushValue(p_record, &l_value, sizeof(l_value));
+                break;
+            }
+            case eArgument::UNSIGNED:
+            {
+                u_int64_t   l_value = readUnsigned(l_conversion, l_arguments);
+
+                l_isEncoded = l_isEncoded && pushValue(p_record, &l_value, sizeof(l_value));
+                break;
+            }
+            case eArgument::DOUBLE:
+            {
+                double      l_value = va_arg(l_arguments, double);
+
+                l_isEncoded = l_isEncoded && pushValue(p_record, &l_value, sizeof(l_value));
+                break;
+            }
+            case eArgument::POINTER:
+            {
+                u_int64_t   l_value = (u_int64_t)(uintptr_t)va_arg(l_arguments, void *);
+
+                l_isEncoded = l_isEncoded && pushValue(p_record, &l_value, sizeof(l_value));
+                break;
+            }
+            case eArgument::STRING:
+            {
+                const char  *l_value = va_arg(l_arguments, const char *);
+
+                if (l_value == nullptr)
+                    l_value = "(null)";
+                l_isEncoded = l_isEncoded && pushValue(p_record, l_value, std::strlen(l_value) + 1);
+                break;
+            }
+            default:
+                l_isEncoded = false;
+                break;
+        }
+    }
+    va_end(l_arguments);
+
+    return l_isEncoded;
+}
+
+/**
+ * @brief
+ * Format a record with its arguments : the literal parts are copied,
+ * each conversion is given to snprintf with its own argument (the integers with a "ll" length)
+ *
+ * @param p_record
+ * @param p_line [out] '\0' terminated, truncated to p_size
+ * @param p_size
+ */
+void                                AsyncLog::format(const LogRecord &p_record, char *p_line, size_t p_size)
+{
+    const char  *l_arguments = p_record.arguments;
+    const char  *l_cursor = p_record.format;
+    size_t      l_used = 0;
+
+    if (p_size == 0)
+        return;
+
+    while (*l_cursor && l_used + 1 < p_size)
+    {
+        if (*l_cursor != '%')
+        {
+            p_line[l_used++] = *l_cursor++;
+            continue;
+        }
+
+        Conversion  l_conversion = parseConversion(l_cursor + 1);
+        char        l_specification[32];
+        int64_t     l_stars[2] = { 0, 0 };
+        size_t      l_length = 0;
+        int         l_written = 0;
+
+        // the specification without its length modifier
+        for (const char *l_spec = l_cursor; l_spec < l_conversion.end && l_length + 4 < sizeof(l_specification); l_spec++)
+        {
+            if (l_spec != l_conversion.end - 1 && l_spec > l_cursor && std::strchr("hljztLq", *l_spec))
+                continue;
+            l_specification[l_length++] = *l_spec;
+        }
+        l_cursor = l_conversion.end;
+
+        for (int i = 0; i < l_conversion.starCount; i++)
+        {
+            std::memcpy(&l_stars[i], l_arguments, sizeof(int64_t));
+            l_arguments += sizeof(int64_t);
+        }
+
+        if (l_conversion.argument == eArgument::SIGNED || l_conversion.argument == eArgument::UNSIGNED)
+        {
+            // %d -> %lld, %c is kept
+            if (l_conversion.conversion != 'c')
+            {
+                l_specification[l_length - 1] = 'l';
+                l_specification[l_length++] = 'l';
+                l_specification[l_length++] = l_conversion.conversion;
+            }
+        }
+        l_specification[l_length] = '\0';
+
+        char        *l_out = p_line + l_used;
+        size_t      l_left = p_size - l_used;
+        long long   l_integer;
+        double      l_double;
+
+        switch (l_conversion.argument)
+        {
+            case eArgument::NONE:
+                l_written = snprintf(l_out, l_left, "%%");
+                break;
+            case eArgument::SIGNED:
+            case eArgument::UNSIGNED:
+            case eArgument::POINTER:
+                std::memcpy(&l_integer, l_arguments, sizeof(l_integer));
+                l_arguments += sizeof(l_integer);
+                if (l_conversion.argument == eArgument::POINTER)
+                    l_written = snprintf(l_out, l_left, l_specification, (void *)(uintptr_t)l_integer);
+                else if (l_conversion.conversion == 'c')
+                    l_written = snprintf(l_out, l_left, l_specification, (int)l_integer);
+                else if (l_conversion.starCount == 0)
+                    l_written = snprintf(l_out, l_left, l_specification, l_integer);
+                else if (l_conversion.starCount == 1)
+                    l_written = snprintf(l_out, l_left, l_specification, (int)l_stars[0], l_integer);
+                else
+                    l_written = snprintf(l_out, l_left, l_specification, (int)l_stars[0], (int)l_stars[1], l_integer);
+                break;
+            case eArgument::DOUBLE:
+                std::memcpy(&l_double, l_arguments, sizeof(l_double));
+                l_arguments += sizeof(l_double);
+                if (l_conversion.starCount == 0)
+                    l_written = snprintf(l_out, l_left, l_specification, l_double);
+                else if (l_conversion.starCount == 1)
+                    l_written = snprintf(l_out, l_left, l_specification, (int)l_stars[0], l_double);
+                else
+                    l_written = snprintf(l_out, l_left, l_specification, (int)l_stars[0], (int)l_stars[1], l_double);
+                break;
+            case eArgument::STRING:
+                if (l_conversion.starCount == 0)
+                    l_written = snprintf(l_out, l_left, l_specification, l_arguments);
+                else if (l_conversion.starCount == 1)
+                    l_written = snprintf(l_out, l_left, l_specification, (int)l_stars[0], l_arguments);
+                else
+                    l_written = snprintf(l_out, l_left, l_specification, (int)l_stars[0], (int)l_stars[1], l_arguments);
+                l_arguments += std::strlen(l_arguments) + 1;
+                break;
+            default:
+                // not encoded, the record was formatted by the caller
+                break;
+        }
+
+        if (l_written > 0)
+            l_used += std::min((size_t)l_written, l_left - 1);
+    }
+    p_line[l_used] = '\0';
+}
+
+/**
+ * @brief
+ * Ring of the calling thread : cached in a thread_local after the first call, by id of AsyncLog,
+ * so a thread logging to several AsyncLog has one ring in each (the ids are never reused,
+ * the entry of a destroyed AsyncLog is never found again)
+ *
+ * @return AsyncLog::Ring*
+ */
+AsyncLog::Ring                      *AsyncLog::threadRing(void)
+{
+    static thread_local std::vector<std::pair<u_int64_t, Ring *>>   t_rings;
+
+    for (const std::pair<u_int64_t, Ring *> &l_ring : t_rings)
+        if (l_ring.first == i_id)
+            return l_ring.second;
+
+    std::lock_guard<std::mutex> l_lock(i_ringsMutex);
+
+    i_rings.emplace_back(new Ring());
+    t_rings.emplace_back(i_id, i_rings.back().get());
+    return t_rings.back().second;
+}
+
+/**
+ * @brief
+ * Launched in a new thread
+ * the callers do not notify it (no system call in log) : it drains every LOG_DRAIN_PERIOD,
+ * a last time after stop
+ * the stop signals are blocked : started before the agent blocks them, it must not run the stop handler
+ *
+ */
+void                                AsyncLog::write(void)
+{
+    std::vector<LogRecord>  l_records;
+    sigset_t                l_stopSignals;
+
+    sigemptyset(&l_stopSignals);
+    sigaddset(&l_stopSignals, SIGINT);
+    sigaddset(&l_stopSignals, SIGTERM);
+    sigaddset(&l_stopSignals, SIGQUIT);
+    pthread_sigmask(SIG_BLOCK, &l_stopSignals, nullptr);
+
+    l_records.reserve(LOG_RING_SLOTS);
+
+    while (i_isWriting)
+    {
+        {
+            std::unique_lock<std::mutex> l_lock(i_wakeMutex);
+
+            i_wakeCondition.wait_for(l_lock, std::chrono::milliseconds(LOG_DRAIN_PERIOD), [this] { return !i_isWriting; });
+        }
+        drain(l_records);
+    }
+    drain(l_records);
+}
+
+void                                AsyncLog::drain(std::vector<LogRecord> &p_records)
+{
+    char    l_line[LOG_LINE_SIZE];
+
+    p_records.clear();
+    {
+        std::lock_guard<std::mutex> l_lock(i_ringsMutex);
+
+        for (std::unique_ptr<Ring> &l_ring : i_rings)
+        {
+            u_int64_t   l_tail = l_ring->tail.load(std::memory_order_relaxed);
+            u_int64_t   l_head = l_ring->head.load(std::memory_order_acquire);
+
+            for (; l_tail != l_head; l_tail++)
+                p_records.push_back(l_ring->records[l_tail % LOG_RING_SLOTS]);
+            l_ring->tail.store(l_tail, std::memory_order_release);
+        }
+    }
+
+    std::sort(p_records.begin(), p_records.end(), [](const LogRecord &p_left, const LogRecord &p_right) {
+        return p_left.sequence < p_right.sequence;
+    });
+
+    for (const LogRecord &l_record : p_records)
+    {
+        format(l_record, l_line, sizeof(l_line));
+        i_sink.log(l_record.priority, "%s", l_line);
+    }
+}
@@ -17,7 +17,7 @@ using json = nlohmann::json;
  * @param p_log 
  */
 ConfigReceiver::ConfigReceiver(INetconfServer &p_netconfServer,
-                               std::priority_queue<Event, std::vector<Event>, compareEventPriority> *p_eventList,
+                               EventQueue *p_eventList,
                                ILog & p_log) : i_netconfServer(p_netconfServer),
                                                i_eventList(p_eventList),
                                                i_log(p_log)
@@ -178,9 +178,7 @@ ConfigReceiver::eStop                       ConfigReceiver::stop(int p_sigNum)
 
     i_isRunning = false;
 
-    // move it to the agent
-    // set i_eventList with an empty priority_queue
-    // *i_eventList = std::priority_queue<Event, std::vector<Event>, compareEventPriority>();
+    // the events left are cleared by the owner of the queue (main)
 
     return (eStop::SUCCESS);
 }
@@ -216,11 +214,9 @@ ConfigReceiver::eAddEvent                   ConfigReceiver::addEvent(nlohmann::j
 
     l_newEvent.eventReceptionTime = std::time(nullptr);
 
-    l_newEvent.jsonData = p_json;
+    l_newEvent.jsonData = EventPayload(std::move(p_json));
 
-    // std::lock_guard<std::mutex> l_mutexGetEvent(i_eventMutex);
-    std::lock_guard<std::mutex> l_mutexGetEvent(i_eventMutex);
-    i_eventList->push(l_newEvent);
+    i_eventList->push(std::move(l_newEvent));
 
     return (eAddEvent::SUCCESS);
 }
@@ -1,5 +1,9 @@
 #include "controller.hpp"
 #include "commonTools.hpp"
+#include "asyncLog.hpp"
+
+#include <chrono>
+#include <set>
 
 /**
  * @brief : Construct a new Controller:: Controller object
@@ -9,7 +13,7 @@
  * @param p_observer 
  * @param p_log 
  */
-Controller::Controller(std::priority_queue<Event, std::vector<Event>, compareEventPriority> *p_eventList,
+Controller::Controller(EventQueue *p_eventList,
                        IConfigReceiver &p_configReceiver,
                        IStatusReceiver &p_statusReceiver,
                        ILauncher &p_launcher,
@@ -21,7 +25,11 @@ Controller::Controller(std::priority_queue<Event, std::vector<Event>, compareEve
                                       i_launcher(p_launcher),
                                       i_stopper(p_stopper),
                                       i_observer(p_observer),
-                                      i_log(p_log)
+                                      i_log(p_log),
+                                      i_metrics(p_eventList),
+                                      i_metricsServer(i_metrics, p_log),
+                                      i_statsServer(i_statsStore, p_log),
+                                      i_logLevel(LOG_INFO)
 {
     i_log.log(LOG_INFO, "Controller::%s", __func__);
 }
@@ -52,9 +60,26 @@ IController::eInit                  Controller::init(const nlohmann::json &p_jso
         i_statusReceiver.init(p_json) == IStatusReceiver::eInit::FAILURE ||
         i_launcher.init() == ILauncher::eInit::FAILURE ||
         i_stopper.init() == IStopper::eInit::FAILURE ||
-        i_observer.init() == IObserver::eInit::FAILURE)
+        i_observer.init(p_json) == IObserver::eInit::FAILURE)
         return IController::eInit::FAILURE;
 
+    // optional : syslog level (LOG_DEBUG == 7 prints every event dispatched)
+    if (p_json.count("logLevel"))
+        getJsonParameter(i_logLevel, p_json, "logLevel");
+
+    // optional : Unix socket giving the metrics of the agent, the agent runs without it
+    if (p_json.count("metrics_socketPath") &&
+        !i_metricsServer.init(p_json.at("metrics_socketPath").get<std::string>()))
+        i_log.log(LOG_ERR, "Controller::%s - metrics endpoint disabled", __func__);
+
+    // optional : sources kept in the history of the STATS events, and its Unix socket
+    if (p_json.count("stats_sourceCapacity") &&
+        !i_statsStore.init(p_json.at("stats_sourceCapacity").get<size_t>()))
+        i_log.log(LOG_ERR, "Controller::%s - invalid stats_sourceCapacity, %zu sources kept", __func__, i_statsStore.capacity());
+    if (p_json.count("stats_socketPath") &&
+        !i_statsServer.init(p_json.at("stats_socketPath").get<std::string>()))
+        i_log.log(LOG_ERR, "Controller::%s - stats endpoint disabled", __func__);
+
     std::string     capturePath;
     std::string     visionPath;
 
@@ -120,6 +145,9 @@ IController::eStart                 Controller::start(void)
     
     i_configReceiver.start();
     i_statusReceiver.start();
+    i_observer.start();
+    i_metricsServer.start();
+    i_statsServer.start();
 
     this->threadManager();
 
@@ -139,8 +167,18 @@ IController::eStopAll             Controller::stopAll(int p_signal)
 
     i_running = false;
 
-    if (!i_modulePidList.empty())
-        i_stopper.stopModule(i_modulePidList);
+    // wake up the eventHandler thread waiting for an event, and wait for the end of the event it processes :
+    // processEvent starts modules and writes i_runningModules
+    if (i_eventList != nullptr)
+        i_eventList->close();
+    if (i_eventThread.joinable())
+        i_eventThread.join();
+
+    std::list<int>  l_moduleIds;
+
+    for (const auto &l_runningModule : i_runningModules)
+        l_moduleIds.emplace_back(l_runningModule.first);
+    stopModules(l_moduleIds);
 
     if (i_configReceiver.stop(p_signal) == IConfigReceiver::eStop::FAILURE ||
         i_statusReceiver.stop(p_signal) == IStatusReceiver::eStop::FAILURE ||
@@ -148,8 +186,8 @@ IController::eStopAll             Controller::stopAll(int p_signal)
         i_observer.stop(p_signal) == IObserver::eStop::FAILURE)
         return IController::eStopAll::FAILURE;
 
-    if (i_eventThread.joinable())
-        i_eventThread.join();
+    i_metricsServer.stop();
+    i_statsServer.stop();
 
     return IController::eStopAll::SUCCESS;
 }
@@ -181,24 +219,30 @@ IController::eThreadManager         Controller::threadManager(void)
  * Launched in a new thread
  * loop for fetching a new event from the event list 
  * and give it to the controller method "eventProcessing"
+ * the thread sleeps in getEvent until an event is pushed or the list is closed by stopAll
+ * the latencies and the processing time of each event are recorded in i_metrics
  * 
  */
 void                                Controller::eventHandler(void) // eventHandler
 {
     i_log.log(LOG_DEBUG, "Controller::%s - i_running = %i", __func__, i_running);
 
+    Event l_newTopEvent;
+
     while (i_running == true)
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        if (getEvent(l_newTopEvent) == false)
+            break;
+
+        i_metrics.recordDispatch(l_newTopEvent, i_eventList->size());
 
-        // if (i_configReceiver.isEventListEmpty()) // tenter un poll ici
-        if (i_eventList->empty() == true) // tenter un poll ici
-            continue; // GO THREAD SLEEP
+        e_eventType                             l_eventType = l_newTopEvent.eventType;
+        std::chrono::steady_clock::time_point   l_start = std::chrono::steady_clock::now();
 
-		i_log.log(LOG_DEBUG, "i_eventList NOT EMPTY");
+        processEvent(std::move(l_newTopEvent));
 
-        Event l_newTopEvent = getEvent();
-        processEvent(l_newTopEvent);
+        i_metrics.recordProcessing(l_eventType, (u_int64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                                                    std::chrono::steady_clock::now() - l_start).count());
 
         //i_log.log(LOG_DEBUG, "l_newTopEvent.jsonData : [%s]", l_newTopEvent.jsonData);
     }
@@ -249,58 +293,214 @@ void                                Controller::printEventDebug(Event p_event)
 
 /**
  * @brief 
- * Get the top event (the highest priority), and pop it from the list
+ * Wait for the top event (the highest priority), and move it out of the list
  * 
- * memo lockgard --> se delock automatiquement apres la fonction
- * contrairement au unique lock
+ * @param p_event [out]
+ * @return true an event was popped
+ * @return false the list was closed (stopAll)
+ */
+bool                                Controller::getEvent(Event &p_event)
+{
+    if (i_eventList->pop(p_event) == false)
+        return false;
+
+    AGENT_LOG(i_log, LOG_DEBUG, "Controller::%s ", __func__);
+    return true;
+}
+
+/**
+ * @brief
+ * Compare the running modules with the modules of a new configuration
+ * a module is identified by its id, it is restarted when its name or its parameters changed
+ * an id given twice is put in duplicateIds : a second process of the same id could never be stopped
  * 
- * mutable == permet de lock/unlock le mutex dans une methode const
+ * @param p_runningModules 
+ * @param p_newModules 
+ * @return ModuleDiff 
+ */
+ModuleDiff                          Controller::diffModules(const std::map<int, RunningModule> &p_runningModules,
+                                                        const std::list<Module> &p_newModules)
+{
+    ModuleDiff          l_diff;
+    std::set<int>       l_newModuleIds;
+
+    for (const Module &l_module : p_newModules)
+    {
+        if (l_newModuleIds.insert(l_module.id).second == false)
+        {
+            l_diff.duplicateIds.emplace_back(l_module.id);
+            continue;
+        }
+
+        auto l_running = p_runningModules.find(l_module.id);
+
+        if (l_running == p_runningModules.end())
+            l_diff.toStart.emplace_back(l_module);
+        // the hash tells most changed parameters apart without comparing the strings
+        else if (l_running->second.module.name != l_module.name ||
+                 l_running->second.parametersHash != std::hash<std::string>()(l_module.parameters) ||
+                 l_running->second.module.parameters != l_module.parameters)
+            l_diff.toRestart.emplace_back(l_module);
+        else
+            l_diff.unchangedCount++;
+    }
+
+    for (const auto &l_running : p_runningModules)
+    {
+        if (l_newModuleIds.count(l_running.first) == 0)
+            l_diff.toStop.emplace_back(l_running.first);
+    }
+
+    return l_diff;
+}
+
+/**
+ * @brief
+ * Launch a module and keep it in i_runningModules
  * 
- * @return t_event 
+ * @param p_module 
  */
-Event                               Controller::getEvent(void)
+void                                Controller::startModule(const Module &p_module)
 {
-    i_log.log(LOG_DEBUG, "ConfigReceiver::%s ", __func__);
+    RunningModule   l_runningModule;
 
-    std::lock_guard<std::mutex> l_mutexGetEvent(i_eventMutex);
-    
-    Event topEvent = i_eventList->top();
-    i_eventList->pop();
+    if (i_launcher.launchModule(p_module, &l_runningModule.pid) == ILauncher::eLaunchModule::FAILURE)
+    {
+        i_log.log(LOG_ERR, "Controller::%s - unable to launch module [%d]", __func__, p_module.id);
+        return;
+    }
 
-    return (topEvent);
+    l_runningModule.module = p_module;
+    l_runningModule.parametersHash = std::hash<std::string>()(p_module.parameters);
+    i_runningModules[p_module.id] = l_runningModule;
+
+    // the series of the module are allocated now, the STATS of the observer are never refused
+    if (!i_statsStore.registerSource(AGENT, (u_int32_t)p_module.id))
+        i_log.log(LOG_ERR, "Controller::%s - no stats history for module [%d]", __func__, p_module.id);
+
+    // restarted by the observer if it crashes
+    if (i_observer.watchModule(p_module, l_runningModule.pid) == IObserver::eWatchModule::FAILURE)
+        i_log.log(LOG_ERR, "Controller::%s - module [%d] launched but not supervised", __func__, p_module.id);
 }
 
 /**
  * @brief
- * Get the module list and loop on each module to call 
- * the launchModule method of the launcher class 
+ * Stop the given running modules and forget them
+ * the observer stops supervising them first, so that their end is not taken for a crash
+ * 
+ * @param p_moduleIds 
+ */
+void                                Controller::stopModules(const std::list<int> &p_moduleIds)
+{
+    std::list<ModuleProcess>    l_moduleProcessList;
+
+    for (int l_moduleId : p_moduleIds)
+    {
+        auto l_running = i_runningModules.find(l_moduleId);
+
+        if (l_running == i_runningModules.end())
+            continue;
+
+        // the observer knows the pid of a module it restarted, -1 while the module waits for its restart,
+        // and hands over its pidfd : the stopper never signals the module by a pid reused meanwhile
+        ModuleProcess   l_moduleProcess;
+
+        l_moduleProcess.pid = l_running->second.pid;
+        i_observer.unwatchModule(l_moduleId, &l_moduleProcess);
+        if (l_moduleProcess.pid > 0)
+            l_moduleProcessList.emplace_back(l_moduleProcess);
+        else if (l_moduleProcess.pidfd >= 0)
+            close(l_moduleProcess.pidfd);
+        i_runningModules.erase(l_running);
+    }
+
+    if (!l_moduleProcessList.empty())
+        i_stopper.stopModule(l_moduleProcessList);
+}
+
+/**
+ * @brief
+ * Get the module list of a CONFIG event, and only stop, start or restart
+ * the modules which changed since the previous configuration
+ * an ALERT event of the observer gives the new pid of a restarted module
+ * a STATS event is kept in the history of its module (i_statsStore)
  * 
  * @param p_event (defined in include/commonTools.hpp) 
  */
 void                                Controller::processEvent(Event p_event)
 {
-    i_log.log(LOG_INFO, "Controller::%s - i_running = %i", __func__, i_running);
+    AGENT_LOG(i_log, LOG_DEBUG, "Controller::%s - i_running = %i", __func__, i_running);
     std::list<Module>   l_moduleList;
 
-    pid_t               l_modulePid;
-
-    printEventDebug(p_event);
+    if (i_logLevel >= LOG_DEBUG)
+        printEventDebug(p_event);
 
     if (p_event.eventType == CONFIG)
     {
-        if (!i_modulePidList.empty())
+        // an invalid configuration leaves the running modules untouched
+        try
         {
-            i_stopper.stopModule(i_modulePidList);
-            i_modulePidList.clear(); // CLEAR THE PID PROCESS
+            l_moduleList = getModulesListFromJson(p_event.jsonData.json());
+        }
+        catch (const std::exception &e)
+        {
+            i_log.log(LOG_ERR, "Controller::%s - invalid configuration : %s", __func__, e.what());
+            return;
         }
 
-        l_moduleList = getModulesListFromJson(p_event.jsonData);
+        std::chrono::steady_clock::time_point   l_start = std::chrono::steady_clock::now();
+        ModuleDiff                              l_diff = diffModules(i_runningModules, l_moduleList);
+        std::list<int>                          l_moduleIds = l_diff.toStop;
 
-        for (Module module : l_moduleList)
+        if (!l_diff.duplicateIds.empty())
         {
-            i_launcher.launchModule(module, &l_modulePid);
-            i_modulePidList.emplace_back(l_modulePid); // PUSH BACK THE PID PROCESS
+            i_log.log(LOG_ERR, "Controller::%s - invalid configuration : module id [%d] given more than once",
+                      __func__, l_diff.duplicateIds.front());
+            return;
         }
+
+        for (const Module &l_module : l_diff.toRestart)
+            l_moduleIds.emplace_back(l_module.id);
+        stopModules(l_moduleIds);
+
+        // a restarted module keeps its history
+        for (int l_moduleId : l_diff.toStop)
+            i_statsStore.unregisterSource(AGENT, (u_int32_t)l_moduleId);
+
+        for (const Module &l_module : l_diff.toRestart)
+            startModule(l_module);
+        for (const Module &l_module : l_diff.toStart)
+            startModule(l_module);
+
+        i_log.log(LOG_INFO, "Controller::%s - reconfiguration in %lld us : %zu stopped, %zu started, %zu restarted, %d unchanged",
+                  __func__,
+                  (long long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - l_start).count(),
+                  l_diff.toStop.size(), l_diff.toStart.size(), l_diff.toRestart.size(), l_diff.unchangedCount);
+    }
+    else if (p_event.eventType == ALERT && p_event.sourceType == AGENT)
+    {
+        try
+        {
+            if (p_event.jsonData.get("event").get<std::string>() != "moduleRestarted")
+                return;
+
+            auto l_running = i_runningModules.find(p_event.jsonData.get("moduleId").get<int>());
+
+            if (l_running != i_runningModules.end())
+                l_running->second.pid = p_event.jsonData.get("pid").get<pid_t>();
+        }
+        catch (const std::exception &e)
+        {
+            i_log.log(LOG_ERR, "Controller::%s - invalid observer event : %s", __func__, e.what());
+        }
+    }
+    else if (p_event.eventType == STATS)
+    {
+        // the STATS of the observer and the ones a module sends itself (its module id as sourceID)
+        // go to the series of the module, registered at its launch
+        if (!i_statsStore.record(AGENT, p_event.sourceID, p_event))
+            AGENT_LOG(i_log, LOG_DEBUG, "Controller::%s - no stats history for source [%d/%u], dropped",
+                      __func__, (int)p_event.sourceType, p_event.sourceID);
     }
 }
 
@@ -308,12 +508,13 @@ void                                Controller::processEvent(Event p_event)
  * @brief
  * Retrieve modules (see commonTools.hpp) from a json file push each one in a list
  * set the "module" fields by parsing the json file given to the program
+ * throws when "magellan-agent:agent"/"module" is missing : an unreadable list is not an empty list
  * 
  * @param p_json 
  * @return std::list<Module> 
  * 
  */
-std::list<Module>                   Controller::getModulesListFromJson(nlohmann::json  &p_json)
+std::list<Module>                   Controller::getModulesListFromJson(const nlohmann::json &p_json)
 {
     i_log.log(LOG_INFO, "Controller::%s - i_running = %i", __func__, i_running);
     std::list<Module>   l_moduleList;
@@ -328,7 +529,7 @@ std::list<Module>                   Controller::getModulesListFromJson(nlohmann:
     catch(const std::exception& e)
     {
         i_log.log(LOG_ERR, "Unable to retrieve the module count ! [%s]", e.what());
-        return l_moduleList;
+        throw;
     }
 
     std::string l_name;
@@ -346,6 +547,21 @@ std::list<Module>                   Controller::getModulesListFromJson(nlohmann:
 
         l_module.parameters = p_json.at("magellan-agent:agent").at("module").at(i).at("parameters").get<std::string>();
 
+        // optional placement of the module : "cpuset" (ex. "0-3") and "numaNode" (ex. 0)
+        try
+        {
+            nlohmann::json l_parameters = nlohmann::json::parse(l_module.parameters);
+
+            if (l_parameters.count("cpuset"))
+                getJsonParameter(l_module.cpuset, l_parameters, "cpuset");
+            if (l_parameters.count("numaNode"))
+                getJsonParameter(l_module.numaNode, l_parameters, "numaNode");
+        }
+        catch(const std::exception& e)
+        {
+            i_log.log(LOG_ERR, "Unable to retrieve the placement of module [%d] : %s", l_module.id, e.what());
+        }
+
         l_moduleList.emplace_back(l_module);
     }
 
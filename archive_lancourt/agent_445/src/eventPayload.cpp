@@ -0,0 +1,116 @@
+#include "eventPayload.hpp"
+
+/**
+ * @brief
+ * Construct an empty payload
+ *
+ */
+EventPayload::EventPayload(void) : i_state(std::make_shared<State>())
+{
+}
+
+/**
+ * @brief
+ * Keep the raw json text, nothing is parsed here
+ *
+ * @param p_raw
+ */
+EventPayload::EventPayload(std::string p_raw) : i_state(std::make_shared<State>())
+{
+    i_state->raw = std::move(p_raw);
+}
+
+/**
+ * @brief
+ * Payload already parsed
+ *
+ * @param p_json
+ */
+EventPayload::EventPayload(nlohmann::json p_json) : i_state(std::make_shared<State>())
+{
+    i_state->json = std::move(p_json);
+    i_state->parse = eParse::PARSED;
+}
+
+/**
+ * @brief
+ * Parse the whole payload on the first call (once for all the copies of the event)
+ * if the parsing throws, the payload is FAILED and the next calls throw the same error without parsing
+ *
+ * @return const nlohmann::json&
+ */
+const nlohmann::json                &EventPayload::json(void) const
+{
+    State   *l_state = i_state.get();
+
+    if (l_state->parse.load(std::memory_order_acquire) == eParse::PARSED)
+        return l_state->json;
+
+    std::lock_guard<std::mutex> l_lock(l_state->parseMutex);
+
+    if (l_state->parse == eParse::PENDING)
+    {
+        try
+        {
+            if (!l_state->raw.empty())
+                l_state->json = nlohmann::json::parse(l_state->raw);
+            l_state->parse.store(eParse::PARSED, std::memory_order_release);
+        }
+        catch (...)
+        {
+            l_state->parseError = std::current_exception();
+            l_state->parse = eParse::FAILED;
+        }
+    }
+    if (l_state->parse == eParse::FAILED)
+        std::rethrow_exception(l_state->parseError);
+
+    return l_state->json;
+}
+
+/**
+ * @brief
+ * Value of a top level key
+ * when the payload is not parsed yet, the other top level keys are skipped by the parser callback
+ * and nothing is cached : a reader of a single key does not pay for the whole tree
+ *
+ * @param p_key
+ * @return nlohmann::json
+ */
+nlohmann::json                      EventPayload::get(const std::string &p_key) const
+{
+    if (empty())
+        return nlohmann::json();
+    if (i_state->parse != eParse::PENDING)
+        return json().at(p_key);
+
+    // a key discarded at depth 1 drops its value too, nested objects and arrays included
+    nlohmann::json  l_partial = nlohmann::json::parse(i_state->raw,
+        [&p_key](int p_depth, nlohmann::json::parse_event_t p_event, nlohmann::json &p_parsed) {
+            return p_depth != 1 || p_event != nlohmann::json::parse_event_t::key || p_parsed == p_key;
+        });
+
+    return l_partial.at(p_key);
+}
+
+const std::string                   &EventPayload::raw(void) const
+{
+    return i_state->raw;
+}
+
+bool                                EventPayload::empty(void) const
+{
+    return i_state->raw.empty() && (i_state->parse != eParse::PARSED || i_state->json.is_null());
+}
+
+bool                                EventPayload::isParsed(void) const
+{
+    return i_state->parse == eParse::PARSED;
+}
+
+std::ostream                        &operator<<(std::ostream &p_stream, const EventPayload &p_payload)
+{
+    if (p_payload.raw().empty() && p_payload.isParsed())
+        return p_stream << p_payload.json();
+    return p_stream << p_payload.raw();
+}
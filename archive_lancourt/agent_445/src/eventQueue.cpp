@@ -0,0 +1,317 @@
+#include "eventQueue.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @brief
+ * Construct a new Event Queue:: Event Queue object
+ *
+ * @param p_capacity events waiting in the queue before shedding
+ * @param p_agingDelay ms an event waits before going ahead of the higher lanes
+ */
+EventQueue::EventQueue(size_t p_capacity, int p_agingDelay) : i_size(0),
+                                                              i_capacity(std::max<size_t>(p_capacity, 1)),
+                                                              i_agingDelay(p_agingDelay),
+                                                              i_isClosed(false)
+{
+    std::memset(&i_counters, 0, sizeof(i_counters));
+}
+
+/**
+ * @brief
+ * Destroy the Event Queue:: Event Queue object
+ *
+ */
+EventQueue::~EventQueue(void)
+{
+    close();
+}
+
+/**
+ * @brief
+ * Push an event in its lane and wake up the consumer waiting in pop
+ * the consumer is notified after the unlock so it does not wake up on a locked mutex
+ * a STATS event of a source whose previous STATS is still waiting only replaces it :
+ * the queue is bounded by the count of sources, not by the rate of their notifications
+ * if its priority changed, the waiting one is removed and the new one waits in its own lane from now
+ * a full queue sheds the oldest event of its lowest lane, or the pushed event when its lane is the lowest
+ *
+ * @param p_event
+ */
+void                                EventQueue::push(Event p_event)
+{
+    {
+        std::lock_guard<std::mutex> l_lock(i_mutex);
+        size_t                      l_lane = laneOf(p_event.eventType, p_event.eventPriority);
+
+        i_counters.pushed++;
+
+        if (isCoalesced(p_event))
+        {
+            auto l_latest = i_latestStats.find(statsKey(p_event));
+
+            if (l_latest != i_latestStats.end())
+            {
+                Event   *l_queued = l_latest->second;
+                size_t  l_queuedLane = laneOf(l_queued->eventType, l_queued->eventPriority);
+
+                i_counters.coalesced++;
+                if (l_queuedLane == l_lane)
+                {
+                    // already waiting, the consumer is already notified
+                    // the queued time of the first one is kept : aging and dispatch latency of the source
+                    p_event.queuedTime = l_queued->queuedTime;
+                    *l_queued = std::move(p_event);
+                    return;
+                }
+                eraseLocked(l_queuedLane, l_queued);
+            }
+        }
+
+        if (i_size >= i_capacity)
+        {
+            size_t  l_shedLane = EVENT_LANE_COUNT;
+
+            while (l_shedLane > l_lane && i_lanes[l_shedLane - 1].empty())
+                l_shedLane--;
+
+            if (l_shedLane == l_lane)
+            {
+                // every waiting event is in a higher lane
+                i_counters.shed[l_lane]++;
+                return;
+            }
+            shedLocked(l_shedLane - 1);
+        }
+
+        p_event.queuedTime = std::chrono::steady_clock::now();
+        i_lanes[l_lane].emplace_back(std::move(p_event));
+        i_size++;
+
+        if (isCoalesced(i_lanes[l_lane].back()))
+            i_latestStats[statsKey(i_lanes[l_lane].back())] = &i_lanes[l_lane].back();
+    }
+    i_condition.notify_one();
+}
+
+/**
+ * @brief
+ * Wait for the highest priority event and move it out of the queue
+ *
+ * @param p_event [out]
+ * @return true an event was popped
+ * @return false the queue is closed
+ */
+bool                                EventQueue::pop(Event &p_event)
+{
+    std::unique_lock<std::mutex> l_lock(i_mutex);
+
+    i_condition.wait(l_lock, [this] { return i_isClosed || i_size > 0; });
+    if (i_isClosed)
+        return false;
+
+    popLocked(p_event);
+
+    return true;
+}
+
+/**
+ * @brief
+ * Move the highest priority event out of the queue without waiting
+ *
+ * @param p_event [out]
+ * @return true an event was popped
+ * @return false the queue is empty
+ */
+bool                                EventQueue::tryPop(Event &p_event)
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+
+    if (i_size == 0)
+        return false;
+
+    popLocked(p_event);
+
+    return true;
+}
+
+/**
+ * @brief
+ * Wake up every consumer waiting in pop, the following pops return false
+ *
+ */
+void                                EventQueue::close(void)
+{
+    {
+        std::lock_guard<std::mutex> l_lock(i_mutex);
+        i_isClosed = true;
+    }
+    i_condition.notify_all();
+}
+
+/**
+ * @brief
+ * Remove all the events
+ *
+ */
+void                                EventQueue::clear(void)
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+
+    for (std::deque<Event> &l_lane : i_lanes)
+        l_lane.clear();
+    i_latestStats.clear();
+    i_size = 0;
+}
+
+bool                                EventQueue::empty(void) const
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    return i_size == 0;
+}
+
+size_t                              EventQueue::size(void) const
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    return i_size;
+}
+
+u_int64_t                           EventQueue::coalescedCount(void) const
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    return i_counters.coalesced;
+}
+
+u_int64_t                           EventQueue::shedCount(void) const
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    u_int64_t                   l_shedCount = 0;
+
+    for (u_int64_t l_laneShedCount : i_counters.shed)
+        l_shedCount += l_laneShedCount;
+    return l_shedCount;
+}
+
+/**
+ * @brief
+ * Snapshot of the counters, with the current depth of each lane
+ *
+ * @return EventQueueCounters
+ */
+EventQueueCounters                  EventQueue::counters(void) const
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    EventQueueCounters          l_counters = i_counters;
+
+    for (size_t l_lane = 0; l_lane < EVENT_LANE_COUNT; l_lane++)
+        l_counters.depth[l_lane] = i_lanes[l_lane].size();
+    return l_counters;
+}
+
+/**
+ * @brief
+ * Lane of an event : the type first (CONFIG is lane 0 to 3), then the priority (FATAL first)
+ * the types and priorities received from the modules are not trusted, they are clamped
+ *
+ * @param p_eventType
+ * @param p_eventPriority
+ * @return size_t
+ */
+size_t                              EventQueue::laneOf(e_eventType p_eventType, e_eventPriority p_eventPriority)
+{
+    int l_type = std::min(std::max((int)p_eventType, 0), EVENT_TYPE_COUNT - 1);
+    int l_priority = std::min(std::max((int)p_eventPriority, 0), EVENT_PRIORITY_COUNT - 1);
+
+    return (size_t)(l_type * EVENT_PRIORITY_COUNT + (EVENT_PRIORITY_COUNT - 1 - l_priority));
+}
+
+bool                                EventQueue::isCoalesced(const Event &p_event)
+{
+    return p_event.eventType == STATS;
+}
+
+EventQueue::StatsKey                EventQueue::statsKey(const Event &p_event)
+{
+    return StatsKey((int)p_event.sourceType, p_event.sourceID, (int)p_event.eventType);
+}
+
+/**
+ * @brief
+ * Move the next event out of the queue : the oldest event of the first non empty lane,
+ * unless the oldest event of a lower lane waited more than the aging delay
+ * (the oldest of these aged events goes first)
+ *
+ * @param p_event [out]
+ */
+void                                EventQueue::popLocked(Event &p_event)
+{
+    size_t  l_lane = 0;
+
+    while (i_lanes[l_lane].empty())
+        l_lane++;
+
+    auto    l_agedBefore = std::chrono::steady_clock::now() - i_agingDelay;
+    size_t  l_agedLane = EVENT_LANE_COUNT;
+
+    for (size_t l_lowerLane = l_lane + 1; l_lowerLane < EVENT_LANE_COUNT; l_lowerLane++)
+    {
+        if (i_lanes[l_lowerLane].empty() || i_lanes[l_lowerLane].front().queuedTime > l_agedBefore)
+            continue;
+        if (l_agedLane == EVENT_LANE_COUNT ||
+            i_lanes[l_lowerLane].front().queuedTime < i_lanes[l_agedLane].front().queuedTime)
+            l_agedLane = l_lowerLane;
+    }
+
+    if (l_agedLane != EVENT_LANE_COUNT && i_lanes[l_agedLane].front().queuedTime < i_lanes[l_lane].front().queuedTime)
+    {
+        l_lane = l_agedLane;
+        i_counters.aged++;
+    }
+
+    std::deque<Event>   &l_events = i_lanes[l_lane];
+
+    if (isCoalesced(l_events.front()))
+        i_latestStats.erase(statsKey(l_events.front()));
+
+    p_event = std::move(l_events.front());
+    l_events.pop_front();
+    i_size--;
+    i_counters.popped++;
+}
+
+void                                EventQueue::shedLocked(size_t p_lane)
+{
+    std::deque<Event>   &l_events = i_lanes[p_lane];
+
+    if (isCoalesced(l_events.front()))
+        i_latestStats.erase(statsKey(l_events.front()));
+
+    l_events.pop_front();
+    i_size--;
+    i_counters.shed[p_lane]++;
+}
+
+/**
+ * @brief
+ * Remove a STATS waiting in a lane, replaced by a newer one of another priority
+ * rare : the lane is searched, and the latest STATS left in it are pointed again
+ * (an erase in the middle of a deque invalidates the references to its elements)
+ *
+ * @param p_lane
+ * @param p_event
+ */
+void                                EventQueue::eraseLocked(size_t p_lane, const Event *p_event)
+{
+    std::deque<Event>   &l_events = i_lanes[p_lane];
+    auto                l_queued = std::find_if(l_events.begin(), l_events.end(),
+                                                [p_event](const Event &p_queued) { return &p_queued == p_event; });
+
+    i_latestStats.erase(statsKey(*l_queued));
+    l_events.erase(l_queued);
+    i_size--;
+
+    for (Event &l_event : l_events)
+        if (isCoalesced(l_event))
+            i_latestStats[statsKey(l_event)] = &l_event;
+}
@@ -1,8 +1,16 @@
 #include "launcher.hpp"
 
 #include <unistd.h>
+#include <spawn.h> // posix_spawn
+#include <string.h> // strerror
+#include <sys/syscall.h> // SYS_set_mempolicy
+#include <linux/mempolicy.h> // MPOL_BIND
+#include <fstream>
+#include <vector>
 
-Launcher::Launcher(ILog &p_launcherLog, char **p_envp) : i_log(p_launcherLog), i_envp(p_envp)
+Launcher::Launcher(ILog &p_launcherLog, char **p_envp, StatusPages *p_statusPages) : i_log(p_launcherLog),
+                                                                                    i_envp(p_envp),
+                                                                                    i_statusPages(p_statusPages)
 {
     i_log.log(LOG_INFO, "Launcher::%s", __func__);
 }
@@ -42,9 +50,220 @@ ILauncher::eStop         Launcher::stop(int p_sigNum)
 }
 
 /**
- * rbrief
+ * @brief
+ * Fill p_cpuSet from a cpu list string (ex. "0-3,8,10-11")
+ * same format as the cpuset files and "taskset -c"
+ * 
+ * @param p_cpuList 
+ * @param p_cpuSet 
+ * @return true if the list is valid and not empty
+ */
+bool                    Launcher::parseCpuList(const std::string &p_cpuList, cpu_set_t *p_cpuSet)
+{
+    CPU_ZERO(p_cpuSet);
+
+    size_t  l_pos = 0;
+    bool    l_isEmpty = true;
+
+    while (l_pos < p_cpuList.size())
+    {
+        size_t      l_end = p_cpuList.find(',', l_pos);
+        if (l_end == std::string::npos)
+            l_end = p_cpuList.size();
+
+        std::string l_range = p_cpuList.substr(l_pos, l_end - l_pos);
+        l_pos = l_end + 1;
+
+        // trailing '\n' of the sysfs files
+        while (!l_range.empty() && (l_range.back() == '\n' || l_range.back() == ' '))
+            l_range.pop_back();
+        if (l_range.empty())
+            continue;
+
+        size_t      l_dash = l_range.find('-');
+        std::string l_firstCpu = l_range.substr(0, l_dash);
+        std::string l_lastCpu = (l_dash == std::string::npos) ? l_firstCpu : l_range.substr(l_dash + 1);
+        size_t      l_firstLength;
+        size_t      l_lastLength;
+        int         l_first;
+        int         l_last;
+
+        // the numbers must take the whole token : "3abc" or "0-3-5" are refused, not read as 3 or 0-3
+        try
+        {
+            l_first = std::stoi(l_firstCpu, &l_firstLength);
+            l_last = std::stoi(l_lastCpu, &l_lastLength);
+        }
+        catch (const std::exception &e)
+        {
+            return false;
+        }
+        if (l_firstLength != l_firstCpu.size() || l_lastLength != l_lastCpu.size())
+            return false;
+
+        if (l_first < 0 || l_last < l_first || l_last >= CPU_SETSIZE)
+            return false;
+
+        for (int l_cpu = l_first; l_cpu <= l_last; l_cpu++)
+            CPU_SET(l_cpu, p_cpuSet);
+        l_isEmpty = false;
+    }
+
+    return !l_isEmpty;
+}
+
+/**
+ * @brief
+ * Build the cpu set and the numa node mask of a module
+ * done in the parent process, so the child only does syscalls between fork and execve
+ * if a numa node is given without cpuset, the module is pinned on the cpus of this node
+ * 
+ * @param p_module 
+ * @param p_cpuSet [out]
+ * @param p_hasCpuSet [out]
+ * @param p_nodeMask [out]
+ * @param p_hasNodeMask [out]
+ * @return false if the placement of the module is invalid
+ */
+bool                    Launcher::getPlacement(const Module &p_module, cpu_set_t *p_cpuSet, bool *p_hasCpuSet,
+                                               unsigned long *p_nodeMask, bool *p_hasNodeMask)
+{
+    *p_hasCpuSet = false;
+    *p_hasNodeMask = false;
+    *p_nodeMask = 0;
+
+    if (p_module.numaNode >= 0)
+    {
+        if (p_module.numaNode >= (int)(sizeof(*p_nodeMask) * 8))
+        {
+            i_log.log(LOG_ERR, "Launcher::%s - invalid numaNode [%d]", __func__, p_module.numaNode);
+            return false;
+        }
+        *p_nodeMask = 1UL << p_module.numaNode;
+        *p_hasNodeMask = true;
+    }
+
+    std::string l_cpuList = p_module.cpuset;
+
+    if (l_cpuList.empty() && *p_hasNodeMask)
+    {
+        std::ifstream l_nodeCpuList("/sys/devices/system/node/node" + std::to_string(p_module.numaNode) + "/cpulist");
+
+        if (!l_nodeCpuList.is_open() || !std::getline(l_nodeCpuList, l_cpuList))
+        {
+            i_log.log(LOG_ERR, "Launcher::%s - unable to read the cpus of numa node [%d]", __func__, p_module.numaNode);
+            return false;
+        }
+    }
+
+    if (l_cpuList.empty())
+        return true;
+
+    if (!parseCpuList(l_cpuList, p_cpuSet))
+    {
+        i_log.log(LOG_ERR, "Launcher::%s - invalid cpuset [%s]", __func__, l_cpuList.c_str());
+        return false;
+    }
+    *p_hasCpuSet = true;
+
+    return true;
+}
+
+/**
+ * @brief
+ * Set the cpu set and the memory policy of the calling thread (the controller thread),
+ * the module spawned by this thread inherits them
+ * the previous placement is saved in p_previous to be restored after the spawn
+ * 
+ * @param p_cpuSet 
+ * @param p_hasCpuSet 
+ * @param p_nodeMask 
+ * @param p_hasNodeMask 
+ * @param p_previous [out]
+ * @return true 
+ * @return false the placement could not be applied, the previous one is restored
+ */
+bool                    Launcher::setThreadPlacement(const cpu_set_t *p_cpuSet, bool p_hasCpuSet,
+                                                     const unsigned long *p_nodeMask, bool p_hasNodeMask,
+                                                     ThreadPlacement *p_previous)
+{
+    p_previous->hasCpuSet = false;
+    p_previous->hasMemoryPolicy = false;
+
+    if (p_hasNodeMask)
+    {
+        if (syscall(SYS_get_mempolicy, &p_previous->memoryPolicy, p_previous->nodeMask,
+                    sizeof(p_previous->nodeMask) * 8, nullptr, 0) == -1)
+        {
+            i_log.log(LOG_ERR, "Launcher::%s - get_mempolicy failed [%s]", __func__, strerror(errno));
+            return false;
+        }
+        p_previous->hasMemoryPolicy = true;
+
+        // maxnode : the kernel reads maxnode - 1 bits, + 1 to keep the last node of the mask
+        if (syscall(SYS_set_mempolicy, MPOL_BIND, p_nodeMask, sizeof(*p_nodeMask) * 8 + 1) == -1)
+        {
+            i_log.log(LOG_ERR, "Launcher::%s - set_mempolicy failed [%s]", __func__, strerror(errno));
+            restoreThreadPlacement(p_previous);
+            return false;
+        }
+    }
+
+    if (p_hasCpuSet)
+    {
+        if (sched_getaffinity(0, sizeof(p_previous->cpuSet), &p_previous->cpuSet) == -1)
+        {
+            i_log.log(LOG_ERR, "Launcher::%s - sched_getaffinity failed [%s]", __func__, strerror(errno));
+            restoreThreadPlacement(p_previous);
+            return false;
+        }
+        p_previous->hasCpuSet = true;
+
+        if (sched_setaffinity(0, sizeof(*p_cpuSet), p_cpuSet) == -1)
+        {
+            i_log.log(LOG_ERR, "Launcher::%s - sched_setaffinity failed [%s]", __func__, strerror(errno));
+            restoreThreadPlacement(p_previous);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief
+ * Restore the placement of the calling thread saved by setThreadPlacement
+ * 
+ * @param p_previous 
+ */
+void                    Launcher::restoreThreadPlacement(ThreadPlacement *p_previous)
+{
+    if (p_previous->hasCpuSet && sched_setaffinity(0, sizeof(p_previous->cpuSet), &p_previous->cpuSet) == -1)
+        i_log.log(LOG_ERR, "Launcher::%s - sched_setaffinity failed [%s]", __func__, strerror(errno));
+
+    if (p_previous->hasMemoryPolicy)
+    {
+        long l_result;
+
+        if (p_previous->memoryPolicy == MPOL_DEFAULT)
+            l_result = syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+        else
+            l_result = syscall(SYS_set_mempolicy, p_previous->memoryPolicy, p_previous->nodeMask,
+                               sizeof(p_previous->nodeMask) * 8 + 1);
+        if (l_result == -1)
+            i_log.log(LOG_ERR, "Launcher::%s - set_mempolicy failed [%s]", __func__, strerror(errno));
+    }
+
+    p_previous->hasCpuSet = false;
+    p_previous->hasMemoryPolicy = false;
+}
+
+/**
+ * @brief
  * Launch a program pointed to by module.name 
  * with its given parameters pointed to by module.parameters
+ * posix_spawn (clone CLONE_VM | CLONE_VFORK in the glibc) : the page tables of the agent are not copied
+ * and no agent code runs in the child, an execve failure is returned by posix_spawn
  * 
  * @param p_module 
  * @param p_modulePid 
@@ -52,7 +271,7 @@ ILauncher::eStop         Launcher::stop(int p_sigNum)
  */
 ILauncher::eLaunchModule         Launcher::launchModule(Module p_module, pid_t *p_modulePid)
 {
-    i_log.log(LOG_INFO, "Launcher::%s , module pid : %d", __func__, p_modulePid);
+    i_log.log(LOG_INFO, "Launcher::%s , module [%d]", __func__, p_module.id);
     
     // local array variable needed as parameter for execve syscall
     char            *l_param[3];
@@ -61,31 +280,78 @@ ILauncher::eLaunchModule         Launcher::launchModule(Module p_module, pid_t *
     l_param[1] = (char *)p_module.parameters.c_str();
     l_param[2] = nullptr; // 1. RTFM , 2. if you pass an array to a method, without giving its size ... how the method is suppose to know the end of the array ? ... so "nullptr"
 
-    i_log.log(LOG_INFO, "Fork execution");
-    *p_modulePid = fork();
-    i_log.log(LOG_INFO, "After fork, fork pid_t : %i", *p_modulePid);
+    // cpu and numa placement, inherited by the module from the spawning thread
+    cpu_set_t       l_cpuSet;
+    bool            l_hasCpuSet;
+    unsigned long   l_nodeMask;
+    bool            l_hasNodeMask;
+    ThreadPlacement l_previousPlacement;
+
+    if (!getPlacement(p_module, &l_cpuSet, &l_hasCpuSet, &l_nodeMask, &l_hasNodeMask))
+        return ILauncher::eLaunchModule::FAILURE;
+
+    // environment of the agent, plus the name of the status page of the module
+    std::vector<char *> l_environment;
+    std::string         l_statusPage;
+
+    for (char **l_variable = i_envp; l_variable != nullptr && *l_variable != nullptr; l_variable++)
+        if (strncmp(*l_variable, STATUS_PAGE_ENV "=", sizeof(STATUS_PAGE_ENV)) != 0)
+            l_environment.push_back(*l_variable);
 
-    if (*p_modulePid == 0) // child process
+    if (i_statusPages != nullptr)
     {
-        // success;
-        i_log.log(LOG_INFO, "execve execution");
-        if ((execve(l_param[0], l_param, i_envp)) == -1)
+        if (i_statusPages->create(p_module.id, l_statusPage))
         {
-            i_log.log(LOG_INFO, "tata execve fail");
-            return ILauncher::eLaunchModule::FAILURE;
+            l_statusPage = STATUS_PAGE_ENV "=" + l_statusPage;
+            l_environment.push_back((char *)l_statusPage.c_str());
         }
-        i_log.log(LOG_INFO, "execve succeed");
-        return ILauncher::eLaunchModule::SUCCESS;
+        else
+            i_log.log(LOG_WARNING, "Launcher::%s - no status page for module [%d] : %s", __func__, p_module.id, strerror(errno));
     }
-    else if (*p_modulePid > 0) // parent process
+    l_environment.push_back(nullptr);
+
+    // the agent threads block the stop signals (Agent::start) and the mask is inherited through execve :
+    // the module starts with an empty mask, and default handlers whatever the agent did with them
+    posix_spawnattr_t   l_attributes;
+    sigset_t            l_signalMask;
+    sigset_t            l_defaultSignals;
+
+    sigemptyset(&l_signalMask);
+    sigemptyset(&l_defaultSignals);
+    sigaddset(&l_defaultSignals, SIGCHLD);
+    sigaddset(&l_defaultSignals, SIGPIPE);
+    sigaddset(&l_defaultSignals, SIGINT);
+    sigaddset(&l_defaultSignals, SIGTERM);
+    sigaddset(&l_defaultSignals, SIGQUIT);
+
+    posix_spawnattr_init(&l_attributes);
+    posix_spawnattr_setsigmask(&l_attributes, &l_signalMask);
+    posix_spawnattr_setsigdefault(&l_attributes, &l_defaultSignals);
+    posix_spawnattr_setflags(&l_attributes, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    // a module not launched leaves no page in /dev/shm, the next attempt creates it again
+    if (!setThreadPlacement(&l_cpuSet, l_hasCpuSet, &l_nodeMask, l_hasNodeMask, &l_previousPlacement))
     {
-        // do nothing
+        posix_spawnattr_destroy(&l_attributes);
+        if (i_statusPages != nullptr)
+            i_statusPages->remove(p_module.id);
+        return ILauncher::eLaunchModule::FAILURE;
     }
-    else if (*p_modulePid < 0) // error
+
+    int l_error = posix_spawn(p_modulePid, l_param[0], nullptr, &l_attributes, l_param, l_environment.data());
+
+    restoreThreadPlacement(&l_previousPlacement);
+    posix_spawnattr_destroy(&l_attributes);
+
+    if (l_error != 0)
     {
-        i_log.log(LOG_ERR, "Fork failed !!!");
+        i_log.log(LOG_ERR, "Launcher::%s - unable to launch [%s] : %s", __func__, l_param[0], strerror(l_error));
+        if (i_statusPages != nullptr)
+            i_statusPages->remove(p_module.id);
         return ILauncher::eLaunchModule::FAILURE;
     }
 
+    i_log.log(LOG_INFO, "Launcher::%s - module [%d] launched, pid [%d]", __func__, p_module.id, *p_modulePid);
+
     return ILauncher::eLaunchModule::SUCCESS;
-}
\ No newline at end of file
+}
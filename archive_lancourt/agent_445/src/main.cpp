@@ -22,9 +22,11 @@
 #include <string.h>
 #include <unistd.h>
 #include "syslog.hpp"
+#include "asyncLog.hpp"
 #include "mock/mock_iLog.hpp"
 
 #include "commonTools.hpp"
+#include "eventQueue.hpp"
 
 int main(int argc, char **argv, char **envp)
 {
@@ -42,18 +44,26 @@ int main(int argc, char **argv, char **envp)
         return EXIT_FAILURE;
     }
 
-    Syslog          l_log("Agent", LOG_PID | LOG_NDELAY, LOG_USER);
+    Syslog          l_syslog("Agent", LOG_PID | LOG_NDELAY, LOG_USER);
 
-    // i_eventList
-    std::priority_queue<Event, std::vector<Event>, compareEventPriority> g_eventList;
+    // the modules log in the rings of their threads, l_syslog is written by the thread of l_log
+    AsyncLog        l_log(l_syslog);
 
-    Launcher        l_launcher(l_log, envp);
+    l_log.start();
+
+    // events of the receivers, consumed by the controller
+    EventQueue      l_eventQueue;
+
+    // shared memory status page of each launched module, read by the observer
+    StatusPages     l_statusPages;
+
+    Launcher        l_launcher(l_log, envp, &l_statusPages);
     Stopper         l_stopper(l_log);
-    Observer        l_observer(l_log);
+    Observer        l_observer(&l_eventQueue, l_launcher, l_log, &l_statusPages);
     NetconfServer   l_netconfServer(l_log);
-    ConfigReceiver  l_configReceiver(l_netconfServer, &g_eventList, l_log);
-    StatusReceiver  l_statusReceiver(&g_eventList, l_log);
-    Controller      l_controller(&g_eventList, l_configReceiver, l_statusReceiver, l_launcher, l_stopper, l_observer, l_log);
+    ConfigReceiver  l_configReceiver(l_netconfServer, &l_eventQueue, l_log);
+    StatusReceiver  l_statusReceiver(&l_eventQueue, l_log);
+    Controller      l_controller(&l_eventQueue, l_configReceiver, l_statusReceiver, l_launcher, l_stopper, l_observer, l_log);
 
     if (argc != 2)
     {
@@ -85,7 +95,7 @@ int main(int argc, char **argv, char **envp)
 
     l_agent.start();
 
-	// reset the priority queue with empty content
-    g_eventList = std::priority_queue<Event, std::vector<Event>, compareEventPriority>();
+	// drop the events not processed
+    l_eventQueue.clear();
     return 0;
 }
@@ -0,0 +1,32 @@
+#include "metricsServer.hpp"
+
+/**
+ * @brief
+ * Construct a new Metrics Server:: Metrics Server object
+ *
+ * @param p_metrics
+ * @param p_log
+ */
+MetricsServer::MetricsServer(const AgentMetrics &p_metrics, ILog &p_log) : UnixSocketServer(p_log, "MetricsServer", 0, METRICS_SEND_TIMEOUT),
+                                                                           i_metrics(p_metrics)
+{
+}
+
+MetricsServer::~MetricsServer(void)
+{
+    stop();
+}
+
+/**
+ * @brief
+ * The metrics are built when a client connects, nothing is done between two clients
+ *
+ * @param p_request
+ * @return std::string
+ */
+std::string                         MetricsServer::answer(const std::string &p_request)
+{
+    (void)p_request;
+
+    return i_metrics.toJson().dump() + "\n";
+}
@@ -1,47 +1,634 @@
 #include "observer.hpp"
+#include "asyncLog.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#include <fcntl.h>
+
+#include <cstdio>
+#include <cstring>
+
+#ifndef SYS_pidfd_open
+# define SYS_pidfd_open 434
+#endif
+
+#ifndef P_PIDFD
+# define P_PIDFD 3
+#endif
 
 /**
  * @brief Construct a new Observer:: Observer object
- * 
- * @param p_log 
+ *
+ * @param p_eventList the exits and restarts of the modules are pushed in it
+ * @param p_launcher used to restart the modules
+ * @param p_log
+ * @param p_statusPages read with the samples, the page of a stopped module is removed
  */
-Observer::Observer(ILog &p_log) : i_log(p_log)
+Observer::Observer(EventQueue *p_eventList, ILauncher &p_launcher, ILog &p_log, StatusPages *p_statusPages)
+    : i_eventList(p_eventList),
+      i_launcher(p_launcher),
+      i_log(p_log),
+      i_isObserverRunning(false),
+      i_epollfd(-1),
+      i_wakeEventfd(-1),
+      i_samplePeriod(SAMPLE_PERIOD),
+      i_statusPages(p_statusPages)
 {
     i_log.log(LOG_INFO, "Observer::%s", __func__);
 }
 
 /**
  * @brief Destroy the Observer:: Observer object
- * 
+ *
  */
 Observer::~Observer()
 {
     i_log.log(LOG_INFO, "Observer::%s", __func__);
+    stop(0);
 }
 
 /**
- * @brief todo
- * useless for the moment -> TODO : delete it
- * 
+ * @brief
+ * Create the epoll set holding the pidfd of each module,
+ * and the eventfd waking up the observer thread when it has to stop
+ * a sample costs about 5 us of cpu per module (the kernel formats /proc/<pid>/stat) : 2.5 % of a core
+ * for 500 modules at the default period, a longer "observer_samplePeriod" lowers it
+ *
+ * @param p_json configuration of the agent
+ * @return IObserver::eInit
  */
-IObserver::eInit        Observer::init(void) // todo
+IObserver::eInit        Observer::init(const nlohmann::json &p_json)
 {
     i_log.log(LOG_INFO, "Observer::%s", __func__);
-    // todo
+
+    try
+    {
+        unsigned int    l_schedstatInterval = PROC_SCHEDSTAT_INTERVAL;
+
+        if (p_json.count("observer_samplePeriod"))
+            getJsonParameter(i_samplePeriod, p_json, "observer_samplePeriod");
+        if (p_json.count("observer_schedstatInterval"))
+            getJsonParameter(l_schedstatInterval, p_json, "observer_schedstatInterval");
+        i_sampler.setSchedstatInterval(l_schedstatInterval);
+    }
+    catch (const std::exception &e)
+    {
+        i_log.log(LOG_ERR, "Observer::%s - invalid sampling parameters : %s", __func__, e.what());
+        return IObserver::eInit::FAILURE;
+    }
+    if (i_samplePeriod <= 0)
+    {
+        i_log.log(LOG_ERR, "Observer::%s - invalid observer_samplePeriod [%d]", __func__, i_samplePeriod);
+        return IObserver::eInit::FAILURE;
+    }
+
+    if (i_epollfd >= 0)
+        return IObserver::eInit::SUCCESS;
+
+    i_epollfd = epoll_create1(EPOLL_CLOEXEC);
+    i_wakeEventfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (i_epollfd < 0 || i_wakeEventfd < 0)
+    {
+        i_log.log(LOG_ERR, "Observer::%s - unable to create the epoll set : %s", __func__, strerror(errno));
+        return IObserver::eInit::FAILURE;
+    }
+
+    struct epoll_event  l_event;
+
+    std::memset(&l_event, 0, sizeof(l_event));
+    l_event.events = EPOLLIN;
+    l_event.data.fd = i_wakeEventfd;
+    if (epoll_ctl(i_epollfd, EPOLL_CTL_ADD, i_wakeEventfd, &l_event) < 0)
+    {
+        i_log.log(LOG_ERR, "Observer::%s - epoll_ctl : %s", __func__, strerror(errno));
+        return IObserver::eInit::FAILURE;
+    }
+
     return IObserver::eInit::SUCCESS;
 }
 
 /**
- * @brief todo 
- * useless for the moment -> TODO : delete it
- * 
- * @param p_sigNum 
- * @return IObserver::eStop 
+ * @brief
+ * Launch the thread waiting for the end of the modules
+ *
+ * @return IObserver::eStart
  */
-IObserver::eStop        Observer::stop(int p_sigNum)
+IObserver::eStart       Observer::start(void)
 {
     i_log.log(LOG_INFO, "Observer::%s", __func__);
-    // todo
-    (void)p_sigNum;
+
+    if (i_epollfd < 0)
+        return IObserver::eStart::FAILURE;
+
+    i_isObserverRunning = true;
+    i_observerThread = std::thread(&Observer::observeModules, this);
+
+    if (!i_observerThread.joinable())
+    {
+        i_log.log(LOG_ERR, "i_observerThread not joinable !");
+        i_isObserverRunning = false;
+        return IObserver::eStart::FAILURE;
+    }
+
+    return IObserver::eStart::SUCCESS;
+}
+
+/**
+ * @brief
+ * Stop the observer thread and close the pidfds
+ * the modules are not stopped (the controller stops them before)
+ *
+ * @param p_sigNum
+ * @return IObserver::eStop
+ */
+IObserver::eStop        Observer::stop(int p_sigNum)
+{
+    i_log.log(LOG_INFO, "Observer::%s [%i]", __func__, p_sigNum);
+
+    i_isObserverRunning = false;
+
+    // wake up the observer thread waiting in epoll_wait
+    if (i_wakeEventfd >= 0)
+        eventfd_write(i_wakeEventfd, 1);
+
+    if (i_observerThread.joinable())
+        i_observerThread.join();
+
+    std::lock_guard<std::mutex>     l_lock(i_mutex);
+
+    for (const auto &l_watched : i_watchedModules)
+    {
+        if (l_watched.second.pidfd >= 0)
+            close(l_watched.second.pidfd);
+        i_sampler.remove(l_watched.first);
+    }
+    for (const auto &l_stopping : i_stoppingPids)
+        close(l_stopping.first);
+    i_watchedModules.clear();
+    i_pidfdModuleIds.clear();
+    i_stoppingPids.clear();
+
+    if (i_wakeEventfd >= 0)
+        close(i_wakeEventfd);
+    if (i_epollfd >= 0)
+        close(i_epollfd);
+    i_wakeEventfd = -1;
+    i_epollfd = -1;
+
     return IObserver::eStop::SUCCESS;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief
+ * Supervise a launched module : its pidfd is added to the epoll set,
+ * and the module is restarted when it ends
+ *
+ * @param p_module
+ * @param p_modulePid
+ * @return IObserver::eWatchModule
+ */
+IObserver::eWatchModule Observer::watchModule(const Module &p_module, pid_t p_modulePid)
+{
+    i_log.log(LOG_INFO, "Observer::%s [%d] pid [%d]", __func__, p_module.id, p_modulePid);
+
+    std::lock_guard<std::mutex>     l_lock(i_mutex);
+    int                             l_pidfd = openPidfd(p_modulePid);
+
+    if (l_pidfd < 0)
+        return IObserver::eWatchModule::FAILURE;
+
+    // a module watched again (restarted by the controller) keeps its restart delay
+    auto            l_previous = i_watchedModules.find(p_module.id);
+    WatchedModule   l_watched;
+
+    l_watched.restartDelay = RESTART_DELAY_MIN;
+    if (l_previous != i_watchedModules.end())
+    {
+        l_watched.restartDelay = l_previous->second.restartDelay;
+        if (l_previous->second.pidfd >= 0)
+        {
+            i_pidfdModuleIds.erase(l_previous->second.pidfd);
+            i_stoppingPids[l_previous->second.pidfd] = l_previous->second.pid;
+        }
+    }
+
+    l_watched.module = p_module;
+    l_watched.pid = p_modulePid;
+    l_watched.pidfd = l_pidfd;
+    l_watched.startTime = std::chrono::steady_clock::now();
+    l_watched.isRestartPending = false;
+    l_watched.isHung = false;
+
+    i_watchedModules[p_module.id] = l_watched;
+    i_pidfdModuleIds[l_pidfd] = p_module.id;
+    i_sampler.add(p_module.id, p_modulePid);
+
+    // sampled from now on : the observer thread recomputes its timeout
+    eventfd_write(i_wakeEventfd, 1);
+
+    return IObserver::eWatchModule::SUCCESS;
+}
+
+/**
+ * @brief
+ * Stop the supervision of a module the controller is going to stop :
+ * its end is only reaped, and a pending restart is cancelled
+ * the pidfd handed over is a dup of the one the observer keeps until it reaps the module :
+ * it still designates the module once reaped, a pid reused meanwhile is never signaled through it
+ *
+ * @param p_moduleId
+ * @param p_moduleProcess [out] current pid of the module and a dup of its pidfd (closed by the receiver),
+ * untouched if it is not watched, pid -1 if it ended and waits for its restart
+ * @return IObserver::eUnwatchModule
+ */
+IObserver::eUnwatchModule Observer::unwatchModule(int p_moduleId, ModuleProcess *p_moduleProcess)
+{
+    i_log.log(LOG_INFO, "Observer::%s [%d]", __func__, p_moduleId);
+
+    std::lock_guard<std::mutex>     l_lock(i_mutex);
+    auto                            l_watched = i_watchedModules.find(p_moduleId);
+
+    if (l_watched == i_watchedModules.end())
+        return IObserver::eUnwatchModule::FAILURE;
+
+    if (l_watched->second.pidfd >= 0)
+    {
+        i_pidfdModuleIds.erase(l_watched->second.pidfd);
+        i_stoppingPids[l_watched->second.pidfd] = l_watched->second.pid;
+    }
+
+    if (p_moduleProcess != nullptr)
+    {
+        p_moduleProcess->pid = l_watched->second.isRestartPending ? -1 : l_watched->second.pid;
+        p_moduleProcess->pidfd = -1;
+        if (!l_watched->second.isRestartPending && l_watched->second.pidfd >= 0)
+            p_moduleProcess->pidfd = fcntl(l_watched->second.pidfd, F_DUPFD_CLOEXEC, 0);
+    }
+
+    i_sampler.remove(p_moduleId);
+    if (i_statusPages != nullptr)
+        i_statusPages->remove(p_moduleId);
+
+    i_watchedModules.erase(l_watched);
+
+    return IObserver::eUnwatchModule::SUCCESS;
+}
+
+/**
+ * @brief
+ * Launched in a new thread
+ * wait on the pidfds of the modules, epoll_wait times out when the next restart or the next sample is due
+ *
+ */
+void                    Observer::observeModules(void)
+{
+    i_log.log(LOG_DEBUG, "Observer::%s", __func__);
+
+    struct epoll_event  l_events[OBSERVER_MAX_EVENTS];
+    int                 l_timeout = -1;
+
+    while (i_isObserverRunning)
+    {
+        int l_eventCount = epoll_wait(i_epollfd, l_events, OBSERVER_MAX_EVENTS, l_timeout);
+
+        if (l_eventCount < 0 && errno != EINTR)
+        {
+            i_log.log(LOG_ERR, "Observer::%s - epoll_wait : %s", __func__, strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < l_eventCount; i++)
+        {
+            if (l_events[i].data.fd == i_wakeEventfd)
+            {
+                eventfd_t   l_value;
+
+                eventfd_read(i_wakeEventfd, &l_value);
+                continue;
+            }
+            onModuleExit(l_events[i].data.fd);
+        }
+
+        if (!i_isObserverRunning)
+            break;
+
+        int l_restartTimeout = restartModules();
+        int l_sampleTimeout = sampleModules();
+
+        // the nearest of the next restart and the next sample
+        l_timeout = l_restartTimeout;
+        if (l_sampleTimeout >= 0 && (l_timeout < 0 || l_sampleTimeout < l_timeout))
+            l_timeout = l_sampleTimeout;
+    }
+}
+
+/**
+ * @brief
+ * Reap a module which ended, then either forget it (stopped by the controller),
+ * or push an ALERT event and schedule its restart
+ * the delay doubles at each crash, and goes back to the minimum after a module ran RESTART_STABLE_TIME
+ *
+ * @param p_pidfd
+ */
+void                    Observer::onModuleExit(int p_pidfd)
+{
+    std::lock_guard<std::mutex>     l_lock(i_mutex);
+    siginfo_t                       l_info;
+
+    std::memset(&l_info, 0, sizeof(l_info));
+    if (waitid((idtype_t)P_PIDFD, p_pidfd, &l_info, WEXITED | WNOHANG) < 0)
+        i_log.log(LOG_ERR, "Observer::%s - waitid : %s", __func__, strerror(errno));
+    else if (l_info.si_pid == 0)
+        return; // not ended yet
+
+    auto    l_stopping = i_stoppingPids.find(p_pidfd);
+
+    if (l_stopping != i_stoppingPids.end())
+    {
+        AGENT_LOG(i_log, LOG_DEBUG, "Observer::%s - stopped module pid [%d] reaped", __func__, l_stopping->second);
+        i_stoppingPids.erase(l_stopping);
+        closePidfd(p_pidfd);
+        return;
+    }
+
+    auto    l_moduleId = i_pidfdModuleIds.find(p_pidfd);
+
+    if (l_moduleId == i_pidfdModuleIds.end())
+    {
+        closePidfd(p_pidfd);
+        return;
+    }
+
+    WatchedModule   &l_watched = i_watchedModules[l_moduleId->second];
+    auto            l_now = std::chrono::steady_clock::now();
+    long long       l_upTime = std::chrono::duration_cast<std::chrono::milliseconds>(l_now - l_watched.startTime).count();
+
+    i_pidfdModuleIds.erase(l_moduleId);
+    closePidfd(p_pidfd);
+    l_watched.pidfd = -1;
+    i_sampler.remove(l_watched.module.id);
+
+    if (l_upTime >= RESTART_STABLE_TIME)
+        l_watched.restartDelay = RESTART_DELAY_MIN;
+
+    l_watched.isRestartPending = true;
+    l_watched.restartTime = l_now + std::chrono::milliseconds(l_watched.restartDelay);
+
+    bool    l_isSignaled = (l_info.si_code == CLD_KILLED || l_info.si_code == CLD_DUMPED);
+
+    i_log.log(LOG_ERR, "Observer::%s - module [%d] pid [%d] ended (%s %d) after %lld ms, restarted in %d ms",
+              __func__, l_watched.module.id, l_watched.pid,
+              l_isSignaled ? "signal" : "exit code", l_info.si_status, l_upTime, l_watched.restartDelay);
+
+    addEvent(l_watched, nlohmann::json{
+        {"event", "moduleExited"},
+        {"moduleId", l_watched.module.id},
+        {"pid", l_watched.pid},
+        {l_isSignaled ? "signal" : "exitCode", l_info.si_status},
+        {"upTime", l_upTime},
+        {"restartDelay", l_watched.restartDelay}
+    });
+
+    l_watched.restartDelay = std::min(l_watched.restartDelay * 2, RESTART_DELAY_MAX);
+}
+
+/**
+ * @brief
+ * Relaunch the modules whose restart delay is over
+ * the new pid is pushed in an ALERT event for the controller
+ *
+ * @return int ms until the next pending restart, -1 if none
+ */
+int                     Observer::restartModules(void)
+{
+    std::lock_guard<std::mutex>     l_lock(i_mutex);
+    auto                            l_now = std::chrono::steady_clock::now();
+    long long                       l_timeout = -1;
+
+    for (auto &l_entry : i_watchedModules)
+    {
+        WatchedModule   &l_watched = l_entry.second;
+
+        if (!l_watched.isRestartPending)
+            continue;
+
+        if (l_watched.restartTime > l_now)
+        {
+            long long l_wait = std::chrono::duration_cast<std::chrono::milliseconds>(l_watched.restartTime - l_now).count() + 1;
+
+            if (l_timeout < 0 || l_wait < l_timeout)
+                l_timeout = l_wait;
+            continue;
+        }
+
+        pid_t   l_pid = -1;
+
+        if (i_launcher.launchModule(l_watched.module, &l_pid) == ILauncher::eLaunchModule::FAILURE ||
+            (l_watched.pidfd = openPidfd(l_pid)) < 0)
+        {
+            // tried again after a longer delay
+            i_log.log(LOG_ERR, "Observer::%s - unable to restart module [%d]", __func__, l_watched.module.id);
+            l_watched.restartTime = l_now + std::chrono::milliseconds(l_watched.restartDelay);
+            l_watched.restartDelay = std::min(l_watched.restartDelay * 2, RESTART_DELAY_MAX);
+            if (l_timeout < 0 || l_watched.restartDelay < l_timeout)
+                l_timeout = l_watched.restartDelay;
+            continue;
+        }
+
+        l_watched.pid = l_pid;
+        l_watched.startTime = l_now;
+        l_watched.isRestartPending = false;
+        l_watched.isHung = false;
+        i_pidfdModuleIds[l_watched.pidfd] = l_watched.module.id;
+        i_sampler.add(l_watched.module.id, l_pid);
+
+        i_log.log(LOG_INFO, "Observer::%s - module [%d] restarted, pid [%d]", __func__, l_watched.module.id, l_pid);
+
+        addEvent(l_watched, nlohmann::json{
+            {"event", "moduleRestarted"},
+            {"moduleId", l_watched.module.id},
+            {"pid", l_pid}
+        });
+    }
+
+    return (int)l_timeout;
+}
+
+/**
+ * @brief
+ * Sample the cpu, the ram and the main thread timeslices of every module when i_samplePeriod is over
+ * (the /proc files stay open in i_sampler, one pass over all the modules)
+ *
+ * @return int ms until the next sample, -1 if there is no module
+ */
+int                     Observer::sampleModules(void)
+{
+    std::lock_guard<std::mutex>     l_lock(i_mutex);
+    auto                            l_now = std::chrono::steady_clock::now();
+
+    if (i_sampler.size() == 0)
+        return -1;
+
+    if (l_now >= i_nextSampleTime)
+    {
+        ModuleStatus    l_status;
+
+        i_sampler.sample(i_samples);
+        for (const ProcSample &l_sample : i_samples)
+        {
+            // the status page of a module is only memory reads
+            if (i_statusPages == nullptr || !i_statusPages->read(l_sample.moduleId, l_status))
+            {
+                addStatsEvent(l_sample, nullptr);
+                continue;
+            }
+            addStatsEvent(l_sample, &l_status);
+
+            auto    l_watched = i_watchedModules.find(l_sample.moduleId);
+            bool    l_isHung = l_status.state == MODULE_RUNNING && l_status.heartbeatAge > STATUS_HEARTBEAT_TIMEOUT;
+
+            if (l_watched == i_watchedModules.end() || l_watched->second.isHung == l_isHung)
+                continue;
+
+            // reported once when the heartbeat stops, once when it comes back
+            l_watched->second.isHung = l_isHung;
+            i_log.log(LOG_WARNING, "Observer::%s - module [%d] %s (heartbeat %lld ms ago)", __func__,
+                      l_sample.moduleId, l_isHung ? "hung" : "alive again", l_status.heartbeatAge);
+            addEvent(l_watched->second, nlohmann::json{
+                {"event", l_isHung ? "moduleHung" : "moduleAlive"},
+                {"moduleId", l_sample.moduleId},
+                {"pid", (int)l_sample.pid},
+                {"heartbeatAge", l_status.heartbeatAge}
+            });
+        }
+
+        // no burst of samples to catch up after a late wake up
+        i_nextSampleTime += std::chrono::milliseconds(i_samplePeriod);
+        if (i_nextSampleTime <= l_now)
+            i_nextSampleTime = l_now + std::chrono::milliseconds(i_samplePeriod);
+    }
+
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(i_nextSampleTime - l_now).count() + 1;
+}
+
+/**
+ * @brief
+ * Open the pidfd of a module and add it to the epoll set
+ * it becomes readable when the module ends (a module already ended is still a zombie, not missed)
+ *
+ * @param p_pid
+ * @return int the pidfd, -1 on failure
+ */
+int                     Observer::openPidfd(pid_t p_pid)
+{
+    if (i_epollfd < 0)
+        return -1;
+
+    int l_pidfd = (int)syscall(SYS_pidfd_open, p_pid, 0);
+
+    if (l_pidfd < 0)
+    {
+        i_log.log(LOG_ERR, "Observer::%s - pidfd_open [%d] : %s", __func__, p_pid, strerror(errno));
+        return -1;
+    }
+
+    struct epoll_event  l_event;
+
+    std::memset(&l_event, 0, sizeof(l_event));
+    l_event.events = EPOLLIN;
+    l_event.data.fd = l_pidfd;
+    if (epoll_ctl(i_epollfd, EPOLL_CTL_ADD, l_pidfd, &l_event) < 0)
+    {
+        i_log.log(LOG_ERR, "Observer::%s - epoll_ctl : %s", __func__, strerror(errno));
+        close(l_pidfd);
+        return -1;
+    }
+
+    return l_pidfd;
+}
+
+void                    Observer::closePidfd(int p_pidfd)
+{
+    epoll_ctl(i_epollfd, EPOLL_CTL_DEL, p_pidfd, nullptr);
+    close(p_pidfd);
+}
+
+/**
+ * @brief
+ * Push an event about a module in the i_eventList
+ *
+ * @param p_module
+ * @param p_json
+ */
+void                    Observer::addEvent(const WatchedModule &p_module, const nlohmann::json &p_json)
+{
+    if (i_eventList == nullptr)
+        return;
+
+    Event   l_newEvent;
+
+    l_newEvent.sourceID = p_module.module.id;
+    l_newEvent.sourceType = AGENT;
+    l_newEvent.cpuUsage = 0;
+    l_newEvent.ramUsage = 0;
+    l_newEvent.upTime = 0;
+    l_newEvent.eventPriority = ERROR;
+    l_newEvent.eventType = ALERT;
+    l_newEvent.sendingDate = 0;
+    l_newEvent.eventReceptionTime = std::time(nullptr);
+    l_newEvent.jsonData = EventPayload(p_json);
+
+    i_eventList->push(std::move(l_newEvent));
+}
+
+/**
+ * @brief
+ * Push the STATS event of a module sample, the json is formatted without nlohmann
+ * (one event per module every i_samplePeriod)
+ * with the status page of the module : "status": {"state", "heartbeatAge" (ms), "counters": [...]}
+ *
+ * @param p_sample
+ * @param p_status nullptr if the module has no status page
+ */
+void                    Observer::addStatsEvent(const ProcSample &p_sample, const ModuleStatus *p_status)
+{
+    if (i_eventList == nullptr)
+        return;
+
+    Event   l_newEvent;
+    char    l_json[512 + STATUS_PAGE_COUNTERS * 22];
+    int     l_length;
+
+    l_length = std::snprintf(l_json, sizeof(l_json),
+                             "{\"event\": \"moduleStats\", \"moduleId\": %d, \"pid\": %d, \"cpuTicks\": %llu, \"threads\": %ld, \"mainThreadTimeslices\": %llu",
+                             p_sample.moduleId, (int)p_sample.pid, p_sample.cpuTicks, p_sample.threadCount,
+                             p_sample.mainThreadTimeslices);
+
+    if (p_status != nullptr)
+    {
+        l_length += std::snprintf(l_json + l_length, sizeof(l_json) - l_length,
+                                  ", \"status\": {\"state\": %d, \"heartbeatAge\": %lld, \"counters\": [",
+                                  p_status->state, p_status->heartbeatAge);
+        for (u_int32_t i = 0; i < p_status->counterCount; i++)
+            l_length += std::snprintf(l_json + l_length, sizeof(l_json) - l_length, "%s%llu",
+                                      i ? ", " : "", (unsigned long long)p_status->counters[i]);
+        l_length += std::snprintf(l_json + l_length, sizeof(l_json) - l_length, "]}");
+    }
+    std::snprintf(l_json + l_length, sizeof(l_json) - l_length, "}");
+
+    l_newEvent.sourceID = p_sample.moduleId;
+    l_newEvent.sourceType = AGENT;
+    l_newEvent.cpuUsage = p_sample.cpuUsage;
+    l_newEvent.ramUsage = (int)p_sample.ramUsage;
+    l_newEvent.upTime = 0;
+    l_newEvent.eventPriority = DEFAULT_PRIORITY;
+    l_newEvent.eventType = STATS;
+    l_newEvent.sendingDate = 0;
+    l_newEvent.eventReceptionTime = std::time(nullptr);
+    l_newEvent.jsonData = EventPayload(std::string(l_json));
+
+    i_eventList->push(std::move(l_newEvent));
+}
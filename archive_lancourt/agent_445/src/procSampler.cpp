@@ -0,0 +1,287 @@
+#include "procSampler.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+/**
+ * @brief
+ * Read an unsigned decimal number and move p_cursor after it
+ *
+ * @return false if there is no digit
+ */
+static bool                         scanUnsigned(const char *&p_cursor, const char *p_end, unsigned long long *p_value)
+{
+    const char          *l_start = p_cursor;
+    unsigned long long  l_value = 0;
+
+    while (p_cursor < p_end && *p_cursor >= '0' && *p_cursor <= '9')
+        l_value = l_value * 10 + (unsigned long long)(*p_cursor++ - '0');
+
+    *p_value = l_value;
+    return p_cursor != l_start;
+}
+
+static bool                         scanSigned(const char *&p_cursor, const char *p_end, long *p_value)
+{
+    bool                l_isNegative = (p_cursor < p_end && *p_cursor == '-');
+    unsigned long long  l_value;
+
+    if (l_isNegative)
+        p_cursor++;
+    if (!scanUnsigned(p_cursor, p_end, &l_value))
+        return false;
+
+    *p_value = l_isNegative ? -(long)l_value : (long)l_value;
+    return true;
+}
+
+// skip p_count space separated fields
+static bool                         skipFields(const char *&p_cursor, const char *p_end, int p_count)
+{
+    for (int i = 0; i < p_count; i++)
+    {
+        while (p_cursor < p_end && *p_cursor != ' ')
+            p_cursor++;
+        if (p_cursor >= p_end)
+            return false;
+        p_cursor++;
+    }
+    return true;
+}
+
+static long long                    monotonicTime(void)
+{
+    struct timespec l_time;
+
+    clock_gettime(CLOCK_MONOTONIC, &l_time);
+    return (long long)l_time.tv_sec * 1000000000LL + l_time.tv_nsec;
+}
+
+ProcSampler::ProcSampler(void) : i_ticksPerSecond(sysconf(_SC_CLK_TCK)),
+                                 i_pageSizeKb(sysconf(_SC_PAGESIZE) / 1024),
+                                 i_schedstatInterval(PROC_SCHEDSTAT_INTERVAL),
+                                 i_sampleCount(0)
+{
+}
+
+ProcSampler::~ProcSampler(void)
+{
+    for (Entry &l_entry : i_entries)
+        closeEntry(l_entry);
+}
+
+/**
+ * @brief
+ * Open /proc/<pid>/stat and /proc/<pid>/schedstat, they are read again with pread at each sample
+ * the first sample of a module is taken here, so its next sample already has a delta
+ *
+ * @param p_moduleId
+ * @param p_pid
+ * @return false if /proc/<pid>/stat can not be opened (module already reaped)
+ */
+bool                                ProcSampler::add(int p_moduleId, pid_t p_pid)
+{
+    char    l_path[64];
+    Entry   l_entry;
+
+    remove(p_moduleId);
+
+    std::snprintf(l_path, sizeof(l_path), "/proc/%d/stat", (int)p_pid);
+    l_entry.statfd = open(l_path, O_RDONLY | O_CLOEXEC);
+    if (l_entry.statfd < 0)
+        return false;
+
+    l_entry.schedstatfd = -1;
+    if (i_schedstatInterval != 0)
+    {
+        std::snprintf(l_path, sizeof(l_path), "/proc/%d/schedstat", (int)p_pid);
+        l_entry.schedstatfd = open(l_path, O_RDONLY | O_CLOEXEC);
+    }
+
+    l_entry.moduleId = p_moduleId;
+    l_entry.pid = p_pid;
+    std::memset(&l_entry.last, 0, sizeof(l_entry.last));
+    l_entry.lastTime = monotonicTime();
+    readStat(l_entry, &l_entry.last, true);
+
+    i_entries.emplace_back(l_entry);
+    return true;
+}
+
+void                                ProcSampler::remove(int p_moduleId)
+{
+    for (size_t i = 0; i < i_entries.size(); i++)
+    {
+        if (i_entries[i].moduleId != p_moduleId)
+            continue;
+
+        // the order of the modules does not matter : the last one takes the place
+        closeEntry(i_entries[i]);
+        i_entries[i] = i_entries.back();
+        i_entries.pop_back();
+        return;
+    }
+}
+
+void                                ProcSampler::setSchedstatInterval(unsigned int p_interval)
+{
+    i_schedstatInterval = p_interval;
+}
+
+/**
+ * @brief
+ * Read every module in one pass, the cpu usage is the delta of the ticks
+ * over the time elapsed since the previous sample of the module
+ * /proc/<pid>/schedstat is only read once every i_schedstatInterval passes
+ *
+ * @param p_samples [out]
+ * @return size_t count of samples
+ */
+size_t                              ProcSampler::sample(std::vector<ProcSample> &p_samples)
+{
+    bool    l_withSchedstat = i_schedstatInterval != 0 && ++i_sampleCount % i_schedstatInterval == 0;
+
+    p_samples.clear();
+
+    for (Entry &l_entry : i_entries)
+    {
+        ProcStat    l_stat;
+
+        if (!readStat(l_entry, &l_stat, l_withSchedstat))
+            continue;
+
+        long long   l_now = monotonicTime();
+        long long   l_elapsed = l_now - l_entry.lastTime;
+        ProcSample  l_sample;
+
+        l_sample.moduleId = l_entry.moduleId;
+        l_sample.pid = l_entry.pid;
+        l_sample.cpuUsage = 0;
+        if (l_elapsed > 0)
+            l_sample.cpuUsage = (int)((l_stat.cpuTicks - l_entry.last.cpuTicks) * 100 * 1000000000ULL /
+                                      ((unsigned long long)i_ticksPerSecond * (unsigned long long)l_elapsed));
+        l_sample.ramUsage = l_stat.rssPages * i_pageSizeKb;
+        l_sample.threadCount = l_stat.threadCount;
+        l_sample.cpuTicks = l_stat.cpuTicks;
+        l_sample.mainThreadTimeslices = l_stat.timeslices;
+
+        p_samples.emplace_back(l_sample);
+
+        l_entry.last = l_stat;
+        l_entry.lastTime = l_now;
+    }
+
+    return p_samples.size();
+}
+
+size_t                              ProcSampler::size(void) const
+{
+    return i_entries.size();
+}
+
+/**
+ * @brief
+ * Scan "pid (comm) state ppid ... utime stime ... num_threads ... rss ..."
+ * the comm may contain spaces and parenthesis : the fields start after the last ')'
+ *
+ * @param p_buffer
+ * @param p_length
+ * @param p_stat [out] cpuTicks, threadCount and rssPages
+ * @return bool
+ */
+bool                                ProcSampler::parseStat(const char *p_buffer, size_t p_length, ProcStat *p_stat)
+{
+    const char          *l_end = p_buffer + p_length;
+    const char          *l_cursor = static_cast<const char *>(memrchr(p_buffer, ')', p_length));
+    unsigned long long  l_utime;
+    unsigned long long  l_stime;
+    unsigned long long  l_rss;
+
+    if (l_cursor == nullptr || l_end - l_cursor < 2)
+        return false;
+    l_cursor += 2; // ") " -> field 3 (state)
+
+    // field 14 utime, 15 stime
+    if (!skipFields(l_cursor, l_end, 11) ||
+        !scanUnsigned(l_cursor, l_end, &l_utime) ||
+        !skipFields(l_cursor, l_end, 1) ||
+        !scanUnsigned(l_cursor, l_end, &l_stime))
+        return false;
+
+    // field 20 num_threads
+    if (!skipFields(l_cursor, l_end, 5) ||
+        !scanSigned(l_cursor, l_end, &p_stat->threadCount))
+        return false;
+
+    // field 24 rss
+    if (!skipFields(l_cursor, l_end, 4) ||
+        !scanUnsigned(l_cursor, l_end, &l_rss))
+        return false;
+
+    p_stat->cpuTicks = l_utime + l_stime;
+    p_stat->rssPages = (long)l_rss;
+    return true;
+}
+
+/**
+ * @brief
+ * Scan "run_ns wait_ns timeslices"
+ *
+ * @param p_buffer
+ * @param p_length
+ * @param p_stat [out] runTime and timeslices
+ * @return bool
+ */
+bool                                ProcSampler::parseSchedstat(const char *p_buffer, size_t p_length, ProcStat *p_stat)
+{
+    const char  *l_cursor = p_buffer;
+    const char  *l_end = p_buffer + p_length;
+
+    return scanUnsigned(l_cursor, l_end, &p_stat->runTime) &&
+           skipFields(l_cursor, l_end, 2) &&
+           scanUnsigned(l_cursor, l_end, &p_stat->timeslices);
+}
+
+void                                ProcSampler::closeEntry(Entry &p_entry)
+{
+    if (p_entry.statfd >= 0)
+        close(p_entry.statfd);
+    if (p_entry.schedstatfd >= 0)
+        close(p_entry.schedstatfd);
+    p_entry.statfd = -1;
+    p_entry.schedstatfd = -1;
+}
+
+/**
+ * @brief
+ * pread the /proc files of a module into a stack buffer and scan them
+ * pread fails with ESRCH once the module is reaped
+ *
+ * @param p_entry
+ * @param p_stat [out]
+ * @param p_withSchedstat false : runTime and timeslices of the previous sample
+ * @return bool
+ */
+bool                                ProcSampler::readStat(Entry &p_entry, ProcStat *p_stat, bool p_withSchedstat)
+{
+    char    l_buffer[PROC_STAT_BUFFER_SIZE];
+    ssize_t l_length = pread(p_entry.statfd, l_buffer, sizeof(l_buffer), 0);
+
+    if (l_length <= 0 || !parseStat(l_buffer, (size_t)l_length, p_stat))
+        return false;
+
+    p_stat->runTime = p_entry.last.runTime;
+    p_stat->timeslices = p_entry.last.timeslices;
+    if (p_withSchedstat && p_entry.schedstatfd >= 0)
+    {
+        l_length = pread(p_entry.schedstatfd, l_buffer, sizeof(l_buffer), 0);
+        if (l_length > 0)
+            parseSchedstat(l_buffer, (size_t)l_length, p_stat);
+    }
+
+    return true;
+}
@@ -0,0 +1,47 @@
+#include "statsServer.hpp"
+
+/**
+ * @brief
+ * Construct a new Stats Server:: Stats Server object
+ *
+ * @param p_store
+ * @param p_log
+ */
+StatsServer::StatsServer(const StatsStore &p_store, ILog &p_log) : UnixSocketServer(p_log, "StatsServer", STATS_REQUEST_SIZE, STATS_REQUEST_TIMEOUT),
+                                                                   i_store(p_store)
+{
+}
+
+StatsServer::~StatsServer(void)
+{
+    stop();
+}
+
+/**
+ * @brief
+ * The answer is built when a client sends its request, nothing is done between two clients
+ * an empty request or a silent client gets the list of the sources
+ *
+ * @param p_request
+ * @return std::string
+ */
+std::string                         StatsServer::answer(const std::string &p_request)
+{
+    nlohmann::json  l_json;
+
+    if (p_request.find_first_not_of(" \t\r") == std::string::npos)
+        l_json = i_store.query(nlohmann::json::object());
+    else
+    {
+        try
+        {
+            l_json = i_store.query(nlohmann::json::parse(p_request));
+        }
+        catch (const std::exception &e)
+        {
+            l_json = { { "error", e.what() } };
+        }
+    }
+
+    return l_json.dump() + "\n";
+}
@@ -0,0 +1,406 @@
+#include "statsStore.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+// the numbers of the payload kept as metrics, after the fixed ones : the observer sample and its status page
+// (the counters of a capture : packets, pcap and ring drops...), moduleId or pid are not time series
+static const char   *g_metrics[STATS_FIXED_METRICS + 3] = { "cpuUsage", "ramUsage", "upTime",
+                                                            "threads", "mainThreadTimeslices", "status.heartbeatAge" };
+
+/**
+ * @brief
+ * Roll a bucket up with a new value, the bucket of an older period is reset first
+ *
+ * @param p_bucket
+ * @param p_start : start of the period of the value
+ * @param p_value
+ */
+static void                         rollUp(StatsBucket &p_bucket, int64_t p_start, double p_value)
+{
+    if (p_bucket.time != p_start || p_bucket.count == 0)
+    {
+        p_bucket.time = p_start;
+        p_bucket.min = p_value;
+        p_bucket.max = p_value;
+        p_bucket.sum = 0;
+        p_bucket.count = 0;
+    }
+    p_bucket.min = std::min(p_bucket.min, p_value);
+    p_bucket.max = std::max(p_bucket.max, p_value);
+    p_bucket.sum += p_value;
+    p_bucket.last = p_value;
+    p_bucket.count++;
+}
+
+/**
+ * @brief
+ * Buckets of a ring from p_since, oldest first
+ * a slot left by a period older than the ring (the source was silent) is skipped
+ *
+ * @param p_buckets
+ * @param p_slots
+ * @param p_period : s
+ * @param p_lastTime : last value recorded in the series
+ * @param p_since
+ * @param p_values
+ */
+static void                         bucketsToJson(const StatsBucket *p_buckets, size_t p_slots, int64_t p_period,
+                                                  int64_t p_lastTime, int64_t p_since, nlohmann::json &p_values)
+{
+    int64_t                             l_oldest = p_lastTime / p_period * p_period - (int64_t)(p_slots - 1) * p_period;
+    std::vector<const StatsBucket *>    l_buckets;
+
+    for (size_t i = 0; i < p_slots; i++)
+        if (p_buckets[i].count != 0 && p_buckets[i].time >= l_oldest && p_buckets[i].time + p_period > p_since)
+            l_buckets.emplace_back(&p_buckets[i]);
+    std::sort(l_buckets.begin(), l_buckets.end(),
+              [](const StatsBucket *p_first, const StatsBucket *p_second) { return p_first->time < p_second->time; });
+
+    for (const StatsBucket *l_bucket : l_buckets)
+        p_values.push_back({ l_bucket->time, l_bucket->min, l_bucket->max, l_bucket->sum / l_bucket->count,
+                             l_bucket->last, l_bucket->count });
+}
+
+/**
+ * @brief
+ * The value replaces the one of the same second, and is rolled up in the minute and the hour
+ * a slot is indexed by its period since the epoch, so a ring needs no head
+ *
+ * @param p_time : s
+ * @param p_value
+ */
+void                                StatsSeries::record(int64_t p_time, double p_value)
+{
+    StatsPoint  &l_point = seconds[p_time % STATS_SECOND_SLOTS];
+
+    l_point.time = p_time;
+    l_point.value = p_value;
+
+    rollUp(minutes[(p_time / 60) % STATS_MINUTE_SLOTS], p_time / 60 * 60, p_value);
+    rollUp(hours[(p_time / 3600) % STATS_HOUR_SLOTS], p_time / 3600 * 3600, p_value);
+}
+
+/**
+ * @brief
+ * Construct a new Stats Store:: Stats Store object
+ * nothing is allocated before the first source
+ *
+ * @param p_sourceCapacity
+ */
+StatsStore::StatsStore(size_t p_sourceCapacity) : i_capacity(p_sourceCapacity)
+{
+}
+
+bool                                StatsStore::init(size_t p_sourceCapacity)
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+
+    if (p_sourceCapacity == 0 || !i_sources.empty())
+        return false;
+    i_capacity = p_sourceCapacity;
+    return true;
+}
+
+/**
+ * @brief
+ * Allocate the series of a launched module, a source already recorded is kept with its history
+ * (a restarted module goes on with its series)
+ *
+ * @param p_sourceType
+ * @param p_sourceID
+ * @return bool : false if the store is full
+ */
+bool                                StatsStore::registerSource(e_sourceType p_sourceType, u_int32_t p_sourceID)
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+
+    return acquire(keyOf(p_sourceType, p_sourceID)) != nullptr;
+}
+
+/**
+ * @brief
+ * Release the series of a removed module, kept for the next source
+ *
+ * @param p_sourceType
+ * @param p_sourceID
+ */
+void                                StatsStore::unregisterSource(e_sourceType p_sourceType, u_int32_t p_sourceID)
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    auto                        l_source = i_sources.find(keyOf(p_sourceType, p_sourceID));
+
+    if (l_source == i_sources.end())
+        return;
+    i_freeSources.emplace_back(std::move(l_source->second));
+    i_sources.erase(l_source);
+}
+
+/**
+ * @brief
+ * Record the metrics of a STATS event at its reception time in the series of a registered source
+ * the payload metrics are the ones of g_metrics and the counters of "status" : "status.counters.<i>"
+ *
+ * @param p_sourceType
+ * @param p_sourceID
+ * @param p_event
+ * @return bool : false if the source is not registered
+ */
+bool                                StatsStore::record(e_sourceType p_sourceType, u_int32_t p_sourceID, const Event &p_event)
+{
+    int64_t                 l_time = p_event.eventReceptionTime > 0 ? (int64_t)p_event.eventReceptionTime : (int64_t)std::time(nullptr);
+    const nlohmann::json    *l_payload = nullptr;
+
+    // parsed before locking, the server does not wait for it
+    if (!p_event.jsonData.empty())
+    {
+        try
+        {
+            l_payload = &p_event.jsonData.json();
+        }
+        catch (const std::exception &e)
+        {
+            l_payload = nullptr;
+        }
+    }
+
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    auto                        l_found = i_sources.find(keyOf(p_sourceType, p_sourceID));
+
+    if (l_found == i_sources.end())
+        return false;
+
+    SourceSeries    &l_source = *l_found->second;
+
+    l_source.lastTime = std::max(l_source.lastTime, l_time);
+    recordMetric(l_source, 0, l_time, p_event.cpuUsage);
+    recordMetric(l_source, 1, l_time, p_event.ramUsage);
+    // the observer sends no upTime
+    if (p_event.upTime != 0)
+        recordMetric(l_source, 2, l_time, (double)p_event.upTime);
+
+    if (l_payload == nullptr || !l_payload->is_object())
+        return true;
+
+    for (size_t i = STATS_FIXED_METRICS; i < STATS_FIXED_METRICS + 2; i++)
+    {
+        auto l_field = l_payload->find(g_metrics[i]);
+
+        if (l_field != l_payload->end() && l_field->is_number())
+            recordMetric(l_source, i, l_time, l_field->get<double>());
+    }
+
+    auto l_status = l_payload->find("status");
+
+    if (l_status == l_payload->end() || !l_status->is_object())
+        return true;
+
+    auto l_heartbeatAge = l_status->find("heartbeatAge");
+    auto l_counters = l_status->find("counters");
+
+    if (l_heartbeatAge != l_status->end() && l_heartbeatAge->is_number())
+        recordMetric(l_source, STATS_FIXED_METRICS + 2, l_time, l_heartbeatAge->get<double>());
+    if (l_counters != l_status->end() && l_counters->is_array())
+        for (size_t i = 0; i < l_counters->size() && i < STATUS_PAGE_COUNTERS; i++)
+            if ((*l_counters)[i].is_number())
+                recordMetric(l_source, STATS_FIXED_METRICS + 3 + i, l_time, (*l_counters)[i].get<double>());
+    return true;
+}
+
+/**
+ * @brief
+ * Values of a metric since p_since
+ * STATS_SECOND : [time, value], STATS_MINUTE and STATS_HOUR : [time, min, max, avg, last, count], oldest first
+ *
+ * @param p_sourceType
+ * @param p_sourceID
+ * @param p_metric
+ * @param p_resolution
+ * @param p_since : s
+ * @param p_values : array filled
+ * @return bool : false if the source or the metric is unknown
+ */
+bool                                StatsStore::query(e_sourceType p_sourceType, u_int32_t p_sourceID, const std::string &p_metric,
+                                                      eStatsResolution p_resolution, int64_t p_since, nlohmann::json &p_values) const
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    auto                        l_source = i_sources.find(keyOf(p_sourceType, p_sourceID));
+
+    p_values = nlohmann::json::array();
+    if (l_source == i_sources.end())
+        return false;
+
+    int l_index = metricIndex(*l_source->second, p_metric);
+
+    if (l_index < 0)
+        return false;
+
+    const StatsSeries   &l_series = l_source->second->series[l_index];
+    int64_t             l_lastTime = l_source->second->lastTime;
+
+    if (p_resolution == STATS_MINUTE)
+        bucketsToJson(l_series.minutes, STATS_MINUTE_SLOTS, 60, l_lastTime, p_since, p_values);
+    else if (p_resolution == STATS_HOUR)
+        bucketsToJson(l_series.hours, STATS_HOUR_SLOTS, 3600, l_lastTime, p_since, p_values);
+    else
+    {
+        std::vector<const StatsPoint *> l_points;
+
+        for (size_t i = 0; i < STATS_SECOND_SLOTS; i++)
+            if (l_series.seconds[i].time > l_lastTime - STATS_SECOND_SLOTS && l_series.seconds[i].time >= p_since)
+                l_points.emplace_back(&l_series.seconds[i]);
+        std::sort(l_points.begin(), l_points.end(),
+                  [](const StatsPoint *p_first, const StatsPoint *p_second) { return p_first->time < p_second->time; });
+
+        for (const StatsPoint *l_point : l_points)
+            p_values.push_back({ l_point->time, l_point->value });
+    }
+    return true;
+}
+
+/**
+ * @brief
+ * Request of the StatsServer, the list of the sources without "metric"
+ * {"sourceType": 3, "sourceID": 1, "metric": "cpuUsage", "resolution": "1m", "since": 1700000000}
+ *
+ * @param p_request
+ * @return nlohmann::json : {"values": [...]} or {"error": "..."}
+ */
+nlohmann::json                      StatsStore::query(const nlohmann::json &p_request) const
+{
+    if (!p_request.is_object() || !p_request.count("metric"))
+        return { { "sources", sources() } };
+
+    try
+    {
+        std::string         l_resolution = p_request.count("resolution") ? p_request.at("resolution").get<std::string>() : "1s";
+        eStatsResolution    l_statsResolution;
+        nlohmann::json      l_values;
+
+        if (l_resolution == "1s")
+            l_statsResolution = STATS_SECOND;
+        else if (l_resolution == "1m")
+            l_statsResolution = STATS_MINUTE;
+        else if (l_resolution == "1h")
+            l_statsResolution = STATS_HOUR;
+        else
+            return { { "error", "resolution is 1s, 1m or 1h" } };
+
+        if (!query((e_sourceType)p_request.at("sourceType").get<int>(), p_request.at("sourceID").get<u_int32_t>(),
+                   p_request.at("metric").get<std::string>(), l_statsResolution,
+                   p_request.count("since") ? p_request.at("since").get<int64_t>() : 0, l_values))
+            return { { "error", "unknown source or metric" } };
+
+        return { { "resolution", l_resolution }, { "values", l_values } };
+    }
+    catch (const std::exception &e)
+    {
+        return { { "error", e.what() } };
+    }
+}
+
+nlohmann::json                      StatsStore::sources(void) const
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    nlohmann::json              l_sources = nlohmann::json::array();
+
+    for (const auto &l_source : i_sources)
+    {
+        nlohmann::json  l_metrics = nlohmann::json::array();
+
+        for (size_t i = 0; i < STATS_METRIC_COUNT; i++)
+            if (i < STATS_FIXED_METRICS || l_source.second->hasValues[i])
+                l_metrics.push_back(metricName(i));
+
+        l_sources.push_back({ { "sourceType", (int)(l_source.first >> 32) },
+                              { "sourceID", (u_int32_t)l_source.first },
+                              { "lastTime", l_source.second->lastTime },
+                              { "metrics", l_metrics } });
+    }
+    return l_sources;
+}
+
+size_t                              StatsStore::size(void) const
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+
+    return i_sources.size();
+}
+
+size_t                              StatsStore::capacity(void) const
+{
+    return i_capacity;
+}
+
+size_t                              StatsStore::sourceBytes(void)
+{
+    return sizeof(SourceSeries);
+}
+
+/**
+ * @brief
+ * Series of a source, i_mutex locked
+ * a new source takes a released block, or a new one while under capacity
+ *
+ * @param p_key
+ * @return SourceSeries* : nullptr if the store is full
+ */
+SourceSeries                        *StatsStore::acquire(u_int64_t p_key)
+{
+    auto                            l_found = i_sources.find(p_key);
+    std::unique_ptr<SourceSeries>   l_source;
+
+    if (l_found != i_sources.end())
+        return l_found->second.get();
+
+    if (!i_freeSources.empty())
+    {
+        l_source = std::move(i_freeSources.back());
+        i_freeSources.pop_back();
+    }
+    else if (i_sources.size() < i_capacity)
+        l_source.reset(new SourceSeries);
+    else
+        return nullptr;
+
+    std::memset(l_source.get(), 0, sizeof(SourceSeries));
+    l_source->key = p_key;
+
+    SourceSeries    *l_series = l_source.get();
+
+    i_sources[p_key] = std::move(l_source);
+    return l_series;
+}
+
+const std::string                   &StatsStore::metricName(size_t p_index)
+{
+    static const std::vector<std::string> l_names = []() {
+        std::vector<std::string> l_metricNames(g_metrics, g_metrics + STATS_FIXED_METRICS + 3);
+
+        for (size_t i = 0; i < STATUS_PAGE_COUNTERS; i++)
+            l_metricNames.emplace_back("status.counters." + std::to_string(i));
+        return l_metricNames;
+    }();
+
+    return l_names[p_index];
+}
+
+int                                 StatsStore::metricIndex(const SourceSeries &p_source, const std::string &p_name)
+{
+    for (size_t i = 0; i < STATS_METRIC_COUNT; i++)
+        if (metricName(i) == p_name)
+            return i < STATS_FIXED_METRICS || p_source.hasValues[i] ? (int)i : -1;
+    return -1;
+}
+
+void                                StatsStore::recordMetric(SourceSeries &p_source, size_t p_index, int64_t p_time, double p_value)
+{
+    p_source.hasValues[p_index] = true;
+    p_source.series[p_index].record(p_time, p_value);
+}
+
+u_int64_t                           StatsStore::keyOf(e_sourceType p_sourceType, u_int32_t p_sourceID)
+{
+    return ((u_int64_t)p_sourceType << 32) | p_sourceID;
+}
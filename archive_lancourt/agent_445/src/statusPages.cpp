@@ -0,0 +1,158 @@
+#include "statusPages.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <ctime>
+
+static_assert(sizeof(StatusPage) <= STATUS_PAGE_SIZE, "the status page does not fit in STATUS_PAGE_SIZE");
+
+StatusPages::StatusPages(void)
+{
+}
+
+StatusPages::~StatusPages(void)
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+
+    for (auto &l_page : i_pages)
+    {
+        munmap(l_page.second, STATUS_PAGE_SIZE);
+        shm_unlink(pageName(l_page.first).c_str());
+    }
+    i_pages.clear();
+}
+
+/**
+ * @brief
+ * Create the page of a module before its launch, the page of a restarted module is reset :
+ * its previous writer ended, it may have left the sequence odd
+ *
+ * @param p_moduleId
+ * @param p_name [out] name of the page, given to the module in STATUS_PAGE_ENV
+ * @return bool
+ */
+bool                                StatusPages::create(int p_moduleId, std::string &p_name)
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    auto                        l_existing = i_pages.find(p_moduleId);
+    StatusPage                  *l_page;
+
+    p_name = pageName(p_moduleId);
+
+    if (l_existing != i_pages.end())
+        l_page = l_existing->second;
+    else
+    {
+        int     l_fd = shm_open(p_name.c_str(), O_CREAT | O_RDWR | O_TRUNC | O_CLOEXEC, 0600);
+        void    *l_address;
+
+        if (l_fd < 0)
+            return false;
+        if (ftruncate(l_fd, STATUS_PAGE_SIZE) < 0)
+        {
+            close(l_fd);
+            shm_unlink(p_name.c_str());
+            return false;
+        }
+        l_address = mmap(nullptr, STATUS_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, l_fd, 0);
+        close(l_fd);
+        if (l_address == MAP_FAILED)
+        {
+            shm_unlink(p_name.c_str());
+            return false;
+        }
+        l_page = static_cast<StatusPage *>(l_address);
+        i_pages[p_moduleId] = l_page;
+    }
+
+    std::memset(l_page, 0, sizeof(StatusPage));
+    l_page->version = STATUS_PAGE_VERSION;
+    l_page->moduleId = p_moduleId;
+    l_page->state = MODULE_STARTING;
+    // the magic last : a module mapping the page sees a complete header
+    __atomic_store_n(&l_page->magic, (u_int32_t)STATUS_PAGE_MAGIC, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+void                                StatusPages::remove(int p_moduleId)
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    auto                        l_page = i_pages.find(p_moduleId);
+
+    if (l_page == i_pages.end())
+        return;
+
+    munmap(l_page->second, STATUS_PAGE_SIZE);
+    shm_unlink(pageName(p_moduleId).c_str());
+    i_pages.erase(l_page);
+}
+
+bool                                StatusPages::read(int p_moduleId, ModuleStatus &p_status)
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    auto                        l_page = i_pages.find(p_moduleId);
+
+    if (l_page == i_pages.end())
+        return false;
+    return readPage(l_page->second, p_status);
+}
+
+size_t                              StatusPages::size(void)
+{
+    std::lock_guard<std::mutex> l_lock(i_mutex);
+    return i_pages.size();
+}
+
+std::string                         StatusPages::pageName(int p_moduleId)
+{
+    return "/agent." + std::to_string(getpid()) + ".status." + std::to_string(p_moduleId);
+}
+
+/**
+ * @brief
+ * Copy a page between two reads of an even and unchanged sequence (seqlock),
+ * retried STATUS_PAGE_READ_ATTEMPTS times : the reader never waits for the module
+ * clock_gettime goes through the vdso, no system call
+ *
+ * @param p_page
+ * @param p_status [out]
+ * @return bool
+ */
+bool                                StatusPages::readPage(const StatusPage *p_page, ModuleStatus &p_status)
+{
+    for (int l_attempt = 0; l_attempt < STATUS_PAGE_READ_ATTEMPTS; l_attempt++)
+    {
+        u_int32_t   l_sequence = __atomic_load_n(&p_page->sequence, __ATOMIC_ACQUIRE);
+        u_int64_t   l_heartbeat;
+
+        if (l_sequence & 1)
+            continue;
+
+        p_status.moduleId = p_page->moduleId;
+        p_status.pid = __atomic_load_n(&p_page->pid, __ATOMIC_RELAXED);
+        p_status.state = (int)__atomic_load_n(&p_page->state, __ATOMIC_RELAXED);
+        l_heartbeat = __atomic_load_n(&p_page->heartbeat, __ATOMIC_RELAXED);
+        p_status.counterCount = __atomic_load_n(&p_page->counterCount, __ATOMIC_RELAXED);
+        if (p_status.counterCount > STATUS_PAGE_COUNTERS)
+            p_status.counterCount = STATUS_PAGE_COUNTERS;
+        for (u_int32_t i = 0; i < p_status.counterCount; i++)
+            p_status.counters[i] = __atomic_load_n(&p_page->counters[i], __ATOMIC_RELAXED);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&p_page->sequence, __ATOMIC_RELAXED) != l_sequence)
+            continue;
+
+        struct timespec l_now;
+
+        clock_gettime(CLOCK_MONOTONIC, &l_now);
+        p_status.heartbeatAge = -1;
+        if (l_heartbeat != 0)
+            p_status.heartbeatAge = ((long long)l_now.tv_sec * 1000000000LL + l_now.tv_nsec - (long long)l_heartbeat) / 1000000;
+        return true;
+    }
+    return false;
+}
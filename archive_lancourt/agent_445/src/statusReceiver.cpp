@@ -6,6 +6,9 @@
 using json = nlohmann::json;
 
 #include "commonTools.hpp"
+#include "asyncLog.hpp"
+
+#include <sys/eventfd.h>
 
 /**
  * @brief
@@ -14,12 +17,26 @@ using json = nlohmann::json;
  * @param p_netconfServer 
  * @param p_log 
  */
-StatusReceiver::StatusReceiver(std::priority_queue<Event, std::vector<Event>, compareEventPriority> *p_eventList,
+StatusReceiver::StatusReceiver(EventQueue *p_eventList,
                                ILog & p_log) : i_eventList(p_eventList),
                                                i_log(p_log)
 {
     i_isRunning = false;
     i_isUdpSocketClosed = true;
+    i_stopEventfd = -1;
+
+    i_receiveBuffers.resize(RECEIVE_BATCH * BUFFER_LEN);
+    i_receiveIovecs.resize(RECEIVE_BATCH);
+    i_receiveMessages.resize(RECEIVE_BATCH);
+
+    i_logLevel = LOG_INFO;
+
+    google::protobuf::ArenaOptions  l_arenaOptions;
+
+    i_arenaBlock.resize(ARENA_BLOCK_SIZE);
+    l_arenaOptions.initial_block = i_arenaBlock.data();
+    l_arenaOptions.initial_block_size = i_arenaBlock.size();
+    i_arena = new google::protobuf::Arena(l_arenaOptions);
     i_log.log(LOG_DEBUG, "StatusReceiver::%s", __func__);
 }
 
@@ -32,6 +49,8 @@ StatusReceiver::~StatusReceiver()
 {
     i_log.log(LOG_INFO, "StatusReceiver::%s", __func__);
 
+    delete i_arena;
+
     // keep comment if needing it later
     // i_log.log(LOG_DEBUG, "go stop(SIGTERM)");
     // stop(SIGTERM);
@@ -51,6 +70,7 @@ IStatusReceiver::eInit                     StatusReceiver::init(const nlohmann::
 
     std::string l_protobufHost;
     int         l_protobufPort;
+    int         l_receiveBufferSize = 0;
 
     try
     {
@@ -63,6 +83,14 @@ IStatusReceiver::eInit                     StatusReceiver::init(const nlohmann::
         return IStatusReceiver::eInit::FAILURE;
     }
 
+    // optional : kernel buffer of the socket, absorbs the bursts of stats of every module at each tick
+    if (p_configInitializer.count("protobuf_receiveBufferSize"))
+        getJsonParameter(l_receiveBufferSize, p_configInitializer, "protobuf_receiveBufferSize");
+
+    // optional : syslog level (LOG_DEBUG == 7 dumps every notification received)
+    if (p_configInitializer.count("logLevel"))
+        getJsonParameter(i_logLevel, p_configInitializer, "logLevel");
+
     // UDP
     if ((i_udpSocketfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
     {
@@ -74,6 +102,12 @@ IStatusReceiver::eInit                     StatusReceiver::init(const nlohmann::
     i_serverSocketAddress.sin_port          =   htons(l_protobufPort);
     i_serverSocketAddress.sin_family        =   AF_INET;
 
+    // SO_RCVBUFFORCE goes over net.core.rmem_max (the agent runs as root), SO_RCVBUF otherwise
+    if (l_receiveBufferSize > 0 &&
+        setsockopt(i_udpSocketfd, SOL_SOCKET, SO_RCVBUFFORCE, &l_receiveBufferSize, sizeof(l_receiveBufferSize)) != 0 &&
+        setsockopt(i_udpSocketfd, SOL_SOCKET, SO_RCVBUF, &l_receiveBufferSize, sizeof(l_receiveBufferSize)) != 0)
+        i_log.log(LOG_WARNING, "StatusReceiver::%s - unable to set the receive buffer size [%d]", __func__, l_receiveBufferSize);
+
     int bindResult;
     
     // man bind --> on success, 0 is returned
@@ -103,6 +137,12 @@ StatusReceiver::eStart                      StatusReceiver::start()
 {
     i_log.log(LOG_INFO, "StatusReceiver::%s", __func__);
 
+    if ((i_stopEventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0)
+    {
+        i_log.log(LOG_ERR, "StatusReceiver::%s - eventfd failed !", __func__);
+        return eStart::FAILURE;
+    }
+
     i_protobufThread = std::thread(&StatusReceiver::receiveProtobuf, this);
 
     if (!i_protobufThread.joinable())
@@ -119,68 +159,154 @@ StatusReceiver::eStart                      StatusReceiver::start()
  * @brief ReceiverProtobuf
  * wait on the network for receive a message on protocol protobuf
  * add a new event in the eventList when receiving a message
+ * the thread sleeps in epoll_wait until datagrams arrive or stop is called,
+ * then drains the socket by batches of RECEIVE_BATCH datagrams
  * 
  */
 void                                        StatusReceiver::receiveProtobuf()
 {
-
     i_log.log(LOG_INFO, "Receiver::%s - ThreadID [%i]", __func__, std::this_thread::get_id());
 
-    char                l_buffer[BUFFER_LEN];
-    ssize_t             l_bytesReceived = 0;
-    socklen_t           l_serverAddressLen = sizeof(i_serverSocketAddress);
-    Event               l_newEvent;
-    Notifications       l_notifications;
-    
+    int                 l_epollfd;
+    epoll_event         l_event;
+    epoll_event         l_readyEvents[2];
+    int                 l_readyCount;
+
+    if ((l_epollfd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+    {
+        i_log.log(LOG_ERR, "StatusReceiver::%s - epoll_create1 failed !", __func__);
+        return;
+    }
+
+    l_event.events = EPOLLIN;
+    l_event.data.fd = i_udpSocketfd;
+    if (epoll_ctl(l_epollfd, EPOLL_CTL_ADD, i_udpSocketfd, &l_event) != 0)
+    {
+        i_log.log(LOG_ERR, "StatusReceiver::%s - epoll_ctl on the udp socket failed !", __func__);
+        close(l_epollfd);
+        return;
+    }
+
+    l_event.events = EPOLLIN;
+    l_event.data.fd = i_stopEventfd;
+    if (epoll_ctl(l_epollfd, EPOLL_CTL_ADD, i_stopEventfd, &l_event) != 0)
+    {
+        i_log.log(LOG_ERR, "StatusReceiver::%s - epoll_ctl on the stop eventfd failed !", __func__);
+        close(l_epollfd);
+        return;
+    }
 
     while (i_isRunning)
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        l_readyCount = epoll_wait(l_epollfd, l_readyEvents, 2, -1);
 
-        l_bytesReceived = recvfrom(i_udpSocketfd, l_buffer, 2000, MSG_DONTWAIT, reinterpret_cast<sockaddr *>(&i_serverSocketAddress), &l_serverAddressLen);
+        if (l_readyCount < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            i_log.log(LOG_ERR, "StatusReceiver::%s - epoll_wait failed !", __func__);
+            break;
+        }
 
-        if (l_bytesReceived == -1)
+        for (int i = 0; i < l_readyCount; i++)
         {
-            i_log.log(LOG_DEBUG, "No notifications received on protobuf server ...");
-            continue;
+            if (l_readyEvents[i].data.fd == i_udpSocketfd)
+                while (receiveBatch() == RECEIVE_BATCH)
+                    ; // the socket may hold more datagrams
         }
+    }
+
+    close(l_epollfd);
+}
 
-        l_buffer[l_bytesReceived] = '\0'; // probably useless
+/**
+ * @brief
+ * Read up to RECEIVE_BATCH datagrams with one recvmmsg in the preallocated buffers
+ * and add an event for each of them
+ * 
+ * @return int number of datagrams read, 0 when the socket is empty
+ */
+int                                         StatusReceiver::receiveBatch(void)
+{
+    int                 l_received;
 
-        if (l_bytesReceived != 0)
+    for (int i = 0; i < RECEIVE_BATCH; i++)
+    {
+        i_receiveIovecs[i].iov_base = &i_receiveBuffers[i * BUFFER_LEN];
+        i_receiveIovecs[i].iov_len = BUFFER_LEN;
+        i_receiveMessages[i].msg_hdr.msg_name = nullptr;
+        i_receiveMessages[i].msg_hdr.msg_namelen = 0;
+        i_receiveMessages[i].msg_hdr.msg_iov = &i_receiveIovecs[i];
+        i_receiveMessages[i].msg_hdr.msg_iovlen = 1;
+        i_receiveMessages[i].msg_hdr.msg_control = nullptr;
+        i_receiveMessages[i].msg_hdr.msg_controllen = 0;
+        i_receiveMessages[i].msg_hdr.msg_flags = 0;
+    }
+
+    l_received = recvmmsg(i_udpSocketfd, i_receiveMessages.data(), RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+
+    if (l_received < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            i_log.log(LOG_ERR, "StatusReceiver::%s - recvmmsg failed [%s]", __func__, strerror(errno));
+        return 0;
+    }
+
+    for (int i = 0; i < l_received; i++)
+    {
+        if (i_receiveMessages[i].msg_hdr.msg_flags & MSG_TRUNC)
         {
+            i_log.log(LOG_ERR, "StatusReceiver::%s - notification bigger than %d bytes dropped", __func__, BUFFER_LEN);
+            continue;
+        }
+        processDatagram(&i_receiveBuffers[i * BUFFER_LEN], i_receiveMessages[i].msg_len);
+    }
+
+    // the notifications of the batch are no longer needed, the initial block is kept
+    i_arena->Reset();
+
+    return l_received;
+}
+
+/**
+ * @brief
+ * Parse a datagram as a protobuf Notifications and add its event
+ * 
+ * @param p_datagram 
+ * @param p_length 
+ */
+void                                        StatusReceiver::processDatagram(const char *p_datagram, size_t p_length)
+{
+    if (p_length == 0)
+        return;
 
-            std::cout << "Bytes received !" << std::endl << std::endl;
-            i_log.log(LOG_INFO, "%s : statusReceiver bytes received from protobuf reception ---------------------> bytesReceived [%zd]", __func__, l_bytesReceived);
-            l_notifications.PrintDebugString();
+    // parsed straight from the reception buffer, allocated in the arena of the batch
+    Notifications       *l_notifications = google::protobuf::Arena::CreateMessage<Notifications>(i_arena);
 
-            if (l_notifications.ParseFromString(std::string(l_buffer, 0, l_bytesReceived))) // debug
+    if (l_notifications->ParseFromArray(p_datagram, p_length))
+    {
+        if (i_logLevel >= LOG_DEBUG)
+            AGENT_LOG(i_log, LOG_DEBUG, "%s : bytesReceived [%zu] [%s]", __func__, p_length, l_notifications->ShortDebugString().c_str());
+
+        if (l_notifications->IsInitialized())
+        {
+            try
             {
-                std::cout << l_notifications.DebugString().c_str() << std::endl;
-                i_log.log(LOG_INFO, "[%s]", l_notifications.DebugString().c_str());
-                if (l_notifications.IsInitialized())
-                {
-                    // keep it temporary for debugging
-                    /*
-                    std::cout << "print stats : " << std::endl;
-                    l_notifications.stats().PrintDebugString();
-
-                    std::cout << std::endl << "print cpu" << std::endl;
-                    std::cout << l_notifications.stats().cpuusage() << std::endl;
-                    */
-
-                    addEvent(l_notifications);  // A REMETTRE
-                }
-                else
-                {
-                    i_log.log(LOG_ERR, "Error : i_notifications structure not initialized !");
-                }
+                addEvent(*l_notifications);
             }
-            else
+            catch (const std::exception &e)
             {
-                i_log.log(LOG_ERR, "Error on parsing protobuf message");
+                i_log.log(LOG_ERR, "StatusReceiver::%s - invalid notification from source [%u] : %s", __func__, l_notifications->sourceid(), e.what());
             }
         }
+        else
+        {
+            i_log.log(LOG_ERR, "Error : i_notifications structure not initialized !");
+        }
+    }
+    else
+    {
+        i_log.log(LOG_ERR, "Error on parsing protobuf message");
     }
 }
 
@@ -196,16 +322,11 @@ StatusReceiver::eStop                       StatusReceiver::stop(int p_sigNum)
     i_log.log(LOG_INFO, "StatusReceiver::%s [%i]", __func__, p_sigNum);
 
     i_isRunning = false;
-    
-    i_log.log(LOG_DEBUG, "--------------- BEFORE closing the socket");
-    i_log.log(LOG_DEBUG, "Socket still open");
 
-    if (i_isUdpSocketClosed == false)
+    // wake up the receiving thread waiting in epoll_wait
+    if (i_stopEventfd >= 0)
     {
-        i_log.log(LOG_DEBUG, "close the socket");
-        close(i_udpSocketfd);
-        i_isUdpSocketClosed = true;
-        i_log.log(LOG_DEBUG, "Socket closed");
+        eventfd_write(i_stopEventfd, 1);
     }
 
     i_log.log(LOG_DEBUG, "Joining i_protobufThread");
@@ -214,7 +335,19 @@ StatusReceiver::eStop                       StatusReceiver::stop(int p_sigNum)
 		i_protobufThread.join();
 	}
 
-    i_log.log(LOG_DEBUG, "xxxxxxxxxxxxxxx");
+    if (i_stopEventfd >= 0)
+    {
+        close(i_stopEventfd);
+        i_stopEventfd = -1;
+    }
+
+    if (i_isUdpSocketClosed == false)
+    {
+        i_log.log(LOG_DEBUG, "close the socket");
+        close(i_udpSocketfd);
+        i_isUdpSocketClosed = true;
+        i_log.log(LOG_DEBUG, "Socket closed");
+    }
 
 	// todo : see if later an error management more precise with a return failure will be needed
 	// if not remove the return success and put the method with a void return
@@ -228,20 +361,18 @@ StatusReceiver::eStop                       StatusReceiver::stop(int p_sigNum)
  * @param p_json 
  * @return StatusReceiver::eAddEvent 
  */
-StatusReceiver::eAddEvent                   StatusReceiver::addEvent(Notifications p_notifications)
+StatusReceiver::eAddEvent                   StatusReceiver::addEvent(const Notifications &p_notifications)
 {
-    i_log.log(LOG_INFO, "StatusReceiver::%s ", __func__);
-
     Event         l_newEvent;
 
     l_newEvent.sourceID = p_notifications.sourceid();
 
     l_newEvent.sourceType = (e_sourceType)p_notifications.sourcetype();
 
-    std::cout << "XXXXXXXXXXXXXXXXXXXXXXXXX" << p_notifications.cpuusage() << std::endl;
-    l_newEvent.cpuUsage = std::stoi(p_notifications.cpuusage());
+    // strtol rather than std::stoi : no exception on an empty field
+    l_newEvent.cpuUsage = std::strtol(p_notifications.cpuusage().c_str(), nullptr, 10);
 
-    l_newEvent.ramUsage = std::stoi(p_notifications.ramusage());
+    l_newEvent.ramUsage = std::strtol(p_notifications.ramusage().c_str(), nullptr, 10);
 
     l_newEvent.upTime = p_notifications.uptime();
 
@@ -254,11 +385,10 @@ StatusReceiver::eAddEvent                   StatusReceiver::addEvent(Notificatio
     l_newEvent.eventReceptionTime = std::time(nullptr);
 
 
-    std::string l_tmp = p_notifications.message();
-    l_newEvent.jsonData = nlohmann::json::parse(l_tmp);
+    // kept raw, parsed only if the event is read (most of the STATS are not)
+    l_newEvent.jsonData = EventPayload(p_notifications.message());
 
-    std::lock_guard<std::mutex> l_mutexGetEvent(i_eventMutex);
-    i_eventList->push(l_newEvent);
+    i_eventList->push(std::move(l_newEvent));
 
     return (eAddEvent::SUCCESS);
 }
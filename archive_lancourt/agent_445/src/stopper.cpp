@@ -1,9 +1,30 @@
-
 #include "stopper.hpp"
 
 #include "iLog.hpp"
 
-Stopper::Stopper(ILog &p_log) : i_log(p_log)
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <poll.h>
+
+#include <cerrno>
+#include <cstring>
+
+#ifndef SYS_pidfd_open
+# define SYS_pidfd_open 434
+#endif
+
+#ifndef SYS_pidfd_send_signal
+# define SYS_pidfd_send_signal 424
+#endif
+
+/**
+ * @brief Construct a new Stopper:: Stopper object
+ * 
+ * @param p_log 
+ * @param p_deadline ms between the SIGTERM and the SIGKILL of a module
+ */
+Stopper::Stopper(ILog &p_log, int p_deadline) : i_log(p_log),
+                                                i_deadline(p_deadline)
 {
     i_log.log(LOG_INFO, "Stopper::%s", __func__);
 }
@@ -28,24 +49,183 @@ IStopper::eInit            Stopper::init(void) // maybe useless
 
 /**
  * @brief
- * Kill a pid with the SIGTERM (15) signal 
+ * Stop every module at once : SIGTERM to all of them, then wait on their pidfds together
+ * a module still running after the deadline gets a SIGKILL
+ * a supervised module comes with the pidfd of the observer (a dup), which reaps it :
+ * the pidfd designates the module even once reaped, a pid reused meanwhile is never signaled
+ * a module without pidfd (not supervised) gets one opened here, and is reaped here
  * 
- * @param p_modulePidList 
- * @return IStopper::eStopPid 
+ * @param p_moduleProcessList 
+ * @return IStopper::eStopModule FAILURE if a module could not be signaled or survived its SIGKILL
  */
-IStopper::eStopModule             Stopper::stopModule(std::list<pid_t> p_modulePidList)
+IStopper::eStopModule             Stopper::stopModule(std::list<ModuleProcess> p_moduleProcessList)
 {
     i_log.log(LOG_INFO, "Stopper::%s", __func__);
 
-    // #stackOverFlowTricks : "if you have no intention to wait for the child process ... 
-    // set the SIGCHLD handler to SIG_IGN to have the kernel automatically reap the children"
-    signal(SIGCHLD, SIG_IGN); // avoid zombies programs (#stackOverFlow tricks)
-     
-    for (pid_t l_modulePid : p_modulePidList)
+    std::vector<StopTarget>                 l_targets;
+    std::chrono::steady_clock::time_point   l_start = std::chrono::steady_clock::now();
+    IStopper::eStopModule                   l_result = IStopper::eStopModule::SUCCESS;
+
+    l_targets.reserve(p_moduleProcessList.size());
+    for (const ModuleProcess &l_moduleProcess : p_moduleProcessList)
+    {
+        StopTarget  l_target;
+
+        l_target.pid = l_moduleProcess.pid;
+        l_target.pidfd = l_moduleProcess.pidfd;
+        l_target.isReaped = (l_moduleProcess.pidfd < 0);
+        if (l_target.isReaped)
+            l_target.pidfd = (int)syscall(SYS_pidfd_open, l_moduleProcess.pid, 0);
+        l_target.isEnded = false;
+        l_target.isKilled = false;
+
+        if (sendSignal(l_target, SIGTERM) != 0)
+        {
+            i_log.log(LOG_ERR, "Stopper::%s - unable to stop pid [%d] : %s", __func__, l_target.pid, strerror(errno));
+            l_target.isEnded = true;
+            l_target.endTime = l_start;
+            l_result = IStopper::eStopModule::FAILURE;
+        }
+        l_targets.emplace_back(l_target);
+    }
+
+    waitTargets(l_targets, l_start + i_deadline);
+
+    // escalation : every module still running gets its SIGKILL at the same time
+    bool l_hasKilled = false;
+
+    for (StopTarget &l_target : l_targets)
     {
-        if (kill(l_modulePid, SIGTERM))
-            return IStopper::eStopModule::FAILURE;
+        if (l_target.isEnded)
+            continue;
+        i_log.log(LOG_WARNING, "Stopper::%s - pid [%d] still running after %lld ms, SIGKILL",
+                  __func__, l_target.pid, (long long)i_deadline.count());
+        sendSignal(l_target, SIGKILL);
+        l_target.isKilled = true;
+        l_hasKilled = true;
     }
 
-    return IStopper::eStopModule::SUCCESS;
-}
\ No newline at end of file
+    if (l_hasKilled)
+        waitTargets(l_targets, std::chrono::steady_clock::now() + std::chrono::milliseconds(STOP_KILL_DEADLINE));
+
+    for (StopTarget &l_target : l_targets)
+    {
+        if (!l_target.isEnded)
+        {
+            i_log.log(LOG_ERR, "Stopper::%s - pid [%d] still running after its SIGKILL", __func__, l_target.pid);
+            l_result = IStopper::eStopModule::FAILURE;
+        }
+        else
+        {
+            i_log.log(LOG_INFO, "Stopper::%s - pid [%d] stopped in %lld ms%s", __func__, l_target.pid,
+                      (long long)std::chrono::duration_cast<std::chrono::milliseconds>(l_target.endTime - l_start).count(),
+                      l_target.isKilled ? " (SIGKILL)" : "");
+        }
+
+        // the pidfd said it ended : a zombie left to nobody otherwise
+        if (l_target.isReaped && l_target.isEnded && l_target.pidfd >= 0)
+            waitpid(l_target.pid, nullptr, WNOHANG);
+        if (l_target.pidfd >= 0)
+            close(l_target.pidfd);
+    }
+
+    return l_result;
+}
+
+int                                 Stopper::sendSignal(const StopTarget &p_target, int p_sigNum)
+{
+    if (p_target.pidfd >= 0)
+        return (int)syscall(SYS_pidfd_send_signal, p_target.pidfd, p_sigNum, nullptr, 0);
+    return kill(p_target.pid, p_sigNum);
+}
+
+/**
+ * @brief
+ * Without pidfd, a module which ended is a zombie still answering kill(pid, 0) until it is reaped :
+ * a child of the agent is reaped here (nobody else waits for it), an other pid is ended once it is gone
+ *
+ * @param p_target
+ * @return true the module ended
+ */
+bool                                Stopper::isPidlessEnded(const StopTarget &p_target)
+{
+    pid_t   l_pid = waitpid(p_target.pid, nullptr, WNOHANG);
+
+    if (l_pid == p_target.pid)
+        return true;
+    return l_pid < 0 && kill(p_target.pid, 0) != 0 && errno == ESRCH;
+}
+
+/**
+ * @brief
+ * poll the pidfds of the modules still running, a pidfd becomes readable when its module ends
+ * a module without pidfd is checked with isPidlessEnded every 10 ms
+ * 
+ * @param p_targets 
+ * @param p_deadline 
+ */
+void                                Stopper::waitTargets(std::vector<StopTarget> &p_targets,
+                                                         std::chrono::steady_clock::time_point p_deadline)
+{
+    std::vector<struct pollfd>  l_pollfds;
+    std::vector<StopTarget *>   l_polled;
+
+    for (;;)
+    {
+        bool    l_hasPidless = false;
+
+        l_pollfds.clear();
+        l_polled.clear();
+        for (StopTarget &l_target : p_targets)
+        {
+            if (l_target.isEnded)
+                continue;
+            if (l_target.pidfd < 0)
+            {
+                if (isPidlessEnded(l_target))
+                {
+                    l_target.isEnded = true;
+                    l_target.endTime = std::chrono::steady_clock::now();
+                    continue;
+                }
+                l_hasPidless = true;
+                continue;
+            }
+
+            struct pollfd l_pollfd;
+
+            l_pollfd.fd = l_target.pidfd;
+            l_pollfd.events = POLLIN;
+            l_pollfd.revents = 0;
+            l_pollfds.emplace_back(l_pollfd);
+            l_polled.emplace_back(&l_target);
+        }
+
+        auto l_now = std::chrono::steady_clock::now();
+
+        if ((l_pollfds.empty() && !l_hasPidless) || l_now >= p_deadline)
+            return;
+
+        long long l_timeout = std::chrono::duration_cast<std::chrono::milliseconds>(p_deadline - l_now).count() + 1;
+
+        if (l_hasPidless && l_timeout > 10)
+            l_timeout = 10;
+
+        int l_readyCount = poll(l_pollfds.data(), l_pollfds.size(), (int)l_timeout);
+
+        if (l_readyCount < 0 && errno != EINTR)
+        {
+            i_log.log(LOG_ERR, "Stopper::%s - poll : %s", __func__, strerror(errno));
+            return;
+        }
+
+        l_now = std::chrono::steady_clock::now();
+        for (size_t i = 0; l_readyCount > 0 && i < l_pollfds.size(); i++)
+        {
+            if (l_pollfds[i].revents == 0)
+                continue;
+            l_polled[i]->isEnded = true;
+            l_polled[i]->endTime = l_now;
+        }
+    }
+}
@@ -0,0 +1,200 @@
+#include "unixSocketServer.hpp"
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief
+ * Construct a new Unix Socket Server:: Unix Socket Server object
+ *
+ * @param p_log
+ * @param p_name class of the server, in the logs
+ * @param p_requestSize longest request, 0 : the clients send nothing
+ * @param p_timeout ms to read the request and to send the answer
+ */
+UnixSocketServer::UnixSocketServer(ILog &p_log, const std::string &p_name, size_t p_requestSize, int p_timeout) :
+                                                                           i_log(p_log),
+                                                                           i_name(p_name),
+                                                                           i_requestSize(p_requestSize),
+                                                                           i_timeout(p_timeout),
+                                                                           i_listenfd(-1),
+                                                                           i_stopEventfd(-1),
+                                                                           i_isRunning(false)
+{
+}
+
+UnixSocketServer::~UnixSocketServer(void)
+{
+    stop();
+}
+
+/**
+ * @brief
+ * Bind and listen on the Unix socket, the socket file left by a previous process is removed
+ *
+ * @param p_socketPath
+ * @return bool
+ */
+bool                                UnixSocketServer::init(const std::string &p_socketPath)
+{
+    i_log.log(LOG_INFO, "%s::%s [%s]", i_name.c_str(), __func__, p_socketPath.c_str());
+
+    struct sockaddr_un  l_address;
+
+    std::memset(&l_address, 0, sizeof(l_address));
+    l_address.sun_family = AF_UNIX;
+    if (p_socketPath.empty() || p_socketPath.size() >= sizeof(l_address.sun_path))
+    {
+        i_log.log(LOG_ERR, "%s::%s - invalid socket path [%s]", i_name.c_str(), __func__, p_socketPath.c_str());
+        return false;
+    }
+    std::strncpy(l_address.sun_path, p_socketPath.c_str(), sizeof(l_address.sun_path) - 1);
+
+    i_listenfd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    i_stopEventfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (i_listenfd < 0 || i_stopEventfd < 0)
+    {
+        i_log.log(LOG_ERR, "%s::%s - socket : %s", i_name.c_str(), __func__, strerror(errno));
+        return false;
+    }
+
+    unlink(p_socketPath.c_str());
+    if (bind(i_listenfd, (struct sockaddr *)&l_address, sizeof(l_address)) < 0 ||
+        listen(i_listenfd, 8) < 0)
+    {
+        i_log.log(LOG_ERR, "%s::%s - bind [%s] : %s", i_name.c_str(), __func__, p_socketPath.c_str(), strerror(errno));
+        return false;
+    }
+
+    i_socketPath = p_socketPath;
+    return true;
+}
+
+bool                                UnixSocketServer::start(void)
+{
+    if (i_listenfd < 0 || i_socketPath.empty())
+        return false;
+
+    i_isRunning = true;
+    i_serverThread = std::thread(&UnixSocketServer::serve, this);
+
+    return i_serverThread.joinable();
+}
+
+/**
+ * @brief
+ * Wake up the thread waiting in poll, join it and remove the socket file
+ *
+ */
+void                                UnixSocketServer::stop(void)
+{
+    i_isRunning = false;
+
+    if (i_stopEventfd >= 0)
+        eventfd_write(i_stopEventfd, 1);
+
+    if (i_serverThread.joinable())
+        i_serverThread.join();
+
+    if (i_listenfd >= 0)
+        close(i_listenfd);
+    if (i_stopEventfd >= 0)
+        close(i_stopEventfd);
+    i_listenfd = -1;
+    i_stopEventfd = -1;
+
+    if (!i_socketPath.empty())
+        unlink(i_socketPath.c_str());
+    i_socketPath.clear();
+}
+
+/**
+ * @brief
+ * Launched in a new thread
+ *
+ */
+void                                UnixSocketServer::serve(void)
+{
+    struct pollfd   l_pollfds[2];
+
+    l_pollfds[0].fd = i_listenfd;
+    l_pollfds[0].events = POLLIN;
+    l_pollfds[1].fd = i_stopEventfd;
+    l_pollfds[1].events = POLLIN;
+
+    while (i_isRunning)
+    {
+        if (poll(l_pollfds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            i_log.log(LOG_ERR, "%s::%s - poll : %s", i_name.c_str(), __func__, strerror(errno));
+            break;
+        }
+
+        if (l_pollfds[1].revents & POLLIN)
+            break;
+
+        if (l_pollfds[0].revents & POLLIN)
+        {
+            int l_clientfd = accept4(i_listenfd, nullptr, nullptr, SOCK_CLOEXEC);
+
+            if (l_clientfd >= 0)
+                reply(l_clientfd);
+        }
+    }
+}
+
+/**
+ * @brief
+ * Read the request until its end of line (or the end of the client writes, or the timeout),
+ * write the answer, then close the client
+ *
+ * @param p_clientfd
+ */
+void                                UnixSocketServer::reply(int p_clientfd)
+{
+    struct timeval  l_timeout;
+    std::string     l_request;
+
+    l_timeout.tv_sec = i_timeout / 1000;
+    l_timeout.tv_usec = (i_timeout % 1000) * 1000;
+    setsockopt(p_clientfd, SOL_SOCKET, SO_RCVTIMEO, &l_timeout, sizeof(l_timeout));
+    setsockopt(p_clientfd, SOL_SOCKET, SO_SNDTIMEO, &l_timeout, sizeof(l_timeout));
+
+    if (i_requestSize > 0)
+    {
+        std::vector<char>   l_buffer(i_requestSize);
+
+        while (l_request.size() < i_requestSize && l_request.find('\n') == std::string::npos)
+        {
+            ssize_t l_length = recv(p_clientfd, l_buffer.data(), i_requestSize - l_request.size(), 0);
+
+            if (l_length <= 0)
+                break;
+            l_request.append(l_buffer.data(), (size_t)l_length);
+        }
+        l_request = l_request.substr(0, l_request.find('\n'));
+    }
+
+    std::string     l_answer = answer(l_request);
+    size_t          l_sent = 0;
+
+    while (l_sent < l_answer.size())
+    {
+        ssize_t l_length = send(p_clientfd, l_answer.data() + l_sent, l_answer.size() - l_sent, MSG_NOSIGNAL);
+
+        if (l_length <= 0)
+            break;
+        l_sent += (size_t)l_length;
+    }
+
+    close(p_clientfd);
+}
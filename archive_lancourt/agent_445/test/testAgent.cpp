@@ -4,10 +4,22 @@
 #include <gmock/gmock.h>
 
 #include "mock/mock_iLog.hpp"
-#include "mock/mockAgentController.hpp"
 
 #include "json.hpp"
 
+// every pure virtual of IController, getEvent and getModulesListFromJson with their current signatures
+class MockAgentController : public IController
+{
+public:
+    MOCK_METHOD1(init, IController::eInit(const nlohmann::json &));
+    MOCK_METHOD0(start, IController::eStart(void));
+    MOCK_METHOD1(stopAll, IController::eStopAll(int));
+    MOCK_METHOD1(getModulesListFromJson, std::list<Module>(const nlohmann::json &));
+    MOCK_METHOD0(threadManager, IController::eThreadManager(void));
+    MOCK_METHOD0(eventHandler, void(void));
+    MOCK_METHOD1(getEvent, bool(Event &));
+};
+
 #define SLEEP_DURATION 5
 
 //using
@@ -0,0 +1,91 @@
+#include "agentMetrics.hpp"
+#include "metricsServer.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "mock/mock_iLog.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define METRICS_TEST_SOCKET "/tmp/testAgentMetrics.sock"
+
+TEST(Histogram, BUCKETS)
+{
+    Histogram   l_histogram;
+
+    EXPECT_EQ(Histogram::bucketOf(0), 0u);
+    EXPECT_EQ(Histogram::bucketOf(1), 1u);
+    EXPECT_EQ(Histogram::bucketOf(3), 2u);
+    EXPECT_EQ(Histogram::bucketOf(4), 3u);
+    EXPECT_EQ(Histogram::bucketOf(UINT64_MAX), (size_t)HISTOGRAM_BUCKET_COUNT - 1);
+    EXPECT_EQ(Histogram::bucketUpperBound(3), 7u);
+
+    EXPECT_EQ(l_histogram.percentile(50), 0u);
+
+    // 90 values of 10, 10 values of 1000
+    for (int i = 0; i < 90; i++)
+        l_histogram.record(10);
+    for (int i = 0; i < 10; i++)
+        l_histogram.record(1000);
+
+    EXPECT_EQ(l_histogram.count(), 100u);
+    EXPECT_EQ(l_histogram.max(), 1000u);
+    EXPECT_EQ(l_histogram.percentile(50), 15u);
+    EXPECT_EQ(l_histogram.percentile(99), 1000u);
+
+    nlohmann::json l_json = l_histogram.toJson();
+
+    EXPECT_EQ(l_json.at("sum").get<u_int64_t>(), 10900u);
+    EXPECT_EQ(l_json.at("buckets").size(), 2u);
+}
+
+TEST(AgentMetrics, ENDPOINT)
+{
+    Mock_ILog       l_mock_ilog(ILOG_TEST_FILE);
+    EventQueue      l_eventQueue(1);
+    AgentMetrics    l_metrics(&l_eventQueue);
+    MetricsServer   l_metricsServer(l_metrics, l_mock_ilog);
+    Event           l_event;
+
+    l_event.sourceID = 1;
+    l_event.sourceType = CAPTURE;
+    l_event.eventType = ALERT;
+    l_event.eventPriority = ERROR;
+    l_event.sendingDate = 100;
+    l_event.eventReceptionTime = 102;
+    l_eventQueue.push(l_event);
+    l_eventQueue.push(l_event); // shed, the queue holds one event
+
+    ASSERT_TRUE(l_eventQueue.pop(l_event));
+    l_metrics.recordDispatch(l_event, l_eventQueue.size());
+    l_metrics.recordProcessing(ALERT, 42);
+
+    ASSERT_TRUE(l_metricsServer.init(METRICS_TEST_SOCKET));
+    ASSERT_TRUE(l_metricsServer.start());
+
+    struct sockaddr_un  l_address;
+    int                 l_socketfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    std::string         l_answer;
+    char                l_buffer[4096];
+    ssize_t             l_length;
+
+    std::memset(&l_address, 0, sizeof(l_address));
+    l_address.sun_family = AF_UNIX;
+    std::strncpy(l_address.sun_path, METRICS_TEST_SOCKET, sizeof(l_address.sun_path) - 1);
+    ASSERT_EQ(connect(l_socketfd, (struct sockaddr *)&l_address, sizeof(l_address)), 0);
+    while ((l_length = read(l_socketfd, l_buffer, sizeof(l_buffer))) > 0)
+        l_answer.append(l_buffer, (size_t)l_length);
+    close(l_socketfd);
+
+    nlohmann::json l_json = nlohmann::json::parse(l_answer);
+
+    EXPECT_EQ(l_json.at("sourceLatency_s").at("max").get<int>(), 2);
+    EXPECT_EQ(l_json.at("dispatchLatency_us").at("count").get<int>(), 1);
+    EXPECT_EQ(l_json.at("processingTime_us").at("alert").at("sum").get<int>(), 42);
+    EXPECT_EQ(l_json.at("eventQueue").at("shed").at("alert.error").get<int>(), 1);
+
+    l_metricsServer.stop();
+    EXPECT_NE(access(METRICS_TEST_SOCKET, F_OK), 0);
+}
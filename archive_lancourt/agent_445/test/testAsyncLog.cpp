@@ -0,0 +1,201 @@
+// the debug calls of this file are compiled out
+#define AGENT_LOG_LEVEL LOG_INFO
+
+#include "asyncLog.hpp"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// sink keeping the lines written by the writing thread, blocked while i_mutex is held by the test
+class CaptureLog : public ILog
+{
+public:
+    std::mutex                  i_mutex;
+    std::vector<std::string>    i_lines;
+
+    void log(int p_priority, const char *p_format, ...)
+    {
+        std::lock_guard<std::mutex> l_lock(i_mutex);
+        char                        l_line[LOG_LINE_SIZE];
+        va_list                     l_arguments;
+
+        (void)p_priority;
+        va_start(l_arguments, p_format);
+        vsnprintf(l_line, sizeof(l_line), p_format, l_arguments);
+        va_end(l_arguments);
+        i_lines.emplace_back(l_line);
+    }
+};
+
+static std::string  encodeAndFormat(const char *p_format, ...)
+{
+    LogRecord   l_record;
+    char        l_line[LOG_LINE_SIZE];
+    va_list     l_arguments;
+    bool        l_isEncoded;
+
+    va_start(l_arguments, p_format);
+    l_isEncoded = AsyncLog::encode(l_record, p_format, l_arguments);
+    va_end(l_arguments);
+    if (!l_isEncoded)
+        return "not encoded";
+
+    AsyncLog::format(l_record, l_line, sizeof(l_line));
+    return l_line;
+}
+
+TEST(AsyncLog, FORMAT)
+{
+    std::string l_temporary = "temporary string";
+    size_t      l_size = 4096;
+
+    EXPECT_EQ(encodeAndFormat("Controller::%s - i_running = %i", "processEvent", 1), "Controller::processEvent - i_running = 1");
+    EXPECT_EQ(encodeAndFormat("%d %u %ld %lld %zu %x %#o %hhu %hd", -1, 4000000000u, -2L, -3LL, l_size, 255, 8, 300, 70000),
+              "-1 4000000000 -2 -3 4096 ff 010 44 4464");
+    EXPECT_EQ(encodeAndFormat("[%-6s] [%6.2f] [%e] [%c] [%%] [%05d]", "ab", 3.14159, 1e10, 'z', 42),
+              "[ab    ] [  3.14] [1.000000e+10] [z] [%] [00042]");
+    EXPECT_EQ(encodeAndFormat("[%*d] [%.*s] [%*.*f]", 4, 7, 3, "abcdef", 8, 1, 2.25), "[   7] [abc] [     2.2]");
+    EXPECT_EQ(encodeAndFormat("%p", (void *)0x1234), "0x1234");
+
+    // the string is copied : the caller may free it after the call
+    EXPECT_EQ(encodeAndFormat("%s", l_temporary.c_str()), "temporary string");
+
+    // formatted by the caller
+    EXPECT_EQ(encodeAndFormat("%m"), "not encoded");
+    EXPECT_EQ(encodeAndFormat("%s", std::string(LOG_RECORD_SIZE, 'a').c_str()), "not encoded");
+}
+
+TEST(AsyncLog, ORDER)
+{
+    CaptureLog                  l_sink;
+    AsyncLog                    l_log(l_sink);
+    std::vector<std::thread>    l_threads;
+
+    // synchronous before start
+    l_log.log(LOG_INFO, "before %s", "start");
+    ASSERT_EQ(l_sink.i_lines.size(), 1u);
+    EXPECT_EQ(l_sink.i_lines[0], "before start");
+
+    EXPECT_TRUE(l_log.start());
+    for (int l_thread = 0; l_thread < 4; l_thread++)
+        l_threads.emplace_back([&l_log, l_thread] {
+            for (int i = 0; i < 500; i++)
+                l_log.log(LOG_INFO, "thread %d line %d", l_thread, i);
+        });
+    for (std::thread &l_thread : l_threads)
+        l_thread.join();
+    l_log.stop();
+
+    ASSERT_EQ(l_sink.i_lines.size(), 1u + 4 * 500 - l_log.droppedCount());
+    EXPECT_EQ(l_log.droppedCount(), 0u);
+
+    // the lines of a thread are written in the order of its calls
+    int l_next[4] = { 0, 0, 0, 0 };
+
+    for (size_t i = 1; i < l_sink.i_lines.size(); i++)
+    {
+        int l_thread;
+        int l_line;
+
+        ASSERT_EQ(std::sscanf(l_sink.i_lines[i].c_str(), "thread %d line %d", &l_thread, &l_line), 2);
+        EXPECT_EQ(l_line, l_next[l_thread]++);
+    }
+}
+
+TEST(AsyncLog, DROP)
+{
+    CaptureLog  l_sink;
+    AsyncLog    l_log(l_sink);
+
+    EXPECT_TRUE(l_log.start());
+
+    {
+        std::lock_guard<std::mutex> l_lock(l_sink.i_mutex);
+
+        // the writing thread takes the first line and waits on the sink, then the ring fills up
+        l_log.log(LOG_INFO, "first");
+        std::this_thread::sleep_for(std::chrono::milliseconds(5 * LOG_DRAIN_PERIOD));
+
+        for (int i = 0; i < LOG_RING_SLOTS + 10; i++)
+            l_log.log(LOG_INFO, "line %d", i);
+        EXPECT_EQ(l_log.droppedCount(), 10u);
+    }
+    l_log.stop();
+
+    ASSERT_EQ(l_sink.i_lines.size(), 1u + LOG_RING_SLOTS);
+    EXPECT_EQ(l_sink.i_lines.back(), "line " + std::to_string(LOG_RING_SLOTS - 1));
+}
+
+TEST(AsyncLog, TWO_LOGS)
+{
+    CaptureLog  l_firstSink;
+    CaptureLog  l_secondSink;
+    AsyncLog    l_firstLog(l_firstSink);
+    AsyncLog    l_secondLog(l_secondSink);
+
+    EXPECT_TRUE(l_firstLog.start());
+    EXPECT_TRUE(l_secondLog.start());
+
+    {
+        std::lock_guard<std::mutex> l_firstLock(l_firstSink.i_mutex);
+        std::lock_guard<std::mutex> l_secondLock(l_secondSink.i_mutex);
+
+        l_firstLog.log(LOG_INFO, "first");
+        l_secondLog.log(LOG_INFO, "first");
+        std::this_thread::sleep_for(std::chrono::milliseconds(5 * LOG_DRAIN_PERIOD));
+
+        // the thread keeps one ring in each AsyncLog : alternating calls fill them up
+        for (int i = 0; i < LOG_RING_SLOTS + 10; i++)
+        {
+            l_firstLog.log(LOG_INFO, "line %d", i);
+            l_secondLog.log(LOG_INFO, "line %d", i);
+        }
+        EXPECT_EQ(l_firstLog.droppedCount(), 10u);
+        EXPECT_EQ(l_secondLog.droppedCount(), 10u);
+    }
+    l_firstLog.stop();
+    l_secondLog.stop();
+
+    EXPECT_EQ(l_firstSink.i_lines.size(), 1u + LOG_RING_SLOTS);
+    EXPECT_EQ(l_secondSink.i_lines.size(), 1u + LOG_RING_SLOTS);
+}
+
+TEST(AsyncLog, STOP_WHILE_LOGGING)
+{
+    CaptureLog                  l_sink;
+    AsyncLog                    l_log(l_sink);
+    std::vector<std::thread>    l_threads;
+
+    EXPECT_TRUE(l_log.start());
+    for (int l_thread = 0; l_thread < 4; l_thread++)
+        l_threads.emplace_back([&l_log] {
+            for (int i = 0; i < 20000; i++)
+                l_log.log(LOG_INFO, "line %d", i);
+        });
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    l_log.stop();
+    for (std::thread &l_thread : l_threads)
+        l_thread.join();
+
+    // every call is drained, written by its thread after the stop, or counted as dropped
+    EXPECT_EQ(l_sink.i_lines.size() + l_log.droppedCount(), 4u * 20000);
+}
+
+TEST(AsyncLog, COMPILED_OUT)
+{
+    CaptureLog  l_sink;
+    int         l_evaluated = 0;
+
+    AGENT_LOG(l_sink, LOG_DEBUG, "%d", ++l_evaluated);
+    EXPECT_EQ(l_evaluated, 0);
+    EXPECT_TRUE(l_sink.i_lines.empty());
+
+    AGENT_LOG(l_sink, LOG_INFO, "%d", ++l_evaluated);
+    EXPECT_EQ(l_evaluated, 1);
+    ASSERT_EQ(l_sink.i_lines.size(), 1u);
+    EXPECT_EQ(l_sink.i_lines[0], "1");
+}
@@ -17,7 +17,7 @@ using ::testing::Return;
 
 // nlohmann::json     p_networkConf = nlohmann::json::parse(p_jsonString);
 
-std::priority_queue<Event, std::vector<Event>, compareEventPriority> *g_eventList;
+EventQueue *g_eventList;
 
 TEST(ConfigReceiver, SUCCESS)
 {
@@ -6,13 +6,30 @@
 #include "mock/mockAgentConfigReceiver.hpp"
 #include "mock/mockAgentStatusReceiver.hpp"
 #include "mock/mockAgentLauncher.hpp"
-#include "mock/mockAgentStopper.hpp"
-#include "mock/mockAgentObserver.hpp"
 
 #include "mock/mock_iLog.hpp"
 
 #include "json.hpp"
 
+// every pure virtual of IObserver, start and the module supervision included
+class MockAgentObserver : public IObserver
+{
+public:
+    MOCK_METHOD1(init, IObserver::eInit(const nlohmann::json &));
+    MOCK_METHOD0(start, IObserver::eStart(void));
+    MOCK_METHOD1(stop, IObserver::eStop(int));
+    MOCK_METHOD2(watchModule, IObserver::eWatchModule(const Module &, pid_t));
+    MOCK_METHOD2(unwatchModule, IObserver::eUnwatchModule(int, ModuleProcess *));
+};
+
+// stopModule takes the pidfds handed over by the observer
+class MockAgentStopper : public IStopper
+{
+public:
+    MOCK_METHOD0(init, IStopper::eInit(void));
+    MOCK_METHOD1(stopModule, IStopper::eStopModule(std::list<ModuleProcess>));
+};
+
 #define SLEEP_DURATION 5
 
 using ::testing::_;
@@ -26,7 +43,7 @@ TEST(Controller_INIT_STOP, SUCCESS)
 {
     Mock_ILog l_mock_ilog(ILOG_TEST_FILE);
 
-    std::priority_queue<Event, std::vector<Event>, compareEventPriority> *g_eventList = nullptr;
+    EventQueue *g_eventList = nullptr;
 
     l_mock_ilog.LOG(LOG_DEBUG, "==================== Start test 1 : ControllerSucceed ====================");
 
@@ -83,10 +100,11 @@ TEST(Controller_INIT_STOP, SUCCESS)
                     return IStopper::eInit::SUCCESS;
                 }));
 
-    EXPECT_CALL(l_mockObserver, init())
+    EXPECT_CALL(l_mockObserver, init(_))
         .WillOnce(
             Invoke(
-                [&]() -> IObserver::eInit {
+                [&](const nlohmann::json &p_json) -> IObserver::eInit {
+                    (void)p_json;
                     l_mock_ilog.LOG(LOG_DEBUG, "init observer");
                     return IObserver::eInit::SUCCESS;
                 }));
@@ -140,4 +158,71 @@ TEST(Controller_INIT_STOP, SUCCESS)
                 }));
 
     EXPECT_EQ(l_controllerInstance.stopAll(2), IController::eStopAll::SUCCESS);
-}
\ No newline at end of file
+}
+TEST(Controller, DIFF_MODULES)
+{
+    std::map<int, RunningModule>    l_runningModules;
+    std::list<Module>               l_newModules;
+
+    // running : 1 capture, 2 vision, 3 vision
+    for (int l_id = 1; l_id <= 3; l_id++)
+    {
+        RunningModule l_runningModule;
+
+        l_runningModule.module.id = l_id;
+        l_runningModule.module.name = (l_id == 1) ? "capture" : "vision";
+        l_runningModule.module.parameters = "{\"interface\": \"eth0\"}";
+        l_runningModule.parametersHash = std::hash<std::string>()(l_runningModule.module.parameters);
+        l_runningModule.pid = 100 + l_id;
+        l_runningModules[l_id] = l_runningModule;
+    }
+
+    // new configuration : 1 unchanged, 2 with other parameters, 3 removed, 4 added
+    Module l_module;
+
+    l_module.id = 1;
+    l_module.name = "capture";
+    l_module.parameters = "{\"interface\": \"eth0\"}";
+    l_newModules.emplace_back(l_module);
+
+    l_module.id = 2;
+    l_module.name = "vision";
+    l_module.parameters = "{\"interface\": \"eth1\"}";
+    l_newModules.emplace_back(l_module);
+
+    l_module.id = 4;
+    l_newModules.emplace_back(l_module);
+
+    ModuleDiff l_diff = Controller::diffModules(l_runningModules, l_newModules);
+
+    EXPECT_EQ(l_diff.unchangedCount, 1);
+    ASSERT_EQ(l_diff.toRestart.size(), 1u);
+    EXPECT_EQ(l_diff.toRestart.front().id, 2);
+    ASSERT_EQ(l_diff.toStart.size(), 1u);
+    EXPECT_EQ(l_diff.toStart.front().id, 4);
+    ASSERT_EQ(l_diff.toStop.size(), 1u);
+    EXPECT_EQ(l_diff.toStop.front(), 3);
+}
+
+TEST(Controller, DIFF_MODULES_DUPLICATE_ID)
+{
+    std::map<int, RunningModule>    l_runningModules;
+    std::list<Module>               l_newModules;
+    Module                          l_module;
+
+    // the same id twice : the second module is not started over the first one
+    l_module.id = 1;
+    l_module.name = "capture";
+    l_module.parameters = "{\"interface\": \"eth0\"}";
+    l_newModules.emplace_back(l_module);
+
+    l_module.parameters = "{\"interface\": \"eth1\"}";
+    l_newModules.emplace_back(l_module);
+
+    ModuleDiff l_diff = Controller::diffModules(l_runningModules, l_newModules);
+
+    ASSERT_EQ(l_diff.duplicateIds.size(), 1u);
+    EXPECT_EQ(l_diff.duplicateIds.front(), 1);
+    ASSERT_EQ(l_diff.toStart.size(), 1u);
+    EXPECT_EQ(l_diff.toStart.front().parameters, "{\"interface\": \"eth0\"}");
+}
@@ -0,0 +1,55 @@
+#include "eventPayload.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+TEST(EventPayload, LAZY_PARSING)
+{
+    EventPayload    l_payload(std::string("{\"cpu\": 12, \"modules\": [{\"id\": 1}, {\"id\": 2}]}"));
+    EventPayload    l_copy = l_payload;
+
+    // nothing parsed before the first access
+    EXPECT_FALSE(l_payload.isParsed());
+    EXPECT_EQ(l_payload.get("cpu").get<int>(), 12);
+    EXPECT_FALSE(l_payload.isParsed());
+
+    EXPECT_EQ(l_copy.json().at("modules").size(), 2u);
+
+    // the copies share the buffer and the parsed json
+    EXPECT_TRUE(l_payload.isParsed());
+    EXPECT_EQ(&l_payload.raw(), &l_copy.raw());
+    EXPECT_EQ(&l_payload.json(), &l_copy.json());
+    EXPECT_EQ(l_payload.get("modules").at(1).at("id").get<int>(), 2);
+}
+
+TEST(EventPayload, PARTIAL_PARSING)
+{
+    EventPayload    l_payload(std::string("{\"a\": {\"b\": [1, 2, {\"c\": 3}]}, \"wanted\": {\"d\": 4}, \"e\": 5}"));
+
+    EXPECT_EQ(l_payload.get("wanted"), nlohmann::json::parse("{\"d\": 4}"));
+    EXPECT_EQ(l_payload.get("e").get<int>(), 5);
+    EXPECT_THROW(l_payload.get("missing"), nlohmann::json::out_of_range);
+}
+
+TEST(EventPayload, INVALID)
+{
+    // an invalid payload only fails when it is read
+    EventPayload    l_payload(std::string("{\"cpu\": "));
+
+    EXPECT_THROW(l_payload.json(), nlohmann::json::parse_error);
+    EXPECT_THROW(l_payload.json(), nlohmann::json::parse_error);
+    EXPECT_THROW(l_payload.get("cpu"), nlohmann::json::parse_error);
+    EXPECT_FALSE(l_payload.isParsed());
+
+    EventPayload    l_empty;
+
+    EXPECT_TRUE(l_empty.empty());
+    EXPECT_TRUE(l_empty.json().is_null());
+    EXPECT_TRUE(l_empty.get("cpu").is_null());
+
+    EventPayload    l_parsed(nlohmann::json::parse("{\"module\": []}"));
+
+    EXPECT_TRUE(l_parsed.isParsed());
+    EXPECT_FALSE(l_parsed.empty());
+    EXPECT_EQ(l_parsed.get("module").size(), 0u);
+}
@@ -0,0 +1,223 @@
+#include "eventQueue.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#define SLEEP_DURATION 5
+
+static Event    newEvent(e_eventType p_eventType, u_int32_t p_sourceID)
+{
+    Event l_event;
+
+    l_event.sourceID = p_sourceID;
+    l_event.sourceType = DEFAULT_SOURCE;
+    l_event.eventType = p_eventType;
+    l_event.eventPriority = DEFAULT_PRIORITY;
+    return l_event;
+}
+
+TEST(EventQueue, PRIORITY)
+{
+    EventQueue  l_eventQueue;
+    Event       l_event;
+
+    EXPECT_FALSE(l_eventQueue.tryPop(l_event));
+
+    l_eventQueue.push(newEvent(STATS, 1));
+    l_eventQueue.push(newEvent(ALERT, 2));
+    l_eventQueue.push(newEvent(CONFIG, 3));
+    EXPECT_EQ(l_eventQueue.size(), 3u);
+
+    // CONFIG first, then ALERT, then STATS (compareEventPriority)
+    EXPECT_TRUE(l_eventQueue.pop(l_event));
+    EXPECT_EQ(l_event.sourceID, 3u);
+    EXPECT_TRUE(l_eventQueue.pop(l_event));
+    EXPECT_EQ(l_event.sourceID, 2u);
+    EXPECT_TRUE(l_eventQueue.tryPop(l_event));
+    EXPECT_EQ(l_event.sourceID, 1u);
+    EXPECT_TRUE(l_eventQueue.empty());
+}
+
+TEST(EventQueue, WAKE_UP)
+{
+    EventQueue  l_eventQueue;
+    Event       l_event;
+
+    // the consumer waits in pop until the producer pushes
+    std::thread l_producer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_DURATION));
+        l_eventQueue.push(newEvent(CONFIG, 42));
+    });
+
+    EXPECT_TRUE(l_eventQueue.pop(l_event));
+    EXPECT_EQ(l_event.sourceID, 42u);
+    l_producer.join();
+
+    // close wakes up the consumer, pop returns false
+    std::thread l_stopper([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_DURATION));
+        l_eventQueue.close();
+    });
+
+    EXPECT_FALSE(l_eventQueue.pop(l_event));
+    l_stopper.join();
+}
+
+TEST(EventQueue, COALESCE_STATS)
+{
+    EventQueue  l_eventQueue;
+    Event       l_event;
+
+    // 3 sources sending 100 STATS each while the consumer is busy
+    for (int i = 0; i < 100; i++)
+    {
+        for (u_int32_t l_sourceID = 1; l_sourceID <= 3; l_sourceID++)
+        {
+            Event l_stats = newEvent(STATS, l_sourceID);
+
+            l_stats.sourceType = CAPTURE;
+            l_stats.cpuUsage = i;
+            l_eventQueue.push(std::move(l_stats));
+        }
+    }
+    l_eventQueue.push(newEvent(CONFIG, 42));
+
+    // one STATS per source, the CONFIG is not delayed
+    EXPECT_EQ(l_eventQueue.size(), 4u);
+    EXPECT_EQ(l_eventQueue.coalescedCount(), 297u);
+    EXPECT_TRUE(l_eventQueue.pop(l_event));
+    EXPECT_EQ(l_event.sourceID, 42u);
+
+    // the latest snapshot of each source, in the order of the sources
+    for (u_int32_t l_sourceID = 1; l_sourceID <= 3; l_sourceID++)
+    {
+        EXPECT_TRUE(l_eventQueue.pop(l_event));
+        EXPECT_EQ(l_event.sourceID, l_sourceID);
+        EXPECT_EQ(l_event.cpuUsage, 99);
+    }
+    EXPECT_TRUE(l_eventQueue.empty());
+
+    // the same sourceID from another sourceType is another source
+    Event l_capture = newEvent(STATS, 7);
+    Event l_vision = newEvent(STATS, 7);
+
+    l_capture.sourceType = CAPTURE;
+    l_vision.sourceType = VISION;
+    l_eventQueue.push(l_capture);
+    l_eventQueue.push(l_vision);
+    EXPECT_EQ(l_eventQueue.size(), 2u);
+}
+
+TEST(EventQueue, COALESCE_PRIORITY_CHANGE)
+{
+    EventQueue  l_eventQueue;
+    Event       l_event;
+
+    for (u_int32_t l_sourceID = 1; l_sourceID <= 3; l_sourceID++)
+        l_eventQueue.push(newEvent(STATS, l_sourceID));
+
+    // a newer STATS of another priority leaves the lane of the previous one
+    Event l_fatal = newEvent(STATS, 1);
+
+    l_fatal.eventPriority = FATAL;
+    l_fatal.cpuUsage = 1;
+    l_eventQueue.push(l_fatal);
+
+    // the sources left in the DEFAULT_PRIORITY lane are still coalesced in place
+    Event l_stats = newEvent(STATS, 3);
+
+    l_stats.cpuUsage = 3;
+    l_eventQueue.push(l_stats);
+
+    EXPECT_EQ(l_eventQueue.size(), 3u);
+    EXPECT_EQ(l_eventQueue.coalescedCount(), 2u);
+    EXPECT_TRUE(l_eventQueue.pop(l_event));
+    EXPECT_EQ(l_event.sourceID, 1u);
+    EXPECT_EQ(l_event.eventPriority, FATAL);
+    EXPECT_TRUE(l_eventQueue.pop(l_event));
+    EXPECT_EQ(l_event.sourceID, 2u);
+    EXPECT_TRUE(l_eventQueue.pop(l_event));
+    EXPECT_EQ(l_event.sourceID, 3u);
+    EXPECT_EQ(l_event.cpuUsage, 3);
+    EXPECT_TRUE(l_eventQueue.empty());
+}
+
+TEST(EventQueue, PRIORITY_LANES)
+{
+    EventQueue  l_eventQueue;
+    Event       l_event;
+    Event       l_alert = newEvent(ALERT, 1);
+
+    l_eventQueue.push(l_alert);
+    l_alert.sourceID = 2;
+    l_alert.eventPriority = FATAL;
+    l_eventQueue.push(l_alert);
+    l_alert.sourceID = 3;
+    l_alert.eventPriority = WARNING;
+    l_eventQueue.push(l_alert);
+
+    // same type : FATAL, then WARNING, then DEFAULT_PRIORITY
+    EXPECT_TRUE(l_eventQueue.pop(l_event));
+    EXPECT_EQ(l_event.sourceID, 2u);
+    EXPECT_TRUE(l_eventQueue.pop(l_event));
+    EXPECT_EQ(l_event.sourceID, 3u);
+    EXPECT_TRUE(l_eventQueue.pop(l_event));
+    EXPECT_EQ(l_event.sourceID, 1u);
+
+    // out of range values received from a module
+    EXPECT_EQ(EventQueue::laneOf((e_eventType)42, (e_eventPriority)-1), (size_t)EVENT_LANE_COUNT - 1);
+    EXPECT_EQ(EventQueue::laneOf(CONFIG, FATAL), 0u);
+}
+
+TEST(EventQueue, SHEDDING)
+{
+    EventQueue  l_eventQueue(4);
+    Event       l_event;
+
+    l_eventQueue.push(newEvent(UNDEFINED, 1));
+    l_eventQueue.push(newEvent(UNDEFINED, 2));
+    l_eventQueue.push(newEvent(ALERT, 3));
+    l_eventQueue.push(newEvent(ALERT, 4));
+
+    // full : the oldest event of the lowest lane is dropped
+    l_eventQueue.push(newEvent(CONFIG, 5));
+    EXPECT_EQ(l_eventQueue.size(), 4u);
+    EXPECT_EQ(l_eventQueue.shedCount(), 1u);
+
+    // a pushed event lower than every waiting one is dropped itself
+    l_eventQueue.push(newEvent(ALERT, 6));
+    l_eventQueue.push(newEvent(UNDEFINED, 7));
+    EXPECT_EQ(l_eventQueue.shedCount(), 3u);
+
+    EventQueueCounters l_counters = l_eventQueue.counters();
+
+    EXPECT_EQ(l_counters.shed[EventQueue::laneOf(UNDEFINED, DEFAULT_PRIORITY)], 3u);
+    EXPECT_EQ(l_counters.depth[EventQueue::laneOf(ALERT, DEFAULT_PRIORITY)], 3u);
+    EXPECT_EQ(l_counters.pushed, 7u);
+
+    u_int32_t   l_expected[] = { 5, 3, 4, 6 };
+
+    for (u_int32_t l_sourceID : l_expected)
+    {
+        EXPECT_TRUE(l_eventQueue.tryPop(l_event));
+        EXPECT_EQ(l_event.sourceID, l_sourceID);
+    }
+    EXPECT_TRUE(l_eventQueue.empty());
+}
+
+TEST(EventQueue, AGING)
+{
+    EventQueue  l_eventQueue(EVENT_QUEUE_CAPACITY, SLEEP_DURATION);
+    Event       l_event;
+
+    l_eventQueue.push(newEvent(STATS, 1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_DURATION * 2));
+    l_eventQueue.push(newEvent(CONFIG, 2));
+
+    // the STATS waited more than the aging delay
+    EXPECT_TRUE(l_eventQueue.pop(l_event));
+    EXPECT_EQ(l_event.sourceID, 1u);
+    EXPECT_TRUE(l_eventQueue.pop(l_event));
+    EXPECT_EQ(l_event.sourceID, 2u);
+    EXPECT_EQ(l_eventQueue.counters().aged, 1u);
+}
@@ -69,4 +69,41 @@ TEST(Launcher, Success)
     EXPECT_EQ(l_launcher.start(), ILauncher::eStart::SUCCESS); // useless
     // EXPECT_EQ(l_launcher.launchModule(g_fakeModule, &l_fakePid), ILauncher::eLaunchModule::SUCCESS);
     // EXPECT_EQ(l_launcher.stop(SIGTERM), ILauncher::eStop::SUCCESS);
-}
\ No newline at end of file
+}
+
+TEST(Launcher, ParseCpuList)
+{
+    cpu_set_t l_cpuSet;
+
+    EXPECT_TRUE(Launcher::parseCpuList("0-3,8,10-11\n", &l_cpuSet));
+    EXPECT_EQ(CPU_COUNT(&l_cpuSet), 7);
+    EXPECT_TRUE(CPU_ISSET(2, &l_cpuSet));
+    EXPECT_TRUE(CPU_ISSET(8, &l_cpuSet));
+    EXPECT_FALSE(CPU_ISSET(9, &l_cpuSet));
+
+    EXPECT_FALSE(Launcher::parseCpuList("", &l_cpuSet));
+    EXPECT_FALSE(Launcher::parseCpuList("3-1", &l_cpuSet));
+    EXPECT_FALSE(Launcher::parseCpuList("a-b", &l_cpuSet));
+    EXPECT_FALSE(Launcher::parseCpuList("3abc", &l_cpuSet));
+    EXPECT_FALSE(Launcher::parseCpuList("0-3-5", &l_cpuSet));
+    EXPECT_FALSE(Launcher::parseCpuList("1,2x", &l_cpuSet));
+}
+
+TEST(Launcher, SPAWN_FAILURE)
+{
+    Mock_ILog   l_mock_ilog(ILOG_TEST_FILE);
+    StatusPages l_statusPages;
+    char        *l_fakeEnvp[] = { nullptr };
+    Launcher    l_launcher(l_mock_ilog, l_fakeEnvp, &l_statusPages);
+    Module      l_module;
+    pid_t       l_pid = 0;
+
+    l_module.id = 12;
+    l_module.name = "/nonexistent/module";
+    l_module.parameters = "{}";
+
+    // posix_spawn fails on the execve : the page created for the module is removed
+    EXPECT_EQ(l_launcher.launchModule(l_module, &l_pid), ILauncher::eLaunchModule::FAILURE);
+    EXPECT_EQ(l_statusPages.size(), 0u);
+    EXPECT_NE(access(("/dev/shm" + StatusPages::pageName(12)).c_str(), F_OK), 0);
+}
@@ -4,9 +4,17 @@
 #include <gmock/gmock.h>
 
 #include "mock/mock_iLog.hpp"
+#include "mock/mockAgentLauncher.hpp"
 
 #include "json.hpp" // in case
 
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#ifndef SYS_pidfd_send_signal
+# define SYS_pidfd_send_signal 424
+#endif
+
 #define SLEEP_DURATION 5 // in case
 
 using ::testing::_;
@@ -20,11 +28,139 @@ TEST(Observer, SUCCESS)
     Mock_ILog   l_mock_ilog(ILOG_TEST_FILE);
     l_mock_ilog.LOG(LOG_DEBUG, "==================== TEST OBSERVER.SUCCESS ====================");
 
-    Observer l_observer(l_mock_ilog);
+    EventQueue          l_eventQueue;
+    MockAgentLauncher   l_mockLauncher;
+    Observer            l_observer(&l_eventQueue, l_mockLauncher, l_mock_ilog);
 
     l_mock_ilog.LOG(LOG_DEBUG, "++++++++++++++++++++> l_observer.init");
-    EXPECT_EQ(l_observer.init(), IObserver::eInit::SUCCESS);
+    EXPECT_EQ(l_observer.init(nlohmann::json::object()), IObserver::eInit::SUCCESS);
 
     l_mock_ilog.LOG(LOG_DEBUG, "++++++++++++++++++++> l_observer.stop");
     EXPECT_EQ(l_observer.stop(SIGTERM), IObserver::eStop::SUCCESS);
-}
\ No newline at end of file
+}
+
+TEST(Observer, RESTART)
+{
+    Mock_ILog   l_mock_ilog(ILOG_TEST_FILE);
+    l_mock_ilog.LOG(LOG_DEBUG, "==================== TEST OBSERVER.RESTART ====================");
+
+    EventQueue          l_eventQueue;
+    MockAgentLauncher   l_mockLauncher;
+    Observer            l_observer(&l_eventQueue, l_mockLauncher, l_mock_ilog);
+    Module              l_module;
+    Event               l_event;
+    pid_t               l_restartedPid = -1;
+
+    l_module.id = 7;
+    l_module.name = "capture";
+
+    // the restarted module waits for its SIGTERM
+    EXPECT_CALL(l_mockLauncher, launchModule(_, _))
+        .WillOnce(
+            Invoke([&](Module p_module, pid_t *p_modulePid) -> ILauncher::eLaunchModule {
+                EXPECT_EQ(p_module.id, 7);
+                *p_modulePid = fork();
+                if (*p_modulePid == 0)
+                {
+                    pause();
+                    _exit(0);
+                }
+                l_restartedPid = *p_modulePid;
+                return ILauncher::eLaunchModule::SUCCESS;
+            }));
+
+    // the STATS events of the sampler are skipped
+    auto l_popAlert = [&l_eventQueue](Event &p_event) -> bool {
+        while (l_eventQueue.pop(p_event))
+        {
+            if (p_event.eventType == ALERT)
+                return true;
+        }
+        return false;
+    };
+
+    ASSERT_EQ(l_observer.init(nlohmann::json::object()), IObserver::eInit::SUCCESS);
+    ASSERT_EQ(l_observer.start(), IObserver::eStart::SUCCESS);
+
+    // a module crashing right after its launch
+    pid_t l_pid = fork();
+
+    if (l_pid == 0)
+        _exit(3);
+    ASSERT_EQ(l_observer.watchModule(l_module, l_pid), IObserver::eWatchModule::SUCCESS);
+
+    ASSERT_TRUE(l_popAlert(l_event));
+    EXPECT_EQ(l_event.eventType, ALERT);
+    EXPECT_EQ(l_event.sourceID, 7u);
+    EXPECT_EQ(l_event.jsonData.get("event").get<std::string>(), "moduleExited");
+    EXPECT_EQ(l_event.jsonData.get("exitCode").get<int>(), 3);
+    EXPECT_EQ(l_event.jsonData.get("restartDelay").get<int>(), RESTART_DELAY_MIN);
+
+    ASSERT_TRUE(l_popAlert(l_event));
+    EXPECT_EQ(l_event.jsonData.get("event").get<std::string>(), "moduleRestarted");
+    EXPECT_EQ(l_event.jsonData.get("pid").get<pid_t>(), l_restartedPid);
+
+    // stopped by the controller : not restarted again
+    ModuleProcess l_moduleProcess;
+
+    EXPECT_EQ(l_observer.unwatchModule(7, &l_moduleProcess), IObserver::eUnwatchModule::SUCCESS);
+    EXPECT_EQ(l_moduleProcess.pid, l_restartedPid);
+    ASSERT_GE(l_moduleProcess.pidfd, 0);
+    kill(l_moduleProcess.pid, SIGTERM);
+
+    usleep(RESTART_DELAY_MIN * 10 * 1000);
+    while (l_eventQueue.tryPop(l_event))
+        EXPECT_NE(l_event.eventType, ALERT);
+    // reaped by the observer, the pidfd handed over still designates the module : signaling it fails
+    EXPECT_EQ(waitpid(l_moduleProcess.pid, nullptr, WNOHANG), -1);
+    EXPECT_NE(syscall(SYS_pidfd_send_signal, l_moduleProcess.pidfd, SIGTERM, nullptr, 0), 0);
+    EXPECT_EQ(errno, ESRCH);
+    close(l_moduleProcess.pidfd);
+
+    EXPECT_EQ(l_observer.stop(SIGTERM), IObserver::eStop::SUCCESS);
+}
+
+TEST(Observer, STATS)
+{
+    Mock_ILog   l_mock_ilog(ILOG_TEST_FILE);
+    l_mock_ilog.LOG(LOG_DEBUG, "==================== TEST OBSERVER.STATS ====================");
+
+    EventQueue          l_eventQueue;
+    MockAgentLauncher   l_mockLauncher;
+    Observer            l_observer(&l_eventQueue, l_mockLauncher, l_mock_ilog);
+    Module              l_module;
+    Event               l_event;
+    pid_t               l_pid = fork();
+
+    if (l_pid == 0)
+    {
+        pause();
+        _exit(0);
+    }
+
+    l_module.id = 3;
+    EXPECT_EQ(l_observer.init(nlohmann::json{{"observer_samplePeriod", 0}}), IObserver::eInit::FAILURE);
+    ASSERT_EQ(l_observer.init(nlohmann::json{{"observer_samplePeriod", 50}, {"observer_schedstatInterval", 1}}),
+              IObserver::eInit::SUCCESS);
+    ASSERT_EQ(l_observer.start(), IObserver::eStart::SUCCESS);
+    ASSERT_EQ(l_observer.watchModule(l_module, l_pid), IObserver::eWatchModule::SUCCESS);
+
+    // one STATS event per module every observer_samplePeriod, coalesced by the queue
+    usleep(50 * 3500);
+    EXPECT_EQ(l_eventQueue.size(), 1u);
+    EXPECT_GE(l_eventQueue.coalescedCount(), 2u);
+
+    ASSERT_TRUE(l_eventQueue.tryPop(l_event));
+    EXPECT_EQ(l_event.eventType, STATS);
+    EXPECT_EQ(l_event.sourceID, 3u);
+    EXPECT_GT(l_event.ramUsage, 0);
+    EXPECT_EQ(l_event.jsonData.get("pid").get<pid_t>(), l_pid);
+    EXPECT_GT(l_event.jsonData.get("mainThreadTimeslices").get<unsigned long long>(), 0u);
+
+    ModuleProcess l_moduleProcess;
+
+    EXPECT_EQ(l_observer.unwatchModule(3, &l_moduleProcess), IObserver::eUnwatchModule::SUCCESS);
+    kill(l_moduleProcess.pid, SIGTERM);
+    close(l_moduleProcess.pidfd);
+    EXPECT_EQ(l_observer.stop(SIGTERM), IObserver::eStop::SUCCESS);
+}
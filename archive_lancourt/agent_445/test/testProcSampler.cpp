@@ -0,0 +1,100 @@
+#include "procSampler.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstring>
+#include <signal.h>
+#include <sys/wait.h>
+
+TEST(ProcSampler, PARSE_STAT)
+{
+    // comm with spaces and parenthesis
+    const char  *l_line = "4242 (my (capture) 1) S 1 4242 4242 0 -1 4194560 1234 0 0 0 "
+                          "250 75 0 0 20 0 12 0 98765 1048576000 2560 18446744073709551615 "
+                          "1 1 0 0 0 0 0 4096 0 0 0 0 17 3 0 0 0 0 0\n";
+    ProcStat    l_stat;
+
+    ASSERT_TRUE(ProcSampler::parseStat(l_line, std::strlen(l_line), &l_stat));
+    EXPECT_EQ(l_stat.cpuTicks, 325u);
+    EXPECT_EQ(l_stat.threadCount, 12);
+    EXPECT_EQ(l_stat.rssPages, 2560);
+
+    // truncated before rss
+    EXPECT_FALSE(ProcSampler::parseStat(l_line, 60, &l_stat));
+    EXPECT_FALSE(ProcSampler::parseStat("4242 capture S 1", 16, &l_stat));
+
+    const char  *l_schedstat = "1234567 890 4321\n";
+
+    ASSERT_TRUE(ProcSampler::parseSchedstat(l_schedstat, std::strlen(l_schedstat), &l_stat));
+    EXPECT_EQ(l_stat.runTime, 1234567u);
+    EXPECT_EQ(l_stat.timeslices, 4321u);
+}
+
+TEST(ProcSampler, SAMPLE)
+{
+    ProcSampler             l_sampler;
+    std::vector<ProcSample> l_samples;
+    pid_t                   l_pid = fork();
+
+    // a module burning a cpu
+    if (l_pid == 0)
+    {
+        for (;;)
+            ;
+    }
+
+    ASSERT_TRUE(l_sampler.add(1, l_pid));
+    ASSERT_TRUE(l_sampler.add(2, getpid()));
+    EXPECT_FALSE(l_sampler.add(3, -1));
+
+    usleep(200000);
+    ASSERT_EQ(l_sampler.sample(l_samples), 2u);
+    EXPECT_EQ(l_samples[0].moduleId, 1);
+    EXPECT_GT(l_samples[0].cpuUsage, 20);
+    EXPECT_GT(l_samples[1].ramUsage, 0);
+
+    // a reaped module is skipped
+    kill(l_pid, SIGKILL);
+    waitpid(l_pid, nullptr, 0);
+    EXPECT_EQ(l_sampler.sample(l_samples), 1u);
+
+    l_sampler.remove(1);
+    EXPECT_EQ(l_sampler.size(), 1u);
+}
+
+TEST(ProcSampler, SCHEDSTAT_INTERVAL)
+{
+    ProcSampler             l_sampler;
+    std::vector<ProcSample> l_samples;
+    pid_t                   l_pid = fork();
+
+    if (l_pid == 0)
+    {
+        for (;;)
+            usleep(1000);
+    }
+
+    // schedstat every 3 samples : the count of the samples in between is the one of the previous read
+    l_sampler.setSchedstatInterval(3);
+    ASSERT_TRUE(l_sampler.add(1, l_pid));
+    usleep(20000);
+    ASSERT_EQ(l_sampler.sample(l_samples), 1u);
+    unsigned long long l_timeslices = l_samples[0].mainThreadTimeslices;
+
+    usleep(20000);
+    ASSERT_EQ(l_sampler.sample(l_samples), 1u);
+    EXPECT_EQ(l_samples[0].mainThreadTimeslices, l_timeslices);
+    usleep(20000);
+    ASSERT_EQ(l_sampler.sample(l_samples), 1u);
+    EXPECT_GT(l_samples[0].mainThreadTimeslices, l_timeslices);
+
+    // never read
+    l_sampler.setSchedstatInterval(0);
+    ASSERT_TRUE(l_sampler.add(2, l_pid));
+    ASSERT_EQ(l_sampler.sample(l_samples), 2u);
+    EXPECT_EQ(l_samples[1].mainThreadTimeslices, 0u);
+
+    kill(l_pid, SIGKILL);
+    waitpid(l_pid, nullptr, 0);
+}
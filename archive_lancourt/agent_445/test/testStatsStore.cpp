@@ -0,0 +1,214 @@
+#include "statsStore.hpp"
+#include "statsServer.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "mock/mock_iLog.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define STATS_TEST_SOCKET "/tmp/testStatsStore.sock"
+#define STATS_TEST_TIME 1699999200 // multiple of 3600
+
+static Event        newStats(e_sourceType p_sourceType, u_int32_t p_sourceID, std::time_t p_time, int p_cpuUsage,
+                             const std::string &p_payload = "")
+{
+    Event   l_event;
+
+    l_event.sourceID = p_sourceID;
+    l_event.sourceType = p_sourceType;
+    l_event.cpuUsage = p_cpuUsage;
+    l_event.ramUsage = 1000;
+    l_event.upTime = 0;
+    l_event.eventPriority = DEFAULT_PRIORITY;
+    l_event.eventType = STATS;
+    l_event.sendingDate = (u_int64_t)p_time;
+    l_event.eventReceptionTime = p_time;
+    l_event.jsonData = EventPayload(p_payload);
+    return l_event;
+}
+
+TEST(StatsStore, ROLLUP)
+{
+    StatsStore      l_store(4);
+    nlohmann::json  l_values;
+
+    ASSERT_TRUE(l_store.registerSource(AGENT, 1));
+    EXPECT_FALSE(l_store.query(AGENT, 1, "threads", STATS_SECOND, 0, l_values));
+
+    // 3 minutes, a value each second, 2 values in the last second
+    for (int i = 0; i < 180; i++)
+        ASSERT_TRUE(l_store.record(AGENT, 1, newStats(AGENT, 1, STATS_TEST_TIME + i, i, "{\"threads\": 4, \"state\": \"up\"}")));
+    ASSERT_TRUE(l_store.record(AGENT, 1, newStats(AGENT, 1, STATS_TEST_TIME + 179, 500)));
+
+    ASSERT_TRUE(l_store.query(AGENT, 1, "cpuUsage", STATS_SECOND, STATS_TEST_TIME + 170, l_values));
+    ASSERT_EQ(l_values.size(), 10u);
+    EXPECT_EQ(l_values[0][0].get<int64_t>(), STATS_TEST_TIME + 170);
+    EXPECT_EQ(l_values[0][1].get<int>(), 170);
+    EXPECT_EQ(l_values[9][1].get<int>(), 500);
+
+    // [time, min, max, avg, last, count]
+    ASSERT_TRUE(l_store.query(AGENT, 1, "cpuUsage", STATS_MINUTE, 0, l_values));
+    ASSERT_EQ(l_values.size(), 3u);
+    EXPECT_EQ(l_values[0][0].get<int64_t>(), STATS_TEST_TIME - STATS_TEST_TIME % 60);
+    EXPECT_EQ(l_values[2][2].get<int>(), 500);
+    EXPECT_EQ(l_values[2][4].get<int>(), 500);
+    EXPECT_EQ(l_values[2][5].get<int>(), 61);
+
+    ASSERT_TRUE(l_store.query(AGENT, 1, "threads", STATS_HOUR, 0, l_values));
+    ASSERT_EQ(l_values.size(), 1u);
+    EXPECT_EQ(l_values[0][1].get<int>(), 4);
+    EXPECT_EQ(l_values[0][3].get<int>(), 4);
+    EXPECT_EQ(l_values[0][5].get<int>(), 180);
+
+    // the string field is not a metric, upTime was never sent
+    EXPECT_FALSE(l_store.query(AGENT, 1, "state", STATS_SECOND, 0, l_values));
+    ASSERT_TRUE(l_store.query(AGENT, 1, "upTime", STATS_SECOND, 0, l_values));
+    EXPECT_TRUE(l_values.empty());
+}
+
+TEST(StatsStore, PAYLOAD_METRICS)
+{
+    StatsStore      l_store(4);
+    nlohmann::json  l_values;
+    nlohmann::json  l_metrics;
+
+    ASSERT_TRUE(l_store.registerSource(AGENT, 1));
+
+    // the sample of the observer and the counters of the status page, the identifiers are not kept
+    for (int i = 0; i < 10; i++)
+        ASSERT_TRUE(l_store.record(AGENT, 1, newStats(AGENT, 1, STATS_TEST_TIME + i, 1,
+            "{\"event\": \"moduleStats\", \"moduleId\": 1, \"pid\": 4242, \"cpuTicks\": " + std::to_string(100 * i) +
+            ", \"threads\": 4, \"mainThreadTimeslices\": 12, \"status\": {\"state\": 1, \"heartbeatAge\": 20, \"counters\": [" +
+            std::to_string(i) + ", 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, " + std::to_string(2 * i) + "]}}")));
+
+    EXPECT_FALSE(l_store.query(AGENT, 1, "moduleId", STATS_SECOND, 0, l_values));
+    EXPECT_FALSE(l_store.query(AGENT, 1, "pid", STATS_SECOND, 0, l_values));
+    EXPECT_FALSE(l_store.query(AGENT, 1, "cpuTicks", STATS_SECOND, 0, l_values));
+    EXPECT_FALSE(l_store.query(AGENT, 1, "status.state", STATS_SECOND, 0, l_values));
+    EXPECT_TRUE(l_store.query(AGENT, 1, "mainThreadTimeslices", STATS_SECOND, 0, l_values));
+    EXPECT_TRUE(l_store.query(AGENT, 1, "status.heartbeatAge", STATS_SECOND, 0, l_values));
+
+    // every counter of the page has its series, the ones past STATUS_PAGE_COUNTERS are ignored
+    ASSERT_TRUE(l_store.query(AGENT, 1, "status.counters.0", STATS_MINUTE, 0, l_values));
+    ASSERT_EQ(l_values.size(), 1u);
+    EXPECT_EQ(l_values[0][2].get<int>(), 9);
+    EXPECT_TRUE(l_store.query(AGENT, 1, "status.counters.15", STATS_SECOND, 0, l_values));
+    EXPECT_FALSE(l_store.query(AGENT, 1, "status.counters.16", STATS_SECOND, 0, l_values));
+
+    l_metrics = l_store.sources()[0].at("metrics");
+    EXPECT_EQ(l_metrics.size(), (size_t)STATS_METRIC_COUNT);
+
+    // a source the controller did not register gets no series
+    EXPECT_FALSE(l_store.record(CAPTURE, 1, newStats(CAPTURE, 1, STATS_TEST_TIME + 10, 1, "{\"threads\": 4}")));
+    EXPECT_EQ(l_store.size(), 1u);
+}
+
+TEST(StatsStore, WRAP)
+{
+    StatsStore      l_store(4);
+    nlohmann::json  l_values;
+
+    ASSERT_TRUE(l_store.registerSource(CAPTURE, 7));
+
+    // 10 min of values : the seconds ring keeps the last 5 min
+    for (int i = 0; i < 600; i++)
+        ASSERT_TRUE(l_store.record(CAPTURE, 7, newStats(CAPTURE, 7, STATS_TEST_TIME + i, i)));
+
+    ASSERT_TRUE(l_store.query(CAPTURE, 7, "cpuUsage", STATS_SECOND, 0, l_values));
+    ASSERT_EQ(l_values.size(), (size_t)STATS_SECOND_SLOTS);
+    EXPECT_EQ(l_values[0][1].get<int>(), 600 - STATS_SECOND_SLOTS);
+
+    // silent for 3 h : the minutes before are out of the ring, not returned
+    ASSERT_TRUE(l_store.record(CAPTURE, 7, newStats(CAPTURE, 7, STATS_TEST_TIME + 3 * 3600, 1)));
+    ASSERT_TRUE(l_store.query(CAPTURE, 7, "cpuUsage", STATS_SECOND, 0, l_values));
+    EXPECT_EQ(l_values.size(), 1u);
+    ASSERT_TRUE(l_store.query(CAPTURE, 7, "cpuUsage", STATS_MINUTE, 0, l_values));
+    EXPECT_EQ(l_values.size(), 1u);
+    ASSERT_TRUE(l_store.query(CAPTURE, 7, "cpuUsage", STATS_HOUR, 0, l_values));
+    EXPECT_EQ(l_values.size(), 2u);
+}
+
+TEST(StatsStore, CAPACITY)
+{
+    StatsStore      l_store(2);
+    nlohmann::json  l_json;
+
+    EXPECT_FALSE(l_store.init(0));
+    ASSERT_TRUE(l_store.registerSource(AGENT, 1));
+    EXPECT_FALSE(l_store.init(4));
+
+    // full : a new module is refused, its STATS too
+    ASSERT_TRUE(l_store.registerSource(AGENT, 2));
+    EXPECT_FALSE(l_store.registerSource(AGENT, 3));
+    EXPECT_FALSE(l_store.record(AGENT, 3, newStats(AGENT, 3, STATS_TEST_TIME, 1)));
+    ASSERT_TRUE(l_store.record(AGENT, 2, newStats(AGENT, 2, STATS_TEST_TIME, 1)));
+    EXPECT_EQ(l_store.size(), 2u);
+
+    // a removed module releases its slot, the next one starts with empty series
+    l_store.unregisterSource(AGENT, 2);
+    EXPECT_TRUE(l_store.registerSource(AGENT, 4));
+
+    l_json = l_store.sources();
+    ASSERT_EQ(l_json.size(), 2u);
+    EXPECT_EQ(l_json[0].at("sourceType").get<int>(), (int)AGENT);
+    EXPECT_EQ(l_json[0].at("sourceID").get<int>(), 1);
+    EXPECT_EQ(l_json[1].at("sourceID").get<int>(), 4);
+    EXPECT_EQ(l_json[1].at("lastTime").get<int64_t>(), 0);
+    EXPECT_EQ(l_json[1].at("metrics").size(), (size_t)STATS_FIXED_METRICS);
+}
+
+TEST(StatsStore, ENDPOINT)
+{
+    Mock_ILog       l_mock_ilog(ILOG_TEST_FILE);
+    StatsStore      l_store;
+    StatsServer     l_statsServer(l_store, l_mock_ilog);
+
+    ASSERT_TRUE(l_store.registerSource(AGENT, 1));
+    for (int i = 0; i < 5; i++)
+        ASSERT_TRUE(l_store.record(AGENT, 1, newStats(AGENT, 1, STATS_TEST_TIME + i, 10 + i)));
+
+    ASSERT_TRUE(l_statsServer.init(STATS_TEST_SOCKET));
+    ASSERT_TRUE(l_statsServer.start());
+
+    auto l_request = [](const std::string &p_request) {
+        struct sockaddr_un  l_address;
+        int                 l_socketfd = socket(AF_UNIX, SOCK_STREAM, 0);
+        std::string         l_answer;
+        char                l_buffer[4096];
+        ssize_t             l_length;
+
+        std::memset(&l_address, 0, sizeof(l_address));
+        l_address.sun_family = AF_UNIX;
+        std::strncpy(l_address.sun_path, STATS_TEST_SOCKET, sizeof(l_address.sun_path) - 1);
+        if (connect(l_socketfd, (struct sockaddr *)&l_address, sizeof(l_address)) != 0 ||
+            send(l_socketfd, p_request.data(), p_request.size(), MSG_NOSIGNAL) != (ssize_t)p_request.size())
+        {
+            close(l_socketfd);
+            return nlohmann::json();
+        }
+        while ((l_length = read(l_socketfd, l_buffer, sizeof(l_buffer))) > 0)
+            l_answer.append(l_buffer, (size_t)l_length);
+        close(l_socketfd);
+        return nlohmann::json::parse(l_answer);
+    };
+
+    nlohmann::json l_json = l_request("{\"sourceType\": 3, \"sourceID\": 1, \"metric\": \"cpuUsage\", \"since\": " +
+                                      std::to_string(STATS_TEST_TIME + 3) + "}\n");
+
+    ASSERT_EQ(l_json.at("values").size(), 2u);
+    EXPECT_EQ(l_json.at("values")[1][1].get<int>(), 14);
+
+    EXPECT_EQ(l_request("\n").at("sources").size(), 1u);
+    EXPECT_TRUE(l_request("{\"sourceType\": 3, \"sourceID\": 2, \"metric\": \"cpuUsage\"}\n").count("error"));
+    EXPECT_TRUE(l_request("{\"sourceType\": 3, \"sourceID\": 1, \"metric\": \"cpuUsage\", \"resolution\": \"1d\"}\n").count("error"));
+    EXPECT_TRUE(l_request("not json\n").count("error"));
+
+    l_statsServer.stop();
+    EXPECT_NE(access(STATS_TEST_SOCKET, F_OK), 0);
+
+    // about 280 kB by source
+    EXPECT_LT(StatsStore::sourceBytes(), (size_t)300000);
+}
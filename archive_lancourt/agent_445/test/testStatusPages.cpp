@@ -0,0 +1,129 @@
+#include "statusPages.hpp"
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <ctime>
+#include <thread>
+
+// the module side : map the page by its name and write it like status_page_update (apiShm)
+static StatusPage   *mapPage(const std::string &p_name)
+{
+    int     l_fd = shm_open(p_name.c_str(), O_RDWR, 0);
+    void    *l_address;
+
+    if (l_fd < 0)
+        return nullptr;
+    l_address = mmap(nullptr, STATUS_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, l_fd, 0);
+    close(l_fd);
+    return l_address == MAP_FAILED ? nullptr : static_cast<StatusPage *>(l_address);
+}
+
+static void         writePage(StatusPage *p_page, u_int32_t p_state, u_int64_t p_value, u_int32_t p_count)
+{
+    struct timespec l_now;
+    u_int32_t       l_sequence = __atomic_load_n(&p_page->sequence, __ATOMIC_RELAXED);
+
+    clock_gettime(CLOCK_MONOTONIC, &l_now);
+
+    __atomic_store_n(&p_page->sequence, l_sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&p_page->state, p_state, __ATOMIC_RELAXED);
+    __atomic_store_n(&p_page->heartbeat, (u_int64_t)l_now.tv_sec * 1000000000 + l_now.tv_nsec, __ATOMIC_RELAXED);
+    for (u_int32_t i = 0; i < p_count; i++)
+        __atomic_store_n(&p_page->counters[i], p_value, __ATOMIC_RELAXED);
+    __atomic_store_n(&p_page->counterCount, p_count, __ATOMIC_RELAXED);
+    __atomic_store_n(&p_page->sequence, l_sequence + 2, __ATOMIC_RELEASE);
+}
+
+TEST(StatusPages, SUCCESS)
+{
+    StatusPages     l_pages;
+    ModuleStatus    l_status;
+    std::string     l_name;
+    StatusPage      *l_page;
+
+    ASSERT_TRUE(l_pages.create(7, l_name));
+    EXPECT_EQ(l_name, StatusPages::pageName(7));
+    EXPECT_EQ(l_pages.size(), 1u);
+    EXPECT_FALSE(l_pages.read(8, l_status));
+
+    // before the module writes
+    ASSERT_TRUE(l_pages.read(7, l_status));
+    EXPECT_EQ(l_status.moduleId, 7);
+    EXPECT_EQ(l_status.state, MODULE_STARTING);
+    EXPECT_EQ(l_status.heartbeatAge, -1);
+    EXPECT_EQ(l_status.counterCount, 0u);
+
+    ASSERT_NE(l_page = mapPage(l_name), nullptr);
+    EXPECT_EQ(l_page->magic, (u_int32_t)STATUS_PAGE_MAGIC);
+    EXPECT_EQ(l_page->version, (u_int32_t)STATUS_PAGE_VERSION);
+    l_page->pid = getpid();
+    writePage(l_page, MODULE_RUNNING, 42, 3);
+
+    ASSERT_TRUE(l_pages.read(7, l_status));
+    EXPECT_EQ(l_status.pid, getpid());
+    EXPECT_EQ(l_status.state, MODULE_RUNNING);
+    EXPECT_GE(l_status.heartbeatAge, 0);
+    EXPECT_LT(l_status.heartbeatAge, 1000);
+    ASSERT_EQ(l_status.counterCount, 3u);
+    EXPECT_EQ(l_status.counters[2], 42u);
+
+    // a module writing (or killed while writing) : not read
+    __atomic_store_n(&l_page->sequence, l_page->sequence + 1, __ATOMIC_RELEASE);
+    EXPECT_FALSE(l_pages.read(7, l_status));
+
+    // reset by the launch of the next module
+    ASSERT_TRUE(l_pages.create(7, l_name));
+    ASSERT_TRUE(l_pages.read(7, l_status));
+    EXPECT_EQ(l_status.state, MODULE_STARTING);
+    EXPECT_EQ(l_status.counterCount, 0u);
+
+    // the module keeps its mapping, the name is gone
+    l_pages.remove(7);
+    EXPECT_EQ(l_pages.size(), 0u);
+    EXPECT_EQ(mapPage(l_name), nullptr);
+    munmap(l_page, STATUS_PAGE_SIZE);
+}
+
+TEST(StatusPages, CONSISTENT)
+{
+    StatusPages         l_pages;
+    ModuleStatus        l_status;
+    std::string         l_name;
+    StatusPage          *l_page;
+    std::atomic<bool>   l_isWriting(true);
+    int                 l_readCount = 0;
+
+    ASSERT_TRUE(l_pages.create(9, l_name));
+    ASSERT_NE(l_page = mapPage(l_name), nullptr);
+
+    // every counter of a write holds the same value : a torn copy has two values
+    std::thread l_writer([&] {
+        for (u_int64_t l_value = 1; l_isWriting; l_value++)
+            writePage(l_page, MODULE_RUNNING, l_value, STATUS_PAGE_COUNTERS);
+    });
+
+    // on one cpu the writer may be preempted in the middle of a write : the reader yields to let it finish
+    for (int i = 0; i < 100000 || l_readCount == 0; i++)
+    {
+        if (!l_pages.read(9, l_status) || l_status.counterCount != STATUS_PAGE_COUNTERS)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        l_readCount++;
+        for (u_int32_t j = 1; j < STATUS_PAGE_COUNTERS; j++)
+            ASSERT_EQ(l_status.counters[j], l_status.counters[0]);
+    }
+    l_isWriting = false;
+    l_writer.join();
+
+    EXPECT_GT(l_readCount, 0);
+    munmap(l_page, STATUS_PAGE_SIZE);
+}
@@ -20,7 +20,7 @@ MOCK_LIBC_METHOD3(socket, int(int __domain, int __type, int __protocol));
 MOCK_LIBC_METHOD3(bind, int(int __socketfd, const struct sockaddr *__addr, socklen_t __addrlen));
 MOCK_LIBC_METHOD1(close, int(int __fd));
 
-std::priority_queue<Event, std::vector<Event>, compareEventPriority> *g_eventList;
+EventQueue *g_eventList;
 
 TEST(StatusReceiver, SUCCESS)
 {
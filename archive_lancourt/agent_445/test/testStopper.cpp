@@ -4,50 +4,133 @@
 #include "gmock/gmock.h"
 
 #include "mock/mock_iLog.hpp"
-#include "mock/mock_libc.hpp"
 
 #include <signal.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+#include <chrono>
+
+#ifndef SYS_pidfd_open
+# define SYS_pidfd_open 434
+#endif
+
+#define STOP_TEST_DEADLINE 200 // ms
 
 using ::testing::_;
 using ::testing::Invoke;
 using ::testing::Return;
 
-MOCK_LIBC_METHOD2(kill, int(pid_t, int));
-// MOCK_LIBC_METHOD2(signal, sighandler_t(int, sighandler_t));
+// module ending on its SIGTERM after p_delay ms, or ignoring it when p_delay < 0
+static pid_t    launchFakeModule(int p_delay)
+{
+    pid_t l_pid = fork();
+
+    if (l_pid != 0)
+        return l_pid;
+
+    if (p_delay < 0)
+        signal(SIGTERM, SIG_IGN);
+    else
+        signal(SIGTERM, [](int) {});
+    pause();
+    if (p_delay > 0)
+        usleep(p_delay * 1000);
+    _exit(0);
+}
+
+// module supervised by the observer : its pidfd is handed over with it, the observer (here the test) reaps it
+static ModuleProcess    supervisedModule(pid_t p_pid)
+{
+    ModuleProcess   l_moduleProcess;
+
+    l_moduleProcess.pid = p_pid;
+    l_moduleProcess.pidfd = (int)syscall(SYS_pidfd_open, p_pid, 0);
+    return l_moduleProcess;
+}
+
+static long long    elapsedMs(std::chrono::steady_clock::time_point p_start)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - p_start).count();
+}
 
 TEST(Stopper, SUCCESS)
 {
     Mock_ILog l_mock_ilog(ILOG_TEST_FILE);
     l_mock_ilog.LOG(LOG_DEBUG, "==================== TEST STOPPER.SUCCESS ====================");
 
-    Stopper l_stopper(l_mock_ilog);
+    Stopper l_stopper(l_mock_ilog, STOP_TEST_DEADLINE);
     
-    std::list<pid_t> p_modulePidList;
-    p_modulePidList.emplace_back(36); // fake_pid
-
-    // EXPECT_CALL(MOCK_LIBC_INSTANCE(signal), signal(_, _))
-    //     .WillOnce(
-    //         Invoke(
-    //             [&](int p_signum, sighandler_t p_handler) -> sighandler_t {
-    //                 EXPECT_EQ(p_signum, SIGTERM);
-    //                 EXPECT_NEQ(p_handler, ???);
-    //                 return ???;
-    //             }));
-
-    EXPECT_CALL(MOCK_LIBC_INSTANCE(kill), kill(_, _))
-        .WillOnce(
-            Invoke(
-                [&](pid_t p_pid, int p_sigNum) -> int {
-                    EXPECT_EQ(p_pid, p_modulePidList.front());
-                    EXPECT_EQ(p_sigNum, SIGTERM);
-                    return 0;
-                }));
+    std::list<ModuleProcess> p_moduleProcessList;
+
+    // stopped in parallel : bounded by the slowest module, not by the sum
+    for (int i = 0; i < 4; i++)
+        p_moduleProcessList.emplace_back(supervisedModule(launchFakeModule(50)));
+    usleep(20000);
 
     l_mock_ilog.LOG(LOG_DEBUG, "++++++++++++++++++++> [stopper.success.test1] l_stopper.init");
     EXPECT_EQ(l_stopper.init(), IStopper::eInit::SUCCESS);
 
+    auto l_start = std::chrono::steady_clock::now();
+
     l_mock_ilog.LOG(LOG_DEBUG, "++++++++++++++++++++> [stopper.success.test1] l_stopper.stopModule");
-    EXPECT_EQ(l_stopper.stopModule(p_modulePidList), IStopper::eStopModule::SUCCESS);
+    EXPECT_EQ(l_stopper.stopModule(p_moduleProcessList), IStopper::eStopModule::SUCCESS);
+    EXPECT_LT(elapsedMs(l_start), 4 * 50);
+
+    // left to the observer
+    for (const ModuleProcess &l_moduleProcess : p_moduleProcessList)
+        EXPECT_EQ(waitpid(l_moduleProcess.pid, nullptr, WNOHANG), l_moduleProcess.pid);
+}
+
+TEST(Stopper, ESCALATION)
+{
+    Mock_ILog l_mock_ilog(ILOG_TEST_FILE);
+    l_mock_ilog.LOG(LOG_DEBUG, "==================== TEST STOPPER.ESCALATION ====================");
+
+    Stopper l_stopper(l_mock_ilog, STOP_TEST_DEADLINE);
+
+    std::list<ModuleProcess> p_moduleProcessList;
+    int                      l_status;
+
+    p_moduleProcessList.emplace_back(supervisedModule(launchFakeModule(-1)));
+    p_moduleProcessList.emplace_back(supervisedModule(launchFakeModule(0)));
+    usleep(20000);
+
+    auto l_start = std::chrono::steady_clock::now();
+
+    // the module ignoring SIGTERM is killed at the deadline
+    EXPECT_EQ(l_stopper.stopModule(p_moduleProcessList), IStopper::eStopModule::SUCCESS);
+    EXPECT_GE(elapsedMs(l_start), STOP_TEST_DEADLINE);
+    EXPECT_LT(elapsedMs(l_start), STOP_TEST_DEADLINE + STOP_KILL_DEADLINE);
+
+    EXPECT_EQ(waitpid(p_moduleProcessList.front().pid, &l_status, 0), p_moduleProcessList.front().pid);
+    EXPECT_TRUE(WIFSIGNALED(l_status));
+    EXPECT_EQ(WTERMSIG(l_status), SIGKILL);
+    EXPECT_EQ(waitpid(p_moduleProcessList.back().pid, &l_status, 0), p_moduleProcessList.back().pid);
+    EXPECT_TRUE(WIFEXITED(l_status));
+}
+
+TEST(Stopper, UNSUPERVISED)
+{
+    Mock_ILog l_mock_ilog(ILOG_TEST_FILE);
+    l_mock_ilog.LOG(LOG_DEBUG, "==================== TEST STOPPER.UNSUPERVISED ====================");
+
+    Stopper l_stopper(l_mock_ilog, STOP_TEST_DEADLINE);
+
+    std::list<ModuleProcess> p_moduleProcessList;
+    ModuleProcess            l_moduleProcess;
+
+    // not watched by the observer (pidfd -1) : nobody else reaps it
+    l_moduleProcess.pid = launchFakeModule(0);
+    p_moduleProcessList.emplace_back(l_moduleProcess);
+    usleep(20000);
+
+    auto l_start = std::chrono::steady_clock::now();
+
+    EXPECT_EQ(l_stopper.stopModule(p_moduleProcessList), IStopper::eStopModule::SUCCESS);
+    EXPECT_LT(elapsedMs(l_start), STOP_TEST_DEADLINE);
+    EXPECT_EQ(waitpid(l_moduleProcess.pid, nullptr, WNOHANG), -1);
+    EXPECT_EQ(errno, ECHILD);
 }
 
 TEST(Stopper, FAILURE)
@@ -55,24 +138,21 @@ TEST(Stopper, FAILURE)
     Mock_ILog l_mock_ilog(ILOG_TEST_FILE);
     l_mock_ilog.LOG(LOG_DEBUG, "==================== TEST STOPPER.FAIL ====================");
 
-    Stopper l_stopper(l_mock_ilog);
+    Stopper l_stopper(l_mock_ilog, STOP_TEST_DEADLINE);
     
-    std::list<pid_t> p_modulePidList;
-    p_modulePidList.emplace_back(36); // fake_pid
-
-    EXPECT_CALL(MOCK_LIBC_INSTANCE(kill), kill(_, _))
-        .WillOnce(
-            Invoke(
-                [&](pid_t p_pid, int p_sigNum) -> int {
-                    EXPECT_EQ(p_pid, p_modulePidList.front());
-                    EXPECT_EQ(p_sigNum, SIGTERM);
-                    return -1;
-                }));
+    std::list<ModuleProcess> p_moduleProcessList;
+    ModuleProcess            l_moduleProcess;
+
+    // a pid already reaped can not be signaled
+    l_moduleProcess.pid = launchFakeModule(0);
+    kill(l_moduleProcess.pid, SIGKILL);
+    waitpid(l_moduleProcess.pid, nullptr, 0);
+    p_moduleProcessList.emplace_back(l_moduleProcess);
 
 // stopper.init returs always SUCCESS
     l_mock_ilog.LOG(LOG_DEBUG, "++++++++++++++++++++> [stopper.failure.test2] l_stopper.init -> SUCCESS");
     EXPECT_EQ(l_stopper.init(), IStopper::eInit::SUCCESS);
 
     l_mock_ilog.LOG(LOG_DEBUG, "++++++++++++++++++++> [stopper.failure.test2] l_stopper.stopModule -> FAILURE ");
-    EXPECT_EQ(l_stopper.stopModule(p_modulePidList), IStopper::eStopModule::FAILURE);
-}
\ No newline at end of file
+    EXPECT_EQ(l_stopper.stopModule(p_moduleProcessList), IStopper::eStopModule::FAILURE);
+}
@@ -0,0 +1,64 @@
+#ifndef _COLLECTOR_HPP_
+#define _COLLECTOR_HPP_
+
+#include "collectorReceiver.hpp"
+#include "collectorShard.hpp"
+#include "iLog.hpp"
+
+#include "json.hpp"
+
+#include <memory>
+#include <vector>
+
+# define COLLECTOR_RECEIVER_COUNT 1 // default "receiverCount"
+# define COLLECTOR_SHARD_COUNT 2 // default "shardCount"
+# define COLLECTOR_RING_SIZE (1024 * 1024) // default "shard_ringSize", bytes of the ring of each (receiver, shard)
+# define COLLECTOR_SOURCE_CAPACITY 4096 // default "shard_sourceCapacity", sources of each shard
+
+class SnapshotServer;
+
+// Collector of the notifications of the agents and of the visions (collectorReceiverHost / collectorReceiverPort)
+// receivers -> rings (one per receiver and shard) -> shards, a source is always decoded by the same shard
+class Collector
+{
+
+public:
+
+    explicit Collector(ILog &p_log);
+    ~Collector(void);
+
+    Collector(const Collector &p_source) = delete;
+    Collector &operator=(const Collector &p_source) = delete;
+
+    // create the shards and the receivers, bind the sockets
+    bool                                init(const nlohmann::json &p_json);
+
+    // launch the shards, then the receivers and the snapshot server
+    bool                                start(void);
+
+    // stop the receivers, then the shards once they decoded the datagrams received
+    void                                stop(void);
+
+    // counters of the receivers and of the shards, and the aggregate of every source if p_hasSources
+    nlohmann::json                      toJson(bool p_hasSources = true) const;
+
+    // notifications decoded by the shards
+    u_int64_t                           decodedCount(void) const;
+
+    // notifications received by the receivers
+    u_int64_t                           receivedCount(void) const;
+
+    // aggregate of a source, nullptr if it never sent a notification
+    const SourceStats                   *findSource(u_int32_t p_sourceID) const;
+
+private:
+
+    ILog                                &i_log;
+
+    std::vector<std::unique_ptr<CollectorShard>>    i_shards;
+    std::vector<std::unique_ptr<CollectorReceiver>> i_receivers;
+    std::unique_ptr<SnapshotServer>                 i_snapshotServer;
+
+}; // end class Collector
+
+#endif
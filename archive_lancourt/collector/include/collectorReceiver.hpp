@@ -0,0 +1,85 @@
+#ifndef _COLLECTOR_RECEIVER_HPP_
+#define _COLLECTOR_RECEIVER_HPP_
+
+#include "collectorShard.hpp"
+#include "iLog.hpp"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+# define BUFFER_LEN 2000 // biggest notification, like the StatusReceiver of the agent
+# define RECEIVE_BATCH 64 // datagrams read by one recvmmsg
+
+// Reception of the notifications : one udp socket per receiver on the same port (SO_REUSEPORT,
+// the kernel spreads the senders over the receivers), plus the Unix datagram socket for the first one
+// the datagrams are not decoded : only their sourceID is read to push them to the shard of the source
+class CollectorReceiver
+{
+
+public:
+
+    CollectorReceiver(int p_id, std::vector<std::unique_ptr<CollectorShard>> &p_shards, ILog &p_log);
+    ~CollectorReceiver(void);
+
+    CollectorReceiver(const CollectorReceiver &p_source) = delete;
+    CollectorReceiver &operator=(const CollectorReceiver &p_source) = delete;
+
+    // bind the udp socket (port 0 : no udp) and, if p_unixPath is not empty, the Unix socket
+    bool                                init(const std::string &p_host, int p_port, int p_receiveBufferSize,
+                                             const std::string &p_unixPath);
+
+    bool                                start(void);
+
+    // stop the thread, close the sockets and remove the Unix socket file
+    void                                stop(void);
+
+    // received, invalid, bytes
+    nlohmann::json                      toJson(void) const;
+
+    u_int64_t                           receivedCount(void) const;
+
+    // read the sourceID (field 1) of a serialized Notifications without decoding it, false if it has none
+    static bool                         peekSourceID(const char *p_data, size_t p_length, u_int32_t &p_sourceID);
+
+private:
+
+    const int                           i_id;
+    std::vector<std::unique_ptr<CollectorShard>> &i_shards;
+    ILog                                &i_log;
+
+    int                                 i_udpSocketfd;
+    int                                 i_unixSocketfd;
+    std::string                         i_unixPath;
+    int                                 i_stopEventfd;
+    std::atomic<bool>                   i_isRunning;
+    std::thread                         i_thread;
+
+    // preallocated reception buffers of recvmmsg, one per datagram of a batch
+    std::vector<char>                   i_receiveBuffers;
+    std::vector<iovec>                  i_receiveIovecs;
+    std::vector<mmsghdr>                i_receiveMessages;
+
+    // shards given a datagram by the current batch, woken up after it
+    std::vector<bool>                   i_isShardPushed;
+
+    std::atomic<u_int64_t>              i_receivedCount;
+    std::atomic<u_int64_t>              i_invalidCount; // truncated or without sourceID
+    std::atomic<u_int64_t>              i_bytes;
+
+    // thread of the receiver : wait on the sockets in epoll, drain them by batches
+    void                                receive(void);
+
+    // read up to RECEIVE_BATCH datagrams of p_socketfd and push them to their shards, return the number read
+    int                                 receiveBatch(int p_socketfd);
+
+    bool                                bindUnix(const std::string &p_unixPath, int p_receiveBufferSize);
+
+}; // end class CollectorReceiver
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef _COLLECTOR_SHARD_HPP_
+#define _COLLECTOR_SHARD_HPP_
+
+#include "iLog.hpp"
+#include "shardRing.hpp"
+#include "sourceTable.hpp"
+
+#include "notifications.pb.h"
+
+#include <google/protobuf/arena.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+# define SHARD_BATCH 256 // datagrams decoded from one ring before the next ring, the arena is reset after each batch
+# define SHARD_ARENA_BLOCK_SIZE (64 * 1024) // first block of the decoding arena, reused by every batch
+# define SHARD_SPIN_COUNT 64 // empty rounds over the rings before the shard sleeps
+# define SHARD_SLEEP_TIMEOUT 100 // ms, a sleeping shard looks at its rings at least this often
+
+// Decoding and aggregation of the notifications of the sources sharing sourceID % shardCount
+// the receivers push the datagrams in its rings (one per receiver), its thread decodes them
+// and aggregates them in its own SourceTable : no lock, no source shared between two shards
+class CollectorShard
+{
+
+public:
+
+    // p_receiverCount rings of p_ringCapacity bytes, p_sourceCapacity sources
+    CollectorShard(int p_id, int p_receiverCount, size_t p_ringCapacity, size_t p_sourceCapacity, ILog &p_log);
+    ~CollectorShard(void);
+
+    CollectorShard(const CollectorShard &p_source) = delete;
+    CollectorShard &operator=(const CollectorShard &p_source) = delete;
+
+    bool                                start(void);
+
+    // decode the datagrams left in the rings, then stop the thread
+    void                                stop(void);
+
+    // receiver p_receiver : copy a datagram in its ring, false if the ring is full (counted in dropped)
+    bool                                push(int p_receiver, const char *p_data, u_int32_t p_length);
+
+    // receivers : wake up the thread if it sleeps, after a batch of push
+    void                                wake(void);
+
+    // decode and aggregate a notification, called by the thread of the shard (public for the tests)
+    bool                                process(const char *p_data, u_int32_t p_length);
+
+    const SourceTable                   &sources(void) const;
+
+    // decoded, invalid, dropped, tableFull, pendingBytes and sources
+    nlohmann::json                      toJson(void) const;
+
+    u_int64_t                           decodedCount(void) const;
+    size_t                              pendingBytes(void) const;
+
+private:
+
+    const int                           i_id;
+    ILog                                &i_log;
+
+    std::vector<std::unique_ptr<ShardRing>> i_rings; // one per receiver
+
+    SourceTable                         i_sources;
+
+    // the notifications of a batch are decoded in the arena, reset after the batch
+    std::vector<char>                   i_arenaBlock;
+    std::unique_ptr<google::protobuf::Arena> i_arena;
+
+    std::atomic<bool>                   i_isRunning;
+    std::atomic<bool>                   i_isSleeping;
+    int                                 i_wakeEventfd;
+    std::thread                         i_thread;
+
+    std::atomic<u_int64_t>              i_decodedCount;
+    std::atomic<u_int64_t>              i_invalidCount; // not a Notifications
+    std::atomic<u_int64_t>              i_tableFullCount; // notifications of a source not fitting in i_sources
+    std::unique_ptr<std::atomic<u_int64_t>[]> i_droppedCounts; // full ring, by receiver
+
+    // thread of the shard : drain the rings, sleep when they stay empty
+    void                                run(void);
+
+    // decode up to SHARD_BATCH datagrams of each ring, return the number decoded
+    size_t                              drain(void);
+
+    // the rings are empty
+    bool                                isEmpty(void) const;
+
+    // wait for wake or SHARD_SLEEP_TIMEOUT
+    void                                sleep(void);
+
+}; // end class CollectorShard
+
+#endif
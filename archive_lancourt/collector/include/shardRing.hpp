@@ -0,0 +1,59 @@
+#ifndef _SHARD_RING_HPP_
+#define _SHARD_RING_HPP_
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <vector>
+
+# define RING_RECORD_ALIGN 8 // a record starts on a multiple of 8 bytes
+# define RING_WRAP_RECORD 0xFFFFFFFF // length of the record filling the end of the buffer, the next one is at the start
+
+// Single producer (a receiver thread) single consumer (a shard thread) ring of datagrams
+// a record : its length (u_int32_t) then the datagram, aligned on RING_RECORD_ALIGN
+// the datagrams are read in place by the consumer : front, then pop once it is decoded
+class ShardRing
+{
+
+public:
+
+    // p_capacity bytes, rounded up to a power of 2
+    explicit ShardRing(size_t p_capacity);
+
+    ShardRing(const ShardRing &p_source) = delete;
+    ShardRing &operator=(const ShardRing &p_source) = delete;
+
+    // producer : copy a datagram, false if the ring is full (the datagram is dropped)
+    bool                                push(const char *p_data, u_int32_t p_length);
+
+    // consumer : the oldest datagram, nullptr if the ring is empty
+    const char                          *front(u_int32_t &p_length);
+
+    // consumer : release the datagram returned by front
+    void                                pop(void);
+
+    // bytes used, read by any thread
+    size_t                              pendingBytes(void) const;
+
+    size_t                              capacity(void) const;
+
+    // bytes taken by a datagram of p_length in the ring
+    static size_t                       recordSize(u_int32_t p_length);
+
+private:
+
+    std::vector<u_int64_t>              i_buffer; // u_int64_t : the records are aligned
+    char                                *i_data;
+    size_t                              i_capacity;
+
+    std::atomic<u_int64_t>              i_head; // bytes written by the producer since the creation
+    u_int64_t                           i_cachedTail; // last tail read by the producer
+    char                                i_headPadding[64]; // head and tail on their own cache lines
+    std::atomic<u_int64_t>              i_tail; // bytes released by the consumer since the creation
+    u_int64_t                           i_cachedHead; // last head read by the consumer
+    u_int64_t                           i_frontSize; // bytes of the record returned by front, with the wrap record before it
+    char                                i_tailPadding[64];
+
+}; // end class ShardRing
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef _SNAPSHOT_SERVER_HPP_
+#define _SNAPSHOT_SERVER_HPP_
+
+#include "unixSocketServer.hpp"
+
+#include <string>
+
+# define SNAPSHOT_SEND_TIMEOUT 100 // ms, a reader not reading its socket is dropped
+
+class Collector;
+
+// Local endpoint of the aggregates : a Unix stream socket,
+// each client connecting gets the json of Collector::toJson, then the socket is closed
+// (ex. socat - UNIX-CONNECT:/run/collector/snapshot.sock)
+class SnapshotServer : public UnixSocketServer
+{
+
+public:
+
+    SnapshotServer(const Collector &p_collector, ILog &p_log);
+    ~SnapshotServer(void);
+
+private:
+
+    const Collector                     &i_collector;
+
+    // the snapshot, the client sends nothing
+    std::string                         answer(const std::string &p_request) override;
+
+}; // end class SnapshotServer
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _SOURCE_TABLE_HPP_
+#define _SOURCE_TABLE_HPP_
+
+#include "json.hpp"
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <memory>
+
+# define NOTIFICATION_TYPE_COUNT 3 // CONFIG, ALERT, STATS (Notifications::NotificationType)
+# define NOTIFICATION_PRIORITY_COUNT 4 // DEFAULT_PRIORITY, WARNING, ERROR, FATAL (Notifications::Priority)
+
+// Aggregate of the notifications of one source
+// written by the thread of its shard only, read by any thread : every field is atomic, relaxed,
+// a reader may see the counters of a notification before its last values
+struct SourceStats
+{
+    std::atomic<u_int64_t>              key; // sourceID + 1, 0 : free entry
+    std::atomic<u_int32_t>              sourceType;
+    std::atomic<u_int64_t>              notifications[NOTIFICATION_TYPE_COUNT]; // by notificationType
+    std::atomic<u_int64_t>              priorities[NOTIFICATION_PRIORITY_COUNT]; // by priority
+    std::atomic<u_int64_t>              bytes; // serialized notifications
+    std::atomic<int64_t>                cpuUsage; // last values sent by the source
+    std::atomic<int64_t>                ramUsage;
+    std::atomic<u_int64_t>              upTime;
+    std::atomic<u_int64_t>              sendingDate;
+    std::atomic<int64_t>                firstReception; // s, time of the collector
+    std::atomic<int64_t>                lastReception;
+};
+
+// Open addressing table of the sources of one shard, never shrinks (a source is kept until the collector stops)
+// one writer (the shard), readers without lock (the snapshots)
+class SourceTable
+{
+
+public:
+
+    // p_capacity sources, rounded up to a power of 2
+    explicit SourceTable(size_t p_capacity);
+
+    SourceTable(const SourceTable &p_source) = delete;
+    SourceTable &operator=(const SourceTable &p_source) = delete;
+
+    // writer : the entry of a source, added at its first notification, nullptr if the table is full
+    SourceStats                         *insert(u_int32_t p_sourceID);
+
+    // any thread : the entry of a source, nullptr if it never sent a notification
+    const SourceStats                   *find(u_int32_t p_sourceID) const;
+
+    // any thread : sources in the table
+    size_t                              size(void) const;
+
+    size_t                              capacity(void) const;
+
+    // any thread : the entries of the sources, appended to p_json (an array)
+    void                                toJson(nlohmann::json &p_json) const;
+
+    static nlohmann::json               toJson(const SourceStats &p_stats);
+
+private:
+
+    std::unique_ptr<SourceStats[]>      i_entries;
+    size_t                              i_capacity;
+    std::atomic<size_t>                 i_size;
+
+    // first entry probed for a source : sourceIDs are often consecutive, they are mixed
+    size_t                              slotOf(u_int32_t p_sourceID) const;
+
+}; // end class SourceTable
+
+#endif
@@ -0,0 +1,189 @@
+#include "collector.hpp"
+#include "snapshotServer.hpp"
+
+/**
+ * @brief
+ * Construct a new Collector:: Collector object
+ *
+ * @param p_log
+ */
+Collector::Collector(ILog &p_log) : i_log(p_log)
+{
+}
+
+Collector::~Collector(void)
+{
+    stop();
+}
+
+/**
+ * @brief
+ * Read the configuration, create the shards and the receivers and bind their sockets
+ * a shard has one ring per receiver : each ring has one producer and one consumer
+ *
+ * @param p_json
+ * @return bool
+ */
+bool                                Collector::init(const nlohmann::json &p_json)
+{
+    i_log.log(LOG_INFO, "Collector::%s", __func__);
+
+    std::string l_host;
+    int         l_port;
+    int         l_receiveBufferSize;
+    std::string l_unixPath;
+    std::string l_snapshotPath;
+    int         l_receiverCount;
+    int         l_shardCount;
+    size_t      l_ringSize;
+    size_t      l_sourceCapacity;
+
+    try
+    {
+        l_host = p_json.value("protobuf_host", std::string("0.0.0.0"));
+        l_port = p_json.value("protobuf_port", 0);
+        l_receiveBufferSize = p_json.value("protobuf_receiveBufferSize", 0);
+        l_unixPath = p_json.value("unix_socketPath", std::string());
+        l_snapshotPath = p_json.value("snapshot_socketPath", std::string());
+        l_receiverCount = p_json.value("receiverCount", COLLECTOR_RECEIVER_COUNT);
+        l_shardCount = p_json.value("shardCount", COLLECTOR_SHARD_COUNT);
+        l_ringSize = p_json.value("shard_ringSize", (size_t)COLLECTOR_RING_SIZE);
+        l_sourceCapacity = p_json.value("shard_sourceCapacity", (size_t)COLLECTOR_SOURCE_CAPACITY);
+    }
+    catch (const std::exception &e)
+    {
+        i_log.log(LOG_ERR, "Collector::%s - invalid configuration : %s", __func__, e.what());
+        return false;
+    }
+
+    if ((l_port <= 0 && l_unixPath.empty()) || l_receiverCount <= 0 || l_shardCount <= 0 ||
+        l_ringSize < ShardRing::recordSize(BUFFER_LEN) * 2)
+    {
+        i_log.log(LOG_ERR, "Collector::%s - invalid configuration : port [%d] unix [%s] receivers [%d] shards [%d] ring [%zu]",
+                  __func__, l_port, l_unixPath.c_str(), l_receiverCount, l_shardCount, l_ringSize);
+        return false;
+    }
+
+    for (int i = 0; i < l_shardCount; i++)
+        i_shards.emplace_back(new CollectorShard(i, l_receiverCount, l_ringSize, l_sourceCapacity, i_log));
+
+    for (int i = 0; i < l_receiverCount; i++)
+    {
+        i_receivers.emplace_back(new CollectorReceiver(i, i_shards, i_log));
+
+        // the local senders are few : one receiver reads the Unix socket
+        if (!i_receivers.back()->init(l_host, l_port, l_receiveBufferSize, i == 0 ? l_unixPath : std::string()))
+            return false;
+    }
+
+    if (!l_snapshotPath.empty())
+    {
+        i_snapshotServer.reset(new SnapshotServer(*this, i_log));
+        if (!i_snapshotServer->init(l_snapshotPath))
+            return false;
+    }
+
+    return true;
+}
+
+bool                                Collector::start(void)
+{
+    i_log.log(LOG_INFO, "Collector::%s - %zu receivers, %zu shards", __func__, i_receivers.size(), i_shards.size());
+
+    for (std::unique_ptr<CollectorShard> &l_shard : i_shards)
+        if (!l_shard->start())
+            return false;
+
+    for (std::unique_ptr<CollectorReceiver> &l_receiver : i_receivers)
+        if (!l_receiver->start())
+            return false;
+
+    return !i_snapshotServer || i_snapshotServer->start();
+}
+
+void                                Collector::stop(void)
+{
+    if (i_snapshotServer)
+        i_snapshotServer->stop();
+
+    for (std::unique_ptr<CollectorReceiver> &l_receiver : i_receivers)
+        l_receiver->stop();
+
+    for (std::unique_ptr<CollectorShard> &l_shard : i_shards)
+        l_shard->stop();
+}
+
+/**
+ * @brief
+ * Built without stopping anything : the counters are read while the receivers and the shards run
+ * "received" minus "decoded" are the notifications waiting in the rings, dropped or invalid
+ *
+ * @param p_hasSources
+ * @return nlohmann::json
+ */
+nlohmann::json                      Collector::toJson(bool p_hasSources) const
+{
+    nlohmann::json  l_json;
+    nlohmann::json  &l_collector = l_json["collector"];
+    u_int64_t       l_dropped = 0;
+    u_int64_t       l_invalid = 0;
+    u_int64_t       l_pendingBytes = 0;
+
+    l_collector["receivers"] = nlohmann::json::array();
+    l_collector["shards"] = nlohmann::json::array();
+
+    for (const std::unique_ptr<CollectorReceiver> &l_receiver : i_receivers)
+    {
+        l_collector["receivers"].push_back(l_receiver->toJson());
+        l_invalid += l_collector["receivers"].back().at("invalid").get<u_int64_t>();
+    }
+    for (const std::unique_ptr<CollectorShard> &l_shard : i_shards)
+    {
+        l_collector["shards"].push_back(l_shard->toJson());
+        l_dropped += l_collector["shards"].back().at("dropped").get<u_int64_t>();
+        l_invalid += l_collector["shards"].back().at("invalid").get<u_int64_t>();
+        l_pendingBytes += l_collector["shards"].back().at("pendingBytes").get<u_int64_t>();
+    }
+
+    l_collector["received"] = receivedCount();
+    l_collector["decoded"] = decodedCount();
+    l_collector["dropped"] = l_dropped;
+    l_collector["invalid"] = l_invalid;
+    l_collector["pendingBytes"] = l_pendingBytes;
+
+    if (p_hasSources)
+    {
+        nlohmann::json  &l_sources = l_json["sources"];
+
+        l_sources = nlohmann::json::array();
+        for (const std::unique_ptr<CollectorShard> &l_shard : i_shards)
+            l_shard->sources().toJson(l_sources);
+    }
+
+    return l_json;
+}
+
+u_int64_t                           Collector::decodedCount(void) const
+{
+    u_int64_t   l_decoded = 0;
+
+    for (const std::unique_ptr<CollectorShard> &l_shard : i_shards)
+        l_decoded += l_shard->decodedCount();
+    return l_decoded;
+}
+
+u_int64_t                           Collector::receivedCount(void) const
+{
+    u_int64_t   l_received = 0;
+
+    for (const std::unique_ptr<CollectorReceiver> &l_receiver : i_receivers)
+        l_received += l_receiver->receivedCount();
+    return l_received;
+}
+
+const SourceStats                   *Collector::findSource(u_int32_t p_sourceID) const
+{
+    if (i_shards.empty())
+        return nullptr;
+    return i_shards[p_sourceID % i_shards.size()]->sources().find(p_sourceID);
+}
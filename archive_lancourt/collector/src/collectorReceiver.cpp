@@ -0,0 +1,395 @@
+#include "collectorReceiver.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+/**
+ * @brief
+ * Construct a new Collector Receiver:: Collector Receiver object
+ *
+ * @param p_id index of the rings of the receiver in the shards
+ * @param p_shards
+ * @param p_log
+ */
+CollectorReceiver::CollectorReceiver(int p_id, std::vector<std::unique_ptr<CollectorShard>> &p_shards,
+                                     ILog &p_log) : i_id(p_id),
+                                                    i_shards(p_shards),
+                                                    i_log(p_log),
+                                                    i_udpSocketfd(-1),
+                                                    i_unixSocketfd(-1),
+                                                    i_stopEventfd(-1),
+                                                    i_isRunning(false),
+                                                    i_receivedCount(0),
+                                                    i_invalidCount(0),
+                                                    i_bytes(0)
+{
+    i_receiveBuffers.resize(RECEIVE_BATCH * BUFFER_LEN);
+    i_receiveIovecs.resize(RECEIVE_BATCH);
+    i_receiveMessages.resize(RECEIVE_BATCH);
+    i_isShardPushed.resize(p_shards.size(), false);
+}
+
+CollectorReceiver::~CollectorReceiver(void)
+{
+    stop();
+}
+
+/**
+ * @brief
+ * Bind the udp socket with SO_REUSEPORT : every receiver binds the same port
+ * and the kernel gives each sender (address and port) to one of them
+ *
+ * @param p_host
+ * @param p_port 0 : no udp socket
+ * @param p_receiveBufferSize 0 : default of the kernel
+ * @param p_unixPath empty : no Unix socket
+ * @return bool
+ */
+bool                                CollectorReceiver::init(const std::string &p_host, int p_port, int p_receiveBufferSize,
+                                                            const std::string &p_unixPath)
+{
+    i_log.log(LOG_INFO, "CollectorReceiver::%s - receiver [%d] [%s:%d] [%s]", __func__, i_id, p_host.c_str(), p_port, p_unixPath.c_str());
+
+    if ((i_stopEventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0)
+    {
+        i_log.log(LOG_ERR, "CollectorReceiver::%s - eventfd : %s", __func__, strerror(errno));
+        return false;
+    }
+
+    if (p_port > 0)
+    {
+        sockaddr_in l_address;
+        int         l_reusePort = 1;
+
+        std::memset(&l_address, 0, sizeof(l_address));
+        l_address.sin_family = AF_INET;
+        l_address.sin_port = htons((u_int16_t)p_port);
+        if (inet_pton(AF_INET, p_host.c_str(), &l_address.sin_addr) != 1)
+        {
+            i_log.log(LOG_ERR, "CollectorReceiver::%s - invalid host [%s]", __func__, p_host.c_str());
+            return false;
+        }
+
+        if ((i_udpSocketfd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)) < 0 ||
+            setsockopt(i_udpSocketfd, SOL_SOCKET, SO_REUSEPORT, &l_reusePort, sizeof(l_reusePort)) != 0)
+        {
+            i_log.log(LOG_ERR, "CollectorReceiver::%s - udp socket : %s", __func__, strerror(errno));
+            return false;
+        }
+
+        // SO_RCVBUFFORCE goes over net.core.rmem_max (as root), SO_RCVBUF otherwise
+        if (p_receiveBufferSize > 0 &&
+            setsockopt(i_udpSocketfd, SOL_SOCKET, SO_RCVBUFFORCE, &p_receiveBufferSize, sizeof(p_receiveBufferSize)) != 0 &&
+            setsockopt(i_udpSocketfd, SOL_SOCKET, SO_RCVBUF, &p_receiveBufferSize, sizeof(p_receiveBufferSize)) != 0)
+            i_log.log(LOG_WARNING, "CollectorReceiver::%s - unable to set the receive buffer size [%d]", __func__, p_receiveBufferSize);
+
+        if (bind(i_udpSocketfd, reinterpret_cast<sockaddr *>(&l_address), sizeof(l_address)) != 0)
+        {
+            i_log.log(LOG_ERR, "CollectorReceiver::%s - bind [%s:%d] : %s", __func__, p_host.c_str(), p_port, strerror(errno));
+            return false;
+        }
+    }
+
+    if (!p_unixPath.empty() && !bindUnix(p_unixPath, p_receiveBufferSize))
+        return false;
+
+    return i_udpSocketfd >= 0 || i_unixSocketfd >= 0;
+}
+
+bool                                CollectorReceiver::start(void)
+{
+    if (i_stopEventfd < 0)
+        return false;
+
+    i_isRunning = true;
+    i_thread = std::thread(&CollectorReceiver::receive, this);
+
+    return i_thread.joinable();
+}
+
+void                                CollectorReceiver::stop(void)
+{
+    i_isRunning = false;
+    if (i_stopEventfd >= 0)
+        eventfd_write(i_stopEventfd, 1);
+
+    if (i_thread.joinable())
+        i_thread.join();
+
+    if (i_udpSocketfd >= 0)
+        close(i_udpSocketfd);
+    if (i_unixSocketfd >= 0)
+        close(i_unixSocketfd);
+    if (i_stopEventfd >= 0)
+        close(i_stopEventfd);
+    i_udpSocketfd = -1;
+    i_unixSocketfd = -1;
+    i_stopEventfd = -1;
+
+    if (!i_unixPath.empty())
+        unlink(i_unixPath.c_str());
+    i_unixPath.clear();
+}
+
+nlohmann::json                      CollectorReceiver::toJson(void) const
+{
+    nlohmann::json  l_json;
+
+    l_json["id"] = i_id;
+    l_json["received"] = i_receivedCount.load(std::memory_order_relaxed);
+    l_json["invalid"] = i_invalidCount.load(std::memory_order_relaxed);
+    l_json["bytes"] = i_bytes.load(std::memory_order_relaxed);
+
+    return l_json;
+}
+
+u_int64_t                           CollectorReceiver::receivedCount(void) const
+{
+    return i_receivedCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief
+ * Walk the fields of the protobuf wire format until the field 1 (sourceID, a varint)
+ * the fields are usually serialized in the order of their numbers : sourceID is the first one
+ *
+ * @param p_data
+ * @param p_length
+ * @param p_sourceID [out]
+ * @return bool false if the datagram is truncated or has no sourceID
+ */
+bool                                CollectorReceiver::peekSourceID(const char *p_data, size_t p_length, u_int32_t &p_sourceID)
+{
+    const unsigned char *l_current = reinterpret_cast<const unsigned char *>(p_data);
+    const unsigned char *l_end = l_current + p_length;
+
+    auto l_readVarint = [&l_current, l_end](u_int64_t &p_value) {
+        p_value = 0;
+        for (int l_shift = 0; l_shift < 64 && l_current < l_end; l_shift += 7)
+        {
+            p_value |= (u_int64_t)(*l_current & 0x7F) << l_shift;
+            if ((*l_current++ & 0x80) == 0)
+                return true;
+        }
+        return false;
+    };
+
+    while (l_current < l_end)
+    {
+        u_int64_t   l_tag;
+        u_int64_t   l_value;
+
+        if (!l_readVarint(l_tag))
+            return false;
+
+        switch (l_tag & 7)
+        {
+            case 0: // varint
+                if (!l_readVarint(l_value))
+                    return false;
+                if ((l_tag >> 3) == 1)
+                {
+                    p_sourceID = (u_int32_t)l_value;
+                    return true;
+                }
+                break;
+            case 1: // 64 bits
+                l_value = 8;
+                if ((size_t)(l_end - l_current) < l_value)
+                    return false;
+                l_current += l_value;
+                break;
+            case 2: // length delimited
+                if (!l_readVarint(l_value) || (u_int64_t)(l_end - l_current) < l_value)
+                    return false;
+                l_current += l_value;
+                break;
+            case 5: // 32 bits
+                l_value = 4;
+                if ((size_t)(l_end - l_current) < l_value)
+                    return false;
+                l_current += l_value;
+                break;
+            default: // groups are not used by Notifications
+                return false;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief
+ * Launched in a new thread
+ * the thread sleeps in epoll_wait until datagrams arrive or stop is called,
+ * then drains the sockets by batches of RECEIVE_BATCH datagrams
+ *
+ */
+void                                CollectorReceiver::receive(void)
+{
+    i_log.log(LOG_INFO, "CollectorReceiver::%s - receiver [%d]", __func__, i_id);
+
+    int         l_epollfd;
+    epoll_event l_event;
+    epoll_event l_readyEvents[3];
+    int         l_readyCount;
+
+    if ((l_epollfd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+    {
+        i_log.log(LOG_ERR, "CollectorReceiver::%s - epoll_create1 : %s", __func__, strerror(errno));
+        return;
+    }
+
+    for (int l_socketfd : { i_udpSocketfd, i_unixSocketfd, i_stopEventfd })
+    {
+        if (l_socketfd < 0)
+            continue;
+        l_event.events = EPOLLIN;
+        l_event.data.fd = l_socketfd;
+        if (epoll_ctl(l_epollfd, EPOLL_CTL_ADD, l_socketfd, &l_event) != 0)
+        {
+            i_log.log(LOG_ERR, "CollectorReceiver::%s - epoll_ctl : %s", __func__, strerror(errno));
+            close(l_epollfd);
+            return;
+        }
+    }
+
+    while (i_isRunning)
+    {
+        l_readyCount = epoll_wait(l_epollfd, l_readyEvents, 3, -1);
+
+        if (l_readyCount < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            i_log.log(LOG_ERR, "CollectorReceiver::%s - epoll_wait : %s", __func__, strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < l_readyCount; i++)
+        {
+            if (l_readyEvents[i].data.fd != i_stopEventfd)
+                while (receiveBatch(l_readyEvents[i].data.fd) == RECEIVE_BATCH)
+                    ; // the socket may hold more datagrams
+        }
+    }
+
+    close(l_epollfd);
+}
+
+/**
+ * @brief
+ * Read up to RECEIVE_BATCH datagrams with one recvmmsg in the preallocated buffers,
+ * push each of them to the shard of its source (sourceID % shard count),
+ * then wake up the shards which got a datagram
+ *
+ * @param p_socketfd
+ * @return int number of datagrams read, 0 when the socket is empty
+ */
+int                                 CollectorReceiver::receiveBatch(int p_socketfd)
+{
+    int         l_received;
+    u_int64_t   l_bytes = 0;
+    u_int64_t   l_invalid = 0;
+
+    for (int i = 0; i < RECEIVE_BATCH; i++)
+    {
+        i_receiveIovecs[i].iov_base = &i_receiveBuffers[i * BUFFER_LEN];
+        i_receiveIovecs[i].iov_len = BUFFER_LEN;
+        std::memset(&i_receiveMessages[i].msg_hdr, 0, sizeof(i_receiveMessages[i].msg_hdr));
+        i_receiveMessages[i].msg_hdr.msg_iov = &i_receiveIovecs[i];
+        i_receiveMessages[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    l_received = recvmmsg(p_socketfd, i_receiveMessages.data(), RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+
+    if (l_received < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            i_log.log(LOG_ERR, "CollectorReceiver::%s - recvmmsg : %s", __func__, strerror(errno));
+        return 0;
+    }
+
+    for (int i = 0; i < l_received; i++)
+    {
+        const char  *l_datagram = &i_receiveBuffers[i * BUFFER_LEN];
+        u_int32_t   l_length = i_receiveMessages[i].msg_len;
+        u_int32_t   l_sourceID;
+        size_t      l_shard;
+
+        l_bytes += l_length;
+        if ((i_receiveMessages[i].msg_hdr.msg_flags & MSG_TRUNC) || !peekSourceID(l_datagram, l_length, l_sourceID))
+        {
+            l_invalid++;
+            continue;
+        }
+
+        l_shard = l_sourceID % i_shards.size();
+        i_shards[l_shard]->push(i_id, l_datagram, l_length);
+        i_isShardPushed[l_shard] = true;
+    }
+
+    for (size_t l_shard = 0; l_shard < i_shards.size(); l_shard++)
+    {
+        if (!i_isShardPushed[l_shard])
+            continue;
+        i_isShardPushed[l_shard] = false;
+        i_shards[l_shard]->wake();
+    }
+
+    // one writer : a load and a store, no read-modify-write
+    i_receivedCount.store(i_receivedCount.load(std::memory_order_relaxed) + (u_int64_t)l_received, std::memory_order_relaxed);
+    i_invalidCount.store(i_invalidCount.load(std::memory_order_relaxed) + l_invalid, std::memory_order_relaxed);
+    i_bytes.store(i_bytes.load(std::memory_order_relaxed) + l_bytes, std::memory_order_relaxed);
+
+    return l_received;
+}
+
+/**
+ * @brief
+ * Bind the Unix datagram socket of the local senders, the socket file left by a previous collector is removed
+ *
+ * @param p_unixPath
+ * @param p_receiveBufferSize
+ * @return bool
+ */
+bool                                CollectorReceiver::bindUnix(const std::string &p_unixPath, int p_receiveBufferSize)
+{
+    struct sockaddr_un  l_address;
+
+    std::memset(&l_address, 0, sizeof(l_address));
+    l_address.sun_family = AF_UNIX;
+    if (p_unixPath.size() >= sizeof(l_address.sun_path))
+    {
+        i_log.log(LOG_ERR, "CollectorReceiver::%s - invalid socket path [%s]", __func__, p_unixPath.c_str());
+        return false;
+    }
+    std::strncpy(l_address.sun_path, p_unixPath.c_str(), sizeof(l_address.sun_path) - 1);
+
+    if ((i_unixSocketfd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0)) < 0)
+    {
+        i_log.log(LOG_ERR, "CollectorReceiver::%s - unix socket : %s", __func__, strerror(errno));
+        return false;
+    }
+
+    if (p_receiveBufferSize > 0 &&
+        setsockopt(i_unixSocketfd, SOL_SOCKET, SO_RCVBUFFORCE, &p_receiveBufferSize, sizeof(p_receiveBufferSize)) != 0 &&
+        setsockopt(i_unixSocketfd, SOL_SOCKET, SO_RCVBUF, &p_receiveBufferSize, sizeof(p_receiveBufferSize)) != 0)
+        i_log.log(LOG_WARNING, "CollectorReceiver::%s - unable to set the receive buffer size [%d]", __func__, p_receiveBufferSize);
+
+    unlink(p_unixPath.c_str());
+    if (bind(i_unixSocketfd, (struct sockaddr *)&l_address, sizeof(l_address)) < 0)
+    {
+        i_log.log(LOG_ERR, "CollectorReceiver::%s - bind [%s] : %s", __func__, p_unixPath.c_str(), strerror(errno));
+        return false;
+    }
+
+    i_unixPath = p_unixPath;
+    return true;
+}
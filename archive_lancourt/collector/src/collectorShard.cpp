@@ -0,0 +1,276 @@
+#include "collectorShard.hpp"
+
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <ctime>
+
+/**
+ * @brief
+ * Construct a new Collector Shard:: Collector Shard object
+ *
+ * @param p_id
+ * @param p_receiverCount
+ * @param p_ringCapacity bytes of each ring
+ * @param p_sourceCapacity
+ * @param p_log
+ */
+CollectorShard::CollectorShard(int p_id, int p_receiverCount, size_t p_ringCapacity, size_t p_sourceCapacity,
+                               ILog &p_log) : i_id(p_id),
+                                              i_log(p_log),
+                                              i_sources(p_sourceCapacity),
+                                              i_isRunning(false),
+                                              i_isSleeping(false),
+                                              i_decodedCount(0),
+                                              i_invalidCount(0),
+                                              i_tableFullCount(0)
+{
+    google::protobuf::ArenaOptions  l_arenaOptions;
+
+    for (int i = 0; i < p_receiverCount; i++)
+        i_rings.emplace_back(new ShardRing(p_ringCapacity));
+
+    i_droppedCounts.reset(new std::atomic<u_int64_t>[p_receiverCount]());
+
+    i_arenaBlock.resize(SHARD_ARENA_BLOCK_SIZE);
+    l_arenaOptions.initial_block = i_arenaBlock.data();
+    l_arenaOptions.initial_block_size = i_arenaBlock.size();
+    i_arena.reset(new google::protobuf::Arena(l_arenaOptions));
+
+    i_wakeEventfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+CollectorShard::~CollectorShard(void)
+{
+    stop();
+    if (i_wakeEventfd >= 0)
+        close(i_wakeEventfd);
+}
+
+bool                                CollectorShard::start(void)
+{
+    if (i_wakeEventfd < 0)
+    {
+        i_log.log(LOG_ERR, "CollectorShard::%s - shard [%d] : eventfd failed", __func__, i_id);
+        return false;
+    }
+
+    i_isRunning = true;
+    i_thread = std::thread(&CollectorShard::run, this);
+
+    return i_thread.joinable();
+}
+
+void                                CollectorShard::stop(void)
+{
+    i_isRunning = false;
+    if (i_wakeEventfd >= 0)
+        eventfd_write(i_wakeEventfd, 1);
+
+    if (i_thread.joinable())
+        i_thread.join();
+}
+
+bool                                CollectorShard::push(int p_receiver, const char *p_data, u_int32_t p_length)
+{
+    if (i_rings[p_receiver]->push(p_data, p_length))
+        return true;
+
+    i_droppedCounts[p_receiver].fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+/**
+ * @brief
+ * The fence orders the push of the receiver before the read of i_isSleeping,
+ * like the fence of sleep orders i_isSleeping before the read of the rings :
+ * either the receiver sees the shard sleeping, or the shard sees the datagram
+ *
+ */
+void                                CollectorShard::wake(void)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (i_isSleeping.load(std::memory_order_relaxed) && i_isSleeping.exchange(false))
+        eventfd_write(i_wakeEventfd, 1);
+}
+
+/**
+ * @brief
+ * Parse a datagram as a protobuf Notifications and aggregate it in the entry of its source
+ * the fields are read straight from the arena, nothing is kept after the batch
+ *
+ * @param p_data
+ * @param p_length
+ * @return bool false if the datagram is not a Notifications
+ */
+bool                                CollectorShard::process(const char *p_data, u_int32_t p_length)
+{
+    Notifications   *l_notifications = google::protobuf::Arena::CreateMessage<Notifications>(i_arena.get());
+    SourceStats     *l_stats;
+    int64_t         l_now;
+
+    if (!l_notifications->ParseFromArray(p_data, (int)p_length) || !l_notifications->IsInitialized())
+    {
+        i_invalidCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if ((l_stats = i_sources.insert(l_notifications->sourceid())) == nullptr)
+    {
+        i_tableFullCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // one writer : a load and a store, no read-modify-write
+    auto l_increment = [](std::atomic<u_int64_t> &p_counter, u_int64_t p_value) {
+        p_counter.store(p_counter.load(std::memory_order_relaxed) + p_value, std::memory_order_relaxed);
+    };
+
+    l_now = (int64_t)std::time(nullptr);
+    if (l_stats->firstReception.load(std::memory_order_relaxed) == 0)
+        l_stats->firstReception.store(l_now, std::memory_order_relaxed);
+    l_stats->lastReception.store(l_now, std::memory_order_relaxed);
+
+    l_stats->sourceType.store((u_int32_t)l_notifications->sourcetype(), std::memory_order_relaxed);
+    l_increment(l_stats->notifications[(int)l_notifications->notificationtype() % NOTIFICATION_TYPE_COUNT], 1);
+    l_increment(l_stats->priorities[(int)l_notifications->priority() % NOTIFICATION_PRIORITY_COUNT], 1);
+    l_increment(l_stats->bytes, p_length);
+
+    if (l_notifications->has_cpuusage())
+        l_stats->cpuUsage.store(std::strtoll(l_notifications->cpuusage().c_str(), nullptr, 10), std::memory_order_relaxed);
+    if (l_notifications->has_ramusage())
+        l_stats->ramUsage.store(std::strtoll(l_notifications->ramusage().c_str(), nullptr, 10), std::memory_order_relaxed);
+    if (l_notifications->has_uptime())
+        l_stats->upTime.store(l_notifications->uptime(), std::memory_order_relaxed);
+    if (l_notifications->has_sendingdate())
+        l_stats->sendingDate.store(l_notifications->sendingdate(), std::memory_order_relaxed);
+
+    i_decodedCount.store(i_decodedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return true;
+}
+
+const SourceTable                   &CollectorShard::sources(void) const
+{
+    return i_sources;
+}
+
+nlohmann::json                      CollectorShard::toJson(void) const
+{
+    nlohmann::json  l_json;
+    u_int64_t       l_dropped = 0;
+
+    for (size_t i = 0; i < i_rings.size(); i++)
+        l_dropped += i_droppedCounts[i].load(std::memory_order_relaxed);
+
+    l_json["id"] = i_id;
+    l_json["decoded"] = i_decodedCount.load(std::memory_order_relaxed);
+    l_json["invalid"] = i_invalidCount.load(std::memory_order_relaxed);
+    l_json["dropped"] = l_dropped;
+    l_json["tableFull"] = i_tableFullCount.load(std::memory_order_relaxed);
+    l_json["pendingBytes"] = pendingBytes();
+    l_json["sources"] = i_sources.size();
+
+    return l_json;
+}
+
+u_int64_t                           CollectorShard::decodedCount(void) const
+{
+    return i_decodedCount.load(std::memory_order_relaxed);
+}
+
+size_t                              CollectorShard::pendingBytes(void) const
+{
+    size_t  l_pending = 0;
+
+    for (const std::unique_ptr<ShardRing> &l_ring : i_rings)
+        l_pending += l_ring->pendingBytes();
+    return l_pending;
+}
+
+/**
+ * @brief
+ * Launched in a new thread
+ * the rings are drained while they hold datagrams, then the thread spins SHARD_SPIN_COUNT rounds
+ * before sleeping on its eventfd : under load it never sleeps, idle it costs nothing
+ *
+ */
+void                                CollectorShard::run(void)
+{
+    i_log.log(LOG_INFO, "CollectorShard::%s - shard [%d]", __func__, i_id);
+
+    int l_emptyRounds = 0;
+
+    while (i_isRunning)
+    {
+        if (drain() != 0)
+        {
+            l_emptyRounds = 0;
+            continue;
+        }
+
+        if (++l_emptyRounds < SHARD_SPIN_COUNT)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        l_emptyRounds = 0;
+        sleep();
+    }
+
+    // the datagrams received before the stop
+    while (drain() != 0)
+        ;
+}
+
+size_t                              CollectorShard::drain(void)
+{
+    size_t      l_decoded = 0;
+    const char  *l_data;
+    u_int32_t   l_length;
+
+    for (std::unique_ptr<ShardRing> &l_ring : i_rings)
+    {
+        size_t l_count = 0;
+
+        while (l_count < SHARD_BATCH && (l_data = l_ring->front(l_length)) != nullptr)
+        {
+            process(l_data, l_length);
+            l_ring->pop();
+            l_count++;
+        }
+        if (l_count != 0)
+            i_arena->Reset();
+        l_decoded += l_count;
+    }
+    return l_decoded;
+}
+
+bool                                CollectorShard::isEmpty(void) const
+{
+    for (const std::unique_ptr<ShardRing> &l_ring : i_rings)
+        if (l_ring->pendingBytes() != 0)
+            return false;
+    return true;
+}
+
+void                                CollectorShard::sleep(void)
+{
+    struct pollfd   l_pollfd;
+    eventfd_t       l_value;
+
+    i_isSleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (isEmpty() && i_isRunning)
+    {
+        l_pollfd.fd = i_wakeEventfd;
+        l_pollfd.events = POLLIN;
+        poll(&l_pollfd, 1, SHARD_SLEEP_TIMEOUT);
+    }
+
+    i_isSleeping.store(false, std::memory_order_relaxed);
+    eventfd_read(i_wakeEventfd, &l_value);
+}
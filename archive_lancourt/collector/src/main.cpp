@@ -0,0 +1,96 @@
+#include "collector.hpp"
+
+#include "syslog.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <iostream>
+
+# define COLLECTOR_REPORT_PERIOD 10 // default "reportPeriod", s between two summaries in syslog, 0 : none
+
+/**
+ * @brief
+ * Log the notifications received and decoded since the last summary
+ *
+ * @param p_collector
+ * @param p_log
+ * @param p_previous [in, out] counters of the last summary
+ * @param p_period s
+ */
+static void     report(const Collector &p_collector, ILog &p_log, nlohmann::json &p_previous, int p_period)
+{
+    nlohmann::json  l_counters = p_collector.toJson(false).at("collector");
+
+    auto l_delta = [&](const char *p_name) {
+        return l_counters.at(p_name).get<u_int64_t>() - p_previous.value(p_name, (u_int64_t)0);
+    };
+
+    p_log.log(LOG_INFO, "Collector : %llu received (%llu /s), %llu decoded, %llu dropped, %llu invalid, %llu bytes pending",
+              (unsigned long long)l_delta("received"), (unsigned long long)(l_delta("received") / (u_int64_t)p_period),
+              (unsigned long long)l_delta("decoded"), (unsigned long long)l_delta("dropped"),
+              (unsigned long long)l_delta("invalid"), (unsigned long long)l_counters.at("pendingBytes").get<u_int64_t>());
+    p_previous = l_counters;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cout << "JSONFILE NEEDED --> ./bin/collector-debug [jsonString]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Syslog          l_log("Collector", LOG_PID | LOG_NDELAY, LOG_USER);
+    nlohmann::json  l_json;
+    nlohmann::json  l_previous;
+    int             l_reportPeriod;
+
+    try
+    {
+        l_json = nlohmann::json::parse(argv[1]);
+        l_reportPeriod = l_json.value("reportPeriod", COLLECTOR_REPORT_PERIOD);
+    }
+    catch (const std::exception &e)
+    {
+        l_log.log(LOG_ERR, "main json parsing failure : %s", e.what());
+        return EXIT_FAILURE;
+    }
+
+    // the stop signals are blocked before the threads are created (they inherit the mask),
+    // they are only received by this thread, in sigtimedwait
+    sigset_t        l_stopSignals;
+    struct timespec l_timeout;
+    int             l_signal;
+
+    sigemptyset(&l_stopSignals);
+    sigaddset(&l_stopSignals, SIGINT);
+    sigaddset(&l_stopSignals, SIGTERM);
+    sigaddset(&l_stopSignals, SIGQUIT);
+    pthread_sigmask(SIG_BLOCK, &l_stopSignals, nullptr);
+
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    Collector       l_collector(l_log);
+
+    if (!l_collector.init(l_json) || !l_collector.start())
+    {
+        l_collector.stop();
+        return EXIT_FAILURE;
+    }
+
+    l_timeout.tv_sec = l_reportPeriod > 0 ? l_reportPeriod : 3600;
+    l_timeout.tv_nsec = 0;
+    while ((l_signal = sigtimedwait(&l_stopSignals, nullptr, &l_timeout)) < 0)
+    {
+        if (errno == EAGAIN && l_reportPeriod > 0)
+            report(l_collector, l_log, l_previous, l_reportPeriod);
+    }
+
+    l_log.log(LOG_INFO, "Collector : signal [%d] received, stop", l_signal);
+    l_collector.stop();
+    report(l_collector, l_log, l_previous, l_reportPeriod > 0 ? l_reportPeriod : 1);
+
+    google::protobuf::ShutdownProtobufLibrary();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,111 @@
+#include "shardRing.hpp"
+
+#include <cstring>
+
+ShardRing::ShardRing(size_t p_capacity) : i_cachedTail(0),
+                                          i_cachedHead(0),
+                                          i_frontSize(0)
+{
+    i_capacity = 64;
+    while (i_capacity < p_capacity)
+        i_capacity <<= 1;
+
+    i_buffer.resize(i_capacity / sizeof(u_int64_t));
+    i_data = reinterpret_cast<char *>(i_buffer.data());
+    i_head.store(0, std::memory_order_relaxed);
+    i_tail.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief
+ * Copy a datagram after the last record, a record never wraps :
+ * when it does not fit before the end of the buffer, a wrap record fills the end
+ * and the datagram goes at the start
+ *
+ * @param p_data
+ * @param p_length
+ * @return bool false if the ring is full
+ */
+bool                                ShardRing::push(const char *p_data, u_int32_t p_length)
+{
+    u_int64_t   l_head = i_head.load(std::memory_order_relaxed);
+    size_t      l_offset = (size_t)(l_head & (i_capacity - 1));
+    size_t      l_size = recordSize(p_length);
+    size_t      l_wrapSize = 0;
+
+    if (l_offset + l_size > i_capacity)
+        l_wrapSize = i_capacity - l_offset;
+    if (l_wrapSize + l_size > i_capacity)
+        return false;
+
+    // the tail is read again only when the last one read leaves no room
+    if (l_head + l_wrapSize + l_size - i_cachedTail > i_capacity)
+    {
+        i_cachedTail = i_tail.load(std::memory_order_acquire);
+        if (l_head + l_wrapSize + l_size - i_cachedTail > i_capacity)
+            return false;
+    }
+
+    if (l_wrapSize != 0)
+    {
+        *reinterpret_cast<u_int32_t *>(i_data + l_offset) = RING_WRAP_RECORD;
+        l_offset = 0;
+    }
+    *reinterpret_cast<u_int32_t *>(i_data + l_offset) = p_length;
+    std::memcpy(i_data + l_offset + sizeof(u_int32_t), p_data, p_length);
+
+    i_head.store(l_head + l_wrapSize + l_size, std::memory_order_release);
+    return true;
+}
+
+const char                          *ShardRing::front(u_int32_t &p_length)
+{
+    u_int64_t   l_tail = i_tail.load(std::memory_order_relaxed);
+    size_t      l_offset = (size_t)(l_tail & (i_capacity - 1));
+    u_int32_t   l_length;
+
+    if (l_tail == i_cachedHead)
+    {
+        i_cachedHead = i_head.load(std::memory_order_acquire);
+        if (l_tail == i_cachedHead)
+            return nullptr;
+    }
+
+    i_frontSize = 0;
+    l_length = *reinterpret_cast<const u_int32_t *>(i_data + l_offset);
+    if (l_length == RING_WRAP_RECORD)
+    {
+        // pushed with the record following it : the record is at the start
+        i_frontSize = i_capacity - l_offset;
+        l_offset = 0;
+        l_length = *reinterpret_cast<const u_int32_t *>(i_data);
+    }
+    i_frontSize += recordSize(l_length);
+
+    p_length = l_length;
+    return i_data + l_offset + sizeof(u_int32_t);
+}
+
+void                                ShardRing::pop(void)
+{
+    i_tail.store(i_tail.load(std::memory_order_relaxed) + i_frontSize, std::memory_order_release);
+    i_frontSize = 0;
+}
+
+size_t                              ShardRing::pendingBytes(void) const
+{
+    u_int64_t   l_tail = i_tail.load(std::memory_order_relaxed);
+    u_int64_t   l_head = i_head.load(std::memory_order_relaxed);
+
+    return l_head > l_tail ? (size_t)(l_head - l_tail) : 0;
+}
+
+size_t                              ShardRing::capacity(void) const
+{
+    return i_capacity;
+}
+
+size_t                              ShardRing::recordSize(u_int32_t p_length)
+{
+    return (sizeof(u_int32_t) + p_length + RING_RECORD_ALIGN - 1) & ~((size_t)RING_RECORD_ALIGN - 1);
+}
@@ -0,0 +1,33 @@
+#include "snapshotServer.hpp"
+#include "collector.hpp"
+
+/**
+ * @brief
+ * Construct a new Snapshot Server:: Snapshot Server object
+ *
+ * @param p_collector
+ * @param p_log
+ */
+SnapshotServer::SnapshotServer(const Collector &p_collector, ILog &p_log) : UnixSocketServer(p_log, "SnapshotServer", 0, SNAPSHOT_SEND_TIMEOUT),
+                                                                           i_collector(p_collector)
+{
+}
+
+SnapshotServer::~SnapshotServer(void)
+{
+    stop();
+}
+
+/**
+ * @brief
+ * The snapshot is built when a client connects, nothing is done between two clients
+ *
+ * @param p_request
+ * @return std::string
+ */
+std::string                         SnapshotServer::answer(const std::string &p_request)
+{
+    (void)p_request;
+
+    return i_collector.toJson().dump() + "\n";
+}
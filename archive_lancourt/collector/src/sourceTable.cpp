@@ -0,0 +1,102 @@
+#include "sourceTable.hpp"
+
+SourceTable::SourceTable(size_t p_capacity) : i_size(0)
+{
+    i_capacity = 16;
+    while (i_capacity < p_capacity)
+        i_capacity <<= 1;
+
+    // value-initialized : every atomic at 0
+    i_entries.reset(new SourceStats[i_capacity]());
+}
+
+/**
+ * @brief
+ * Linear probing from slotOf, the fields of a new entry are at 0 when its key is published
+ *
+ * @param p_sourceID
+ * @return SourceStats* nullptr if the table is full
+ */
+SourceStats                         *SourceTable::insert(u_int32_t p_sourceID)
+{
+    u_int64_t   l_key = (u_int64_t)p_sourceID + 1;
+    size_t      l_slot = slotOf(p_sourceID);
+
+    for (size_t i = 0; i < i_capacity; i++, l_slot = (l_slot + 1) & (i_capacity - 1))
+    {
+        u_int64_t   l_entryKey = i_entries[l_slot].key.load(std::memory_order_relaxed);
+
+        if (l_entryKey == l_key)
+            return &i_entries[l_slot];
+        if (l_entryKey == 0)
+        {
+            i_entries[l_slot].key.store(l_key, std::memory_order_release);
+            i_size.fetch_add(1, std::memory_order_relaxed);
+            return &i_entries[l_slot];
+        }
+    }
+    return nullptr;
+}
+
+const SourceStats                   *SourceTable::find(u_int32_t p_sourceID) const
+{
+    u_int64_t   l_key = (u_int64_t)p_sourceID + 1;
+    size_t      l_slot = slotOf(p_sourceID);
+
+    for (size_t i = 0; i < i_capacity; i++, l_slot = (l_slot + 1) & (i_capacity - 1))
+    {
+        u_int64_t   l_entryKey = i_entries[l_slot].key.load(std::memory_order_acquire);
+
+        if (l_entryKey == l_key)
+            return &i_entries[l_slot];
+        if (l_entryKey == 0)
+            return nullptr;
+    }
+    return nullptr;
+}
+
+size_t                              SourceTable::size(void) const
+{
+    return i_size.load(std::memory_order_relaxed);
+}
+
+size_t                              SourceTable::capacity(void) const
+{
+    return i_capacity;
+}
+
+void                                SourceTable::toJson(nlohmann::json &p_json) const
+{
+    for (size_t i = 0; i < i_capacity; i++)
+        if (i_entries[i].key.load(std::memory_order_acquire) != 0)
+            p_json.push_back(toJson(i_entries[i]));
+}
+
+nlohmann::json                      SourceTable::toJson(const SourceStats &p_stats)
+{
+    nlohmann::json  l_json;
+
+    l_json["sourceID"] = p_stats.key.load(std::memory_order_relaxed) - 1;
+    l_json["sourceType"] = p_stats.sourceType.load(std::memory_order_relaxed);
+    l_json["configs"] = p_stats.notifications[0].load(std::memory_order_relaxed);
+    l_json["alerts"] = p_stats.notifications[1].load(std::memory_order_relaxed);
+    l_json["stats"] = p_stats.notifications[2].load(std::memory_order_relaxed);
+    l_json["warnings"] = p_stats.priorities[1].load(std::memory_order_relaxed);
+    l_json["errors"] = p_stats.priorities[2].load(std::memory_order_relaxed);
+    l_json["fatals"] = p_stats.priorities[3].load(std::memory_order_relaxed);
+    l_json["bytes"] = p_stats.bytes.load(std::memory_order_relaxed);
+    l_json["cpuUsage"] = p_stats.cpuUsage.load(std::memory_order_relaxed);
+    l_json["ramUsage"] = p_stats.ramUsage.load(std::memory_order_relaxed);
+    l_json["upTime"] = p_stats.upTime.load(std::memory_order_relaxed);
+    l_json["sendingDate"] = p_stats.sendingDate.load(std::memory_order_relaxed);
+    l_json["firstReception"] = p_stats.firstReception.load(std::memory_order_relaxed);
+    l_json["lastReception"] = p_stats.lastReception.load(std::memory_order_relaxed);
+
+    return l_json;
+}
+
+size_t                              SourceTable::slotOf(u_int32_t p_sourceID) const
+{
+    // fibonacci hashing
+    return (size_t)(((u_int64_t)p_sourceID * 11400714819323198485ULL) >> 32) & (i_capacity - 1);
+}
@@ -0,0 +1,176 @@
+#include "collector.hpp"
+#include "collectorReceiver.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "mock/mock_iLog.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#define COLLECTOR_TEST_PORT 24250
+#define COLLECTOR_TEST_SOCKET "/tmp/testCollector.sock"
+#define COLLECTOR_TEST_SNAPSHOT "/tmp/testCollectorSnapshot.sock"
+
+static std::string  newNotification(u_int32_t p_sourceID, Notifications_NotificationType p_type, Notifications_Priority p_priority)
+{
+    Notifications   l_notification;
+    std::string     l_serialized;
+
+    l_notification.set_sourceid(p_sourceID);
+    l_notification.set_sourcetype(Notifications_SourceType_VISION);
+    l_notification.set_priority(p_priority);
+    l_notification.set_notificationtype(p_type);
+    l_notification.set_cpuusage("12");
+    l_notification.set_ramusage("3400");
+    l_notification.set_sendingdate(1000 + p_sourceID);
+    l_notification.SerializeToString(&l_serialized);
+    return l_serialized;
+}
+
+static int          connectUdp(void)
+{
+    sockaddr_in l_address;
+    int         l_socketfd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    std::memset(&l_address, 0, sizeof(l_address));
+    l_address.sin_family = AF_INET;
+    l_address.sin_port = htons(COLLECTOR_TEST_PORT);
+    l_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    connect(l_socketfd, reinterpret_cast<sockaddr *>(&l_address), sizeof(l_address));
+    return l_socketfd;
+}
+
+static int          connectUnix(const char *p_path, int p_type)
+{
+    struct sockaddr_un  l_address;
+    int                 l_socketfd = socket(AF_UNIX, p_type, 0);
+
+    std::memset(&l_address, 0, sizeof(l_address));
+    l_address.sun_family = AF_UNIX;
+    std::strncpy(l_address.sun_path, p_path, sizeof(l_address.sun_path) - 1);
+    if (connect(l_socketfd, (struct sockaddr *)&l_address, sizeof(l_address)) < 0)
+    {
+        close(l_socketfd);
+        return -1;
+    }
+    return l_socketfd;
+}
+
+// wait for the receivers to read p_received datagrams and the shards to decode p_decoded of them, at most 2 s
+static bool         waitCounts(const Collector &p_collector, u_int64_t p_received, u_int64_t p_decoded)
+{
+    for (int i = 0; i < 200 && (p_collector.receivedCount() < p_received || p_collector.decodedCount() < p_decoded); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return p_collector.receivedCount() == p_received && p_collector.decodedCount() == p_decoded;
+}
+
+TEST(CollectorReceiver, PEEK_SOURCE_ID)
+{
+    std::string     l_serialized = newNotification(300, Notifications_NotificationType_STATS, Notifications_Priority_DEFAULT_PRIORITY);
+    u_int32_t       l_sourceID = 0;
+
+    EXPECT_TRUE(CollectorReceiver::peekSourceID(l_serialized.data(), l_serialized.size(), l_sourceID));
+    EXPECT_EQ(l_sourceID, 300u);
+
+    // sourceID after a string and a varint (field 9, then field 8, then field 1)
+    l_serialized = std::string("\x4a\x03" "abc" "\x40\x96\x01" "\x08\xac\x02", 11);
+    EXPECT_TRUE(CollectorReceiver::peekSourceID(l_serialized.data(), l_serialized.size(), l_sourceID));
+    EXPECT_EQ(l_sourceID, 300u);
+
+    // truncated string, no sourceID, truncated varint
+    EXPECT_FALSE(CollectorReceiver::peekSourceID("\x4a\x09" "abc", 5, l_sourceID));
+    EXPECT_FALSE(CollectorReceiver::peekSourceID("\x40\x96\x01", 3, l_sourceID));
+    EXPECT_FALSE(CollectorReceiver::peekSourceID("\x08\xac", 2, l_sourceID));
+    EXPECT_FALSE(CollectorReceiver::peekSourceID("", 0, l_sourceID));
+}
+
+TEST(Collector, FAILURE)
+{
+    Mock_ILog   l_mock_ilog(ILOG_TEST_FILE);
+    Collector   l_collector(l_mock_ilog);
+
+    // neither udp port nor Unix socket
+    EXPECT_FALSE(l_collector.init({ { "shardCount", 2 } }));
+}
+
+TEST(Collector, SUCCESS)
+{
+    Mock_ILog       l_mock_ilog(ILOG_TEST_FILE);
+    Collector       l_collector(l_mock_ilog);
+    nlohmann::json  l_json;
+    std::string     l_snapshot;
+    char            l_buffer[4096];
+    ssize_t         l_length;
+    int             l_udpSocketfd;
+    int             l_unixSocketfd;
+    int             l_snapshotSocketfd;
+
+    ASSERT_TRUE(l_collector.init({ { "protobuf_host", "127.0.0.1" },
+                                   { "protobuf_port", COLLECTOR_TEST_PORT },
+                                   { "unix_socketPath", COLLECTOR_TEST_SOCKET },
+                                   { "snapshot_socketPath", COLLECTOR_TEST_SNAPSHOT },
+                                   { "receiverCount", 2 },
+                                   { "shardCount", 3 } }));
+    ASSERT_TRUE(l_collector.start());
+
+    ASSERT_GE(l_udpSocketfd = connectUdp(), 0);
+    ASSERT_GE(l_unixSocketfd = connectUnix(COLLECTOR_TEST_SOCKET, SOCK_DGRAM), 0);
+
+    // 10 sources over the 3 shards : 1 STATS each by udp, 1 ALERT ERROR each by the Unix socket
+    for (u_int32_t l_sourceID = 1; l_sourceID <= 10; l_sourceID++)
+    {
+        std::string l_stats = newNotification(l_sourceID, Notifications_NotificationType_STATS, Notifications_Priority_DEFAULT_PRIORITY);
+        std::string l_alert = newNotification(l_sourceID, Notifications_NotificationType_ALERT, Notifications_Priority_ERROR);
+
+        ASSERT_EQ(send(l_udpSocketfd, l_stats.data(), l_stats.size(), 0), (ssize_t)l_stats.size());
+        ASSERT_EQ(send(l_unixSocketfd, l_alert.data(), l_alert.size(), 0), (ssize_t)l_alert.size());
+    }
+    // not a notification : dropped by the receiver
+    ASSERT_EQ(send(l_udpSocketfd, "\xff\xff", 2, 0), 2);
+
+    EXPECT_TRUE(waitCounts(l_collector, 21, 20));
+    close(l_udpSocketfd);
+    close(l_unixSocketfd);
+
+    for (u_int32_t l_sourceID = 1; l_sourceID <= 10; l_sourceID++)
+    {
+        const SourceStats   *l_stats = l_collector.findSource(l_sourceID);
+
+        ASSERT_NE(l_stats, nullptr);
+        EXPECT_EQ(l_stats->notifications[Notifications_NotificationType_STATS].load(), 1u);
+        EXPECT_EQ(l_stats->notifications[Notifications_NotificationType_ALERT].load(), 1u);
+        EXPECT_EQ(l_stats->priorities[Notifications_Priority_ERROR].load(), 1u);
+        EXPECT_EQ(l_stats->cpuUsage.load(), 12);
+        EXPECT_EQ(l_stats->ramUsage.load(), 3400);
+        EXPECT_EQ(l_stats->sendingDate.load(), 1000u + l_sourceID);
+        EXPECT_EQ(l_stats->sourceType.load(), (u_int32_t)Notifications_SourceType_VISION);
+    }
+    EXPECT_EQ(l_collector.findSource(11), nullptr);
+
+    // the snapshot socket
+    ASSERT_GE(l_snapshotSocketfd = connectUnix(COLLECTOR_TEST_SNAPSHOT, SOCK_STREAM), 0);
+    while ((l_length = read(l_snapshotSocketfd, l_buffer, sizeof(l_buffer))) > 0)
+        l_snapshot.append(l_buffer, (size_t)l_length);
+    close(l_snapshotSocketfd);
+
+    ASSERT_NO_THROW(l_json = nlohmann::json::parse(l_snapshot));
+    EXPECT_EQ(l_json.at("collector").at("received").get<u_int64_t>(), 21u);
+    EXPECT_EQ(l_json.at("collector").at("decoded").get<u_int64_t>(), 20u);
+    EXPECT_EQ(l_json.at("collector").at("invalid").get<u_int64_t>(), 1u);
+    EXPECT_EQ(l_json.at("collector").at("dropped").get<u_int64_t>(), 0u);
+    EXPECT_EQ(l_json.at("collector").at("shards").size(), 3u);
+    EXPECT_EQ(l_json.at("sources").size(), 10u);
+
+    l_collector.stop();
+    EXPECT_NE(access(COLLECTOR_TEST_SOCKET, F_OK), 0);
+    EXPECT_NE(access(COLLECTOR_TEST_SNAPSHOT, F_OK), 0);
+}
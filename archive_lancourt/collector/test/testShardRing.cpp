@@ -0,0 +1,100 @@
+#include "shardRing.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+
+TEST(ShardRing, SUCCESS)
+{
+    ShardRing   l_ring(100);
+    const char  *l_data;
+    u_int32_t   l_length;
+
+    EXPECT_EQ(l_ring.capacity(), 128u);
+    EXPECT_EQ(ShardRing::recordSize(0), 8u);
+    EXPECT_EQ(ShardRing::recordSize(5), 16u);
+    EXPECT_EQ(l_ring.front(l_length), nullptr);
+
+    EXPECT_TRUE(l_ring.push("first", 5));
+    EXPECT_TRUE(l_ring.push("second", 6));
+    EXPECT_EQ(l_ring.pendingBytes(), 32u);
+
+    ASSERT_NE(l_data = l_ring.front(l_length), nullptr);
+    EXPECT_EQ(std::string(l_data, l_length), "first");
+    l_ring.pop();
+    ASSERT_NE(l_data = l_ring.front(l_length), nullptr);
+    EXPECT_EQ(std::string(l_data, l_length), "second");
+    l_ring.pop();
+    EXPECT_EQ(l_ring.front(l_length), nullptr);
+    EXPECT_EQ(l_ring.pendingBytes(), 0u);
+}
+
+TEST(ShardRing, WRAP)
+{
+    ShardRing   l_ring(128);
+    ShardRing   l_fullRing(128);
+    std::string l_big(100, 'b');
+    std::string l_wrapped(30, 'w');
+    const char  *l_data;
+    u_int32_t   l_length;
+
+    // 104 bytes used, then released : the next record (40 bytes) does not fit in the 24 left before the end
+    ASSERT_TRUE(l_ring.push(l_big.data(), (u_int32_t)l_big.size()));
+    ASSERT_NE(l_ring.front(l_length), nullptr);
+    l_ring.pop();
+
+    EXPECT_TRUE(l_ring.push(l_wrapped.data(), (u_int32_t)l_wrapped.size()));
+    EXPECT_EQ(l_ring.pendingBytes(), 24u + 40u);
+    ASSERT_NE(l_data = l_ring.front(l_length), nullptr);
+    EXPECT_EQ(std::string(l_data, l_length), l_wrapped);
+    l_ring.pop();
+    EXPECT_EQ(l_ring.pendingBytes(), 0u);
+
+    // full : the datagram is dropped, bigger than the ring : never pushed
+    EXPECT_TRUE(l_fullRing.push(l_big.data(), (u_int32_t)l_big.size()));
+    EXPECT_FALSE(l_fullRing.push(l_wrapped.data(), (u_int32_t)l_wrapped.size()));
+    EXPECT_FALSE(l_ring.push(std::string(200, 'c').data(), 200));
+}
+
+TEST(ShardRing, CONCURRENT)
+{
+    ShardRing   l_ring(4096);
+    const int   l_count = 100000;
+    u_int32_t   l_length;
+    const char  *l_data;
+    int         l_expected = 0;
+
+    // the length of the datagram i is i % 50 + 4, it starts with i
+    std::thread l_producer([&l_ring, l_count] {
+        char    l_datagram[64] = { 0 };
+
+        for (int i = 0; i < l_count; i++)
+        {
+            std::memcpy(l_datagram, &i, sizeof(i));
+            while (!l_ring.push(l_datagram, (u_int32_t)(i % 50 + sizeof(i))))
+                std::this_thread::yield();
+        }
+    });
+
+    while (l_expected < l_count)
+    {
+        int l_value;
+
+        if ((l_data = l_ring.front(l_length)) == nullptr)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        std::memcpy(&l_value, l_data, sizeof(l_value));
+        ASSERT_EQ(l_value, l_expected);
+        ASSERT_EQ(l_length, (u_int32_t)(l_expected % 50 + sizeof(l_value)));
+        l_ring.pop();
+        l_expected++;
+    }
+    l_producer.join();
+
+    EXPECT_EQ(l_ring.pendingBytes(), 0u);
+}
@@ -0,0 +1,45 @@
+#include "sourceTable.hpp"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+TEST(SourceTable, SUCCESS)
+{
+    SourceTable         l_table(10);
+    SourceStats         *l_stats;
+    const SourceStats   *l_found;
+    nlohmann::json      l_json = nlohmann::json::array();
+
+    EXPECT_EQ(l_table.capacity(), 16u);
+    EXPECT_EQ(l_table.find(0), nullptr);
+
+    // sourceID 0 is a valid source
+    ASSERT_NE(l_stats = l_table.insert(0), nullptr);
+    l_stats->notifications[2].store(3);
+    EXPECT_EQ(l_table.insert(0), l_stats);
+
+    ASSERT_NE(l_found = l_table.find(0), nullptr);
+    EXPECT_EQ(l_found->notifications[2].load(), 3u);
+    EXPECT_EQ(l_table.find(1), nullptr);
+
+    l_table.toJson(l_json);
+    ASSERT_EQ(l_json.size(), 1u);
+    EXPECT_EQ(l_json[0].at("sourceID").get<u_int32_t>(), 0u);
+    EXPECT_EQ(l_json[0].at("stats").get<u_int64_t>(), 3u);
+}
+
+TEST(SourceTable, FULL)
+{
+    SourceTable l_table(16);
+
+    for (u_int32_t i = 1000; i < 1016; i++)
+        ASSERT_NE(l_table.insert(i), nullptr);
+    EXPECT_EQ(l_table.size(), 16u);
+
+    // known sources are still found, a new one has no room
+    for (u_int32_t i = 1000; i < 1016; i++)
+        EXPECT_NE(l_table.find(i), nullptr);
+    EXPECT_NE(l_table.insert(1005), nullptr);
+    EXPECT_EQ(l_table.insert(2000), nullptr);
+    EXPECT_EQ(l_table.find(2000), nullptr);
+}
@@ -0,0 +1,165 @@
+#include "../include/apishm.hpp"
+
+#include <time.h>
+
+// cout par paquet de la suppression des doublons, sur un pcap rejoue
+// chaque paquet est rejoue deux fois comme par deux ports miroir : la seconde copie
+// a le ttl decremente, le checksum ip modifie et arrive DUPLICATE_DELAY plus tard
+//
+// usage: ./bench/dedup_bench file.pcap [window_usec] [repeat]
+
+#define DUPLICATE_DELAY 20 // microsecond
+
+typedef struct s_bench_packet
+{
+	struct pcap_pkthdr header;
+	u_int8_t *data;
+} t_bench_packet;
+
+static u_int64_t	bench_now(void)
+{
+	struct timespec	now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (u_int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void	bench_free(t_bench_packet *packets, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		free(packets[i].data);
+	free(packets);
+}
+
+/**
+ * @brief load the pcap in memory, followed by the mirror copy of each packet
+ *
+ * @param file
+ * @param count [out] number of packets, copies included
+ * @return t_bench_packet* NULL on failure, nothing left allocated
+ */
+static t_bench_packet	*bench_load(const char *file, size_t *count)
+{
+	char				errbuf[PCAP_ERRBUF_SIZE];
+	pcap_t				*hdl;
+	struct pcap_pkthdr	*header;
+	const u_char		*data;
+	t_bench_packet		*packets;
+	t_bench_packet		*grown;
+	t_bench_packet		*copy;
+	size_t				capacity;
+	u_int32_t			offset;
+	int					failed;
+
+	if ((hdl = pcap_open_offline(file, errbuf)) == NULL)
+	{
+		fprintf(stderr, "pcap_open_offline : %s\n", errbuf);
+		return NULL;
+	}
+
+	capacity = 1024;
+	packets = (t_bench_packet *)malloc(capacity * sizeof(t_bench_packet));
+	*count = 0;
+	failed = packets == NULL;
+	while (!failed && pcap_next_ex(hdl, &header, &data) == 1)
+	{
+		if (*count + 2 > capacity)
+		{
+			// l'ancien bloc reste valide si realloc echoue
+			grown = (t_bench_packet *)realloc(packets, capacity * 2 * sizeof(t_bench_packet));
+			if (grown == NULL)
+			{
+				failed = 1;
+				break;
+			}
+			packets = grown;
+			capacity *= 2;
+		}
+
+		packets[*count].header = *header;
+		if ((packets[*count].data = (u_int8_t *)malloc(header->caplen)) == NULL)
+		{
+			failed = 1;
+			break;
+		}
+		memcpy(packets[*count].data, data, header->caplen);
+
+		// copie vue par le second port miroir, apres un routeur
+		copy = &packets[*count + 1];
+		copy->header = *header;
+		copy->header.ts.tv_usec += DUPLICATE_DELAY;
+		if (copy->header.ts.tv_usec >= 1000000)
+		{
+			copy->header.ts.tv_sec++;
+			copy->header.ts.tv_usec -= 1000000;
+		}
+		if ((copy->data = (u_int8_t *)malloc(header->caplen)) == NULL)
+		{
+			free(packets[*count].data);
+			failed = 1;
+			break;
+		}
+		memcpy(copy->data, data, header->caplen);
+		offset = ETHER_HDR_LEN;
+		if (header->caplen >= offset + sizeof(struct ip) && copy->data[12] == 0x08 && copy->data[13] == 0x00)
+		{
+			copy->data[offset + 8]--;
+			copy->data[offset + 10] ^= 0x01;
+		}
+		*count += 2;
+	}
+	pcap_close(hdl);
+	if (failed)
+	{
+		fprintf(stderr, "bench_load : memoire insuffisante apres %zu paquets\n", *count);
+		bench_free(packets, *count);
+		return NULL;
+	}
+	return packets;
+}
+
+int		main(int argc, char **argv)
+{
+	static t_dedup	dedup;
+	t_bench_packet	*packets;
+	size_t			count;
+	u_int32_t		window;
+	int				repeat;
+	u_int64_t		start;
+	u_int64_t		elapsed;
+	u_int64_t		drops;
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s file.pcap [window_usec] [repeat]\n", argv[0]);
+		return 1;
+	}
+	window = argc > 2 ? atoi(argv[2]) : DEDUP_WINDOW;
+	repeat = argc > 3 ? atoi(argv[3]) : 10;
+
+	if ((packets = bench_load(argv[1], &count)) == NULL || count == 0)
+	{
+		fprintf(stderr, "aucun paquet dans %s\n", argv[1]);
+		return 1;
+	}
+
+	drops = 0;
+	elapsed = 0;
+	for (int r = 0; r < repeat; r++)
+	{
+		dedup_init(&dedup, window);
+		start = bench_now();
+		for (size_t i = 0; i < count; i++)
+			dedup_is_duplicate(&dedup, &packets[i].header, packets[i].data);
+		elapsed += bench_now() - start;
+		drops = dedup.dropped;
+	}
+
+	printf("packets        : %zu (%zu originals + mirror copies)\n", count, count / 2);
+	printf("window         : %u usec\n", window);
+	printf("dropped        : %lu (expected %zu)\n", (unsigned long)drops, count / 2);
+	printf("cost           : %.1f ns / packet\n", (double)elapsed / ((double)count * repeat));
+
+	bench_free(packets, count);
+	return 0;
+}
@@ -17,29 +17,153 @@
 # include <netinet/in.h>
 # include <netinet/ip.h>
 # include <netinet/if_ether.h>
+# include <sys/time.h>
+# include <sys/resource.h>
+# include <time.h>
 
 #define SHM_MAXLEN 50
 #define SHM_KEY 36
 
 # include "packet_struct.hpp"
 
+// records of the shared ring are aligned on a cache line
+#define RING_ALIGN 64
+#define RING_ALIGN_SIZE(size) (((size) + RING_ALIGN - 1) & ~((size_t)RING_ALIGN - 1))
+
+#define RING_RECORD_PACKET 0
+#define RING_RECORD_PADDING 1 // fill the end of the ring before wrapping to the start
+
+#define RING_MAX_CONSUMER 8
+
+// variable-length record: header followed by the packet bytes
+// the offsets let a consumer go straight to the header it needs, 0 == header not present
 typedef struct s_memory_packet
 {
+	u_int32_t record_length; // header + packet, aligned on RING_ALIGN
+	u_int16_t type; // RING_RECORD_PACKET or RING_RECORD_PADDING
+	u_int16_t network_offset; // ip header
+	u_int16_t transport_offset; // tcp / udp header
+	u_int16_t payload_offset;
 	u_int32_t id;
+	u_int32_t length; // length of the packet in the ring, truncated to the biggest consumer snaplen
+	u_int32_t wire_length; // length of the packet on the interface
 	struct timeval timestamp;
-	u_int32_t length;
-	unsigned char t_memory_packet;
+	unsigned char packet[0];
 } t_memory_packet;
 
+// one per reader, on its own cache line so the readers do not share lines with the writer
+typedef struct s_ring_consumer
+{
+	u_int32_t active;
+	u_int32_t snaplen; // bytes of each packet the consumer reads, 0 == whole packet
+	u_int64_t read_position; // published by the consumer (ring_consumer_commit)
+} __attribute__((aligned(RING_ALIGN))) t_ring_consumer;
+
+// the positions are byte counters which never wrap, the offset in table_packet is position % table_size
+// one writer (capture), lock-free readers which keep their own read position
 typedef struct s_capture_memory
 {
 	u_int32_t capture_id;
-	u_int32_t table_size;
-	u_int32_t table_index;
-	u_int32_t table_size_packet;
-	t_memory_packet table_packet[0];
+	u_int32_t table_size; // size in bytes of table_packet, multiple of RING_ALIGN
+	u_int32_t table_index; // id of the next packet
+	u_int32_t table_size_packet; // biggest record the ring accepts
+	u_int64_t write_reserve; // end of the record being written, published before the copy
+	u_int64_t write_position; // end of the last complete record, published after the copy
+	u_int32_t consumer_generation; // incremented when a consumer registers or leaves
+	u_int32_t snaplen; // biggest snaplen of the consumers, 0 == whole packet (writer only)
+	u_int32_t snaplen_generation; // consumer_generation snaplen was computed for (writer only)
+	t_ring_consumer consumers[RING_MAX_CONSUMER];
+	t_memory_packet table_packet[0] __attribute__((aligned(RING_ALIGN)));
 } t_capture_memory;
 
+// status page of a module launched by a local agent (shared memory, read by the agent at each tick)
+// same layout as StatusPage (agent statusPages.hpp) : change both with the version
+#define STATUS_PAGE_MAGIC 0x54534741 // "AGST"
+#define STATUS_PAGE_VERSION 1
+#define STATUS_PAGE_SIZE 4096
+#define STATUS_PAGE_COUNTERS 16
+#define STATUS_PAGE_ENV "AGENT_STATUS_PAGE" // name of the page, set by the agent in the environment of the module
+
+#define STATUS_STARTING 0
+#define STATUS_RUNNING 1
+#define STATUS_DEGRADED 2
+#define STATUS_STOPPING 3
+
+typedef struct s_status_page
+{
+	u_int32_t magic;
+	u_int32_t version;
+	int32_t module_id;
+	int32_t pid;
+	u_int32_t sequence; // seqlock of the fields below, odd while the module writes them
+	u_int32_t state;
+	u_int64_t heartbeat; // nanosecond, CLOCK_MONOTONIC
+	u_int32_t counter_count;
+	u_int32_t reserved;
+	u_int64_t counters[STATUS_PAGE_COUNTERS] __attribute__((aligned(RING_ALIGN)));
+} t_status_page;
+
+// counters of the capture in its status page, totals since the launch
+#define STATUS_CAPTURE_PACKETS 0
+#define STATUS_CAPTURE_BYTES 1
+#define STATUS_CAPTURE_RING_DROPPED 2
+#define STATUS_CAPTURE_DEDUP_DROPPED 3
+#define STATUS_CAPTURE_BATCHES 4
+#define STATUS_CAPTURE_PCAP_RECEIVED 5 // pcap_stats, refreshed every interval
+#define STATUS_CAPTURE_PCAP_DROPPED 6
+#define STATUS_CAPTURE_PCAP_IFDROPPED 7
+#define STATUS_CAPTURE_RING_HIGH_WATERMARK 8 // of the last interval
+#define STATUS_CAPTURE_COUNTERS 9
+
+// periodic health report of the capture, sent as a STATS notification to the agent protobuf port
+// or written in the status page when the capture is launched by a local agent
+#define CAPTURE_STATS_HOST "127.0.0.1"
+#define CAPTURE_STATS_PORT 2424 // protobuf_port of the agent
+#define CAPTURE_STATS_INTERVAL 1000 // millisecond, when the configuration gives no interval
+
+typedef struct s_capture_stats
+{
+	int socket;
+	struct sockaddr_in agent_address;
+	u_int32_t capture_id;
+	u_int32_t interval; // millisecond between two reports
+	struct timespec start; // CLOCK_MONOTONIC : a change of the wall clock does not distort the rates
+	struct timespec last_report;
+	struct rusage last_usage;
+	u_int64_t packets; // since the last report
+	u_int64_t bytes;
+	u_int64_t ring_dropped; // packets refused by ring_write
+	u_int64_t dedup_dropped; // duplicates of the mirror port not written in the ring
+	u_int64_t batch_count;
+	u_int64_t batch_total;
+	u_int32_t batch_min;
+	u_int32_t batch_max;
+	u_int64_t occupancy_high_watermark; // bytes of the ring not read yet by the slowest consumer
+	t_status_page *status_page; // NULL : reports over udp
+	u_int64_t status_counters[STATUS_CAPTURE_COUNTERS]; // totals of the previous intervals
+} t_capture_stats;
+
+// duplicate suppression of the mirror ports: a packet seen twice within the window is written once
+// one bucket == one cache line, the whole table stays in the l2 cache
+#define DEDUP_BUCKETS 1024 // power of 2
+#define DEDUP_WAYS 4
+#define DEDUP_WINDOW 2000 // microsecond
+#define DEDUP_PREFIX 64 // bytes hashed from the transport header
+
+typedef struct s_dedup_entry
+{
+	u_int64_t hash;
+	u_int64_t timestamp; // microsecond, 0 == free
+} t_dedup_entry;
+
+typedef struct s_dedup
+{
+	u_int64_t window; // microsecond
+	u_int64_t checked;
+	u_int64_t dropped;
+	t_dedup_entry table[DEDUP_BUCKETS][DEDUP_WAYS] __attribute__((aligned(RING_ALIGN)));
+} t_dedup;
+
 struct gre_hdr
 {
 	u_int16_t version : 3,
@@ -54,13 +178,37 @@ struct gre_hdr
 // STATIC
 static int indexShm = 0;
 
-char *error_buffer[PCAP_ERRBUF_SIZE];
+static char *error_buffer[PCAP_ERRBUF_SIZE];
 
 // u_int8_t == u_char
 int		detectionFunc(const u_int8_t *packet, struct pcap_pkthdr packet_header, char *sharedMem);
-int		sharedMem_handler(int key, size_t size, char *sharedMem);
+int		sharedMem_handler(int key, size_t size, char **sharedMem);
 char	*visionFunc(char *device, char *sharedMem, int indexShm, char *error_buffer);
-char	*init_sharedMem(int key, int shm_maxlen);
-int		pcap_manager(char *device, char	*error_buffer);
+char	*init_sharedMem(int key, int size, u_int32_t capture_id); // attach the segment and ring_init it
+int		pcap_manager(char *device, char	*error_buffer, char *sharedMem, u_int32_t capture_id, u_int32_t stats_interval);
+
+// shared ring of variable-length packet records
+int		ring_init(t_capture_memory *ring, u_int32_t capture_id, size_t shared_size);
+int		ring_write(t_capture_memory *ring, const struct pcap_pkthdr *packet_header, const u_int8_t *packet);
+const t_memory_packet	*ring_read(const t_capture_memory *ring, u_int64_t *read_position);
+int		ring_is_valid(const t_capture_memory *ring, u_int64_t read_position);
+int		ring_consumer_register(t_capture_memory *ring, u_int32_t snaplen);
+void	ring_consumer_unregister(t_capture_memory *ring, int consumer);
+void	ring_consumer_commit(t_capture_memory *ring, int consumer, u_int64_t read_position);
+
+// duplicate suppression
+void	dedup_init(t_dedup *dedup, u_int32_t window);
+int		dedup_is_duplicate(t_dedup *dedup, const struct pcap_pkthdr *packet_header, const u_int8_t *packet);
+
+// status page of the module
+t_status_page	*status_page_open(void);
+void	status_page_update(t_status_page *page, u_int32_t state, const u_int64_t *counters, u_int32_t count);
+void	status_page_close(t_status_page *page);
+
+// capture health counters
+int		capture_stats_init(t_capture_stats *stats, u_int32_t capture_id, const char *agent_host, int agent_port, u_int32_t interval);
+void	capture_stats_batch(t_capture_stats *stats, const t_capture_memory *ring, u_int32_t packet_count, u_int64_t byte_count);
+int		capture_stats_report(t_capture_stats *stats, pcap_t *hdl, const t_capture_memory *ring);
+void	capture_stats_close(t_capture_stats *stats, pcap_t *hdl, const t_capture_memory *ring);
 
 #endif
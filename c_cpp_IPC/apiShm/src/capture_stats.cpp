@@ -0,0 +1,326 @@
+#include "../include/apishm.hpp"
+
+#include "notifications.pb.h"
+
+// compteurs de sante de la capture, envoyes periodiquement a l'agent
+// dans une notification STATS (meme port protobuf que les autres modules)
+// lancee par un agent local, la capture ecrit ses compteurs dans sa page de statut a la place
+//
+// capture loop:
+//	stats_enabled = capture_stats_init(&stats, capture_id, CAPTURE_STATS_HOST, CAPTURE_STATS_PORT, stats_interval) == 0;
+//	while ((count = pcap_dispatch(hdl, -1, handler, user)) >= 0)
+//	{
+//		capture_stats_batch(&stats, ring, count, bytes);
+//		capture_stats_report(&stats, hdl, ring);
+//	}
+//	capture_stats_close(&stats, hdl, ring); // last report, even before the first interval
+
+// values of the agent e_sourceType / e_eventType (commonTools.hpp)
+#define STATS_SOURCE_CAPTURE 5
+#define STATS_NOTIFICATION_STATS 2
+#define STATS_PRIORITY_DEFAULT 0
+
+#define STATS_MESSAGE_LEN 1024
+
+// millisecond between two cpu times of getrusage
+static u_int64_t	stats_elapsed(const struct timeval *from, const struct timeval *to)
+{
+	return (to->tv_sec - from->tv_sec) * 1000 + (to->tv_usec - from->tv_usec) / 1000;
+}
+
+// millisecond between two readings of CLOCK_MONOTONIC
+static u_int64_t	stats_clock_elapsed(const struct timespec *from, const struct timespec *to)
+{
+	return (to->tv_sec - from->tv_sec) * 1000 + (to->tv_nsec - from->tv_nsec) / 1000000;
+}
+
+/**
+ * @brief bytes written in the ring and not read yet by the consumer
+ * bigger than table_size when the consumer has been overtaken by the writer
+ *
+ * @param ring
+ * @param consumer
+ * @return u_int64_t
+ */
+static u_int64_t	stats_consumer_lag(const t_capture_memory *ring, int consumer)
+{
+	u_int64_t	write_position;
+	u_int64_t	read_position;
+
+	write_position = __atomic_load_n(&ring->write_position, __ATOMIC_ACQUIRE);
+	read_position = __atomic_load_n(&ring->consumers[consumer].read_position, __ATOMIC_RELAXED);
+	return (read_position < write_position) ? write_position - read_position : 0;
+}
+
+/**
+ * @brief write the totals in the status page : previous intervals + current interval
+ *
+ * @param stats
+ */
+static void	stats_publish(t_capture_stats *stats)
+{
+	u_int64_t	counters[STATUS_CAPTURE_COUNTERS];
+
+	memcpy(counters, stats->status_counters, sizeof(counters));
+	counters[STATUS_CAPTURE_PACKETS] += stats->packets;
+	counters[STATUS_CAPTURE_BYTES] += stats->bytes;
+	counters[STATUS_CAPTURE_RING_DROPPED] += stats->ring_dropped;
+	counters[STATUS_CAPTURE_DEDUP_DROPPED] += stats->dedup_dropped;
+	counters[STATUS_CAPTURE_BATCHES] += stats->batch_count;
+	status_page_update(stats->status_page, STATUS_RUNNING, counters, STATUS_CAPTURE_COUNTERS);
+}
+
+/**
+ * @brief start the counters of the next interval
+ *
+ * @param stats
+ * @param now
+ * @param usage
+ */
+static void	stats_reset(t_capture_stats *stats, const struct timespec *now, const struct rusage *usage)
+{
+	stats->status_counters[STATUS_CAPTURE_PACKETS] += stats->packets;
+	stats->status_counters[STATUS_CAPTURE_BYTES] += stats->bytes;
+	stats->status_counters[STATUS_CAPTURE_RING_DROPPED] += stats->ring_dropped;
+	stats->status_counters[STATUS_CAPTURE_DEDUP_DROPPED] += stats->dedup_dropped;
+	stats->status_counters[STATUS_CAPTURE_BATCHES] += stats->batch_count;
+	stats->status_counters[STATUS_CAPTURE_RING_HIGH_WATERMARK] = stats->occupancy_high_watermark;
+
+	stats->last_report = *now;
+	stats->last_usage = *usage;
+	stats->packets = 0;
+	stats->bytes = 0;
+	stats->ring_dropped = 0;
+	stats->dedup_dropped = 0;
+	stats->batch_count = 0;
+	stats->batch_total = 0;
+	stats->batch_min = 0;
+	stats->batch_max = 0;
+	stats->occupancy_high_watermark = 0;
+}
+
+/**
+ * @brief open the udp socket to the agent, and the status page when the agent is local
+ *
+ * @param stats
+ * @param capture_id sourceID of the notifications
+ * @param agent_host protobuf_host of the agent
+ * @param agent_port protobuf_port of the agent
+ * @param interval millisecond between two reports, 0 : CAPTURE_STATS_INTERVAL
+ * @return int 0 on success, -1 on failure : no socket, the capture must not report
+ */
+int		capture_stats_init(t_capture_stats *stats, u_int32_t capture_id, const char *agent_host, int agent_port, u_int32_t interval)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->socket = -1; // not 0 : stdin
+	stats->capture_id = capture_id;
+	stats->interval = interval ? interval : CAPTURE_STATS_INTERVAL;
+
+	stats->agent_address.sin_family = AF_INET;
+	stats->agent_address.sin_port = htons(agent_port);
+	if (inet_pton(AF_INET, agent_host, &stats->agent_address.sin_addr) != 1)
+	{
+		syslog(LOG_ERR, "capture_stats_init : adresse de l'agent invalide [%s]", agent_host);
+		return -1;
+	}
+
+	if ((stats->socket = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
+	{
+		syslog(LOG_ERR, "capture_stats_init : socket [%s]", strerror(errno));
+		return -1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &stats->start);
+	stats->last_report = stats->start;
+	getrusage(RUSAGE_SELF, &stats->last_usage);
+
+	stats->status_page = status_page_open();
+
+	return 0;
+}
+
+/**
+ * @brief account a batch of packets written in the ring (return of pcap_dispatch)
+ * the ring occupancy is sampled here, once per batch and not per packet
+ *
+ * @param stats
+ * @param ring
+ * @param packet_count
+ * @param byte_count
+ */
+void	capture_stats_batch(t_capture_stats *stats, const t_capture_memory *ring, u_int32_t packet_count, u_int64_t byte_count)
+{
+	u_int64_t	occupancy;
+	u_int64_t	lag;
+
+	if (packet_count == 0)
+		return;
+
+	stats->packets += packet_count;
+	stats->bytes += byte_count;
+	stats->batch_total += packet_count;
+	if (stats->batch_count == 0 || packet_count < stats->batch_min)
+		stats->batch_min = packet_count;
+	if (packet_count > stats->batch_max)
+		stats->batch_max = packet_count;
+	stats->batch_count++;
+
+	occupancy = 0;
+	for (int i = 0; i < RING_MAX_CONSUMER; i++)
+	{
+		if (!__atomic_load_n(&ring->consumers[i].active, __ATOMIC_ACQUIRE))
+			continue;
+		lag = stats_consumer_lag(ring, i);
+		if (lag > occupancy)
+			occupancy = lag;
+	}
+	if (occupancy > ring->table_size)
+		occupancy = ring->table_size;
+	if (occupancy > stats->occupancy_high_watermark)
+		stats->occupancy_high_watermark = occupancy;
+}
+
+/**
+ * @brief send the stats block to the agent when the interval is elapsed (or forced), then reset the counters
+ * with a status page, the page is written at each call (memory only) and nothing is sent
+ *
+ * @param stats
+ * @param hdl
+ * @param ring
+ * @param force report even if the interval is not elapsed (last report of the capture)
+ * @return int
+ */
+static int	stats_report(t_capture_stats *stats, pcap_t *hdl, const t_capture_memory *ring, int force)
+{
+	struct timespec	now;
+	struct rusage	usage;
+	struct pcap_stat	pcap_counters;
+	u_int64_t		elapsed;
+	u_int64_t		cpu_time;
+	char			message[STATS_MESSAGE_LEN];
+	int				length;
+	Notifications	notification;
+	std::string		buffer;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	elapsed = stats_clock_elapsed(&stats->last_report, &now);
+	if (elapsed < stats->interval && !force)
+	{
+		if (stats->status_page != NULL)
+			stats_publish(stats);
+		return 0;
+	}
+	if (elapsed == 0)
+		elapsed = 1; // forced report in the first millisecond: rates per second of a 1 ms interval
+
+	memset(&pcap_counters, 0, sizeof(pcap_counters));
+	if (hdl != NULL && pcap_stats(hdl, &pcap_counters) != 0)
+		syslog(LOG_WARNING, "capture_stats_report : pcap_stats [%s]", pcap_geterr(hdl));
+
+	if (stats->status_page != NULL)
+	{
+		getrusage(RUSAGE_SELF, &usage);
+		stats->status_counters[STATUS_CAPTURE_PCAP_RECEIVED] = pcap_counters.ps_recv;
+		stats->status_counters[STATUS_CAPTURE_PCAP_DROPPED] = pcap_counters.ps_drop;
+		stats->status_counters[STATUS_CAPTURE_PCAP_IFDROPPED] = pcap_counters.ps_ifdrop;
+		stats_reset(stats, &now, &usage);
+		stats_publish(stats);
+		return 1;
+	}
+
+	length = snprintf(message, sizeof(message),
+		"{\"received\":%u,\"dropped\":%u,\"ifdropped\":%u,\"ringDropped\":%lu,\"dedupDropped\":%lu,"
+		"\"packetsPerSec\":%lu,\"bytesPerSec\":%lu,"
+		"\"batchCount\":%lu,\"batchMin\":%u,\"batchMax\":%u,\"batchAvg\":%lu,"
+		"\"ringSize\":%u,\"ringHighWatermark\":%lu,\"consumerLag\":[",
+		pcap_counters.ps_recv, pcap_counters.ps_drop, pcap_counters.ps_ifdrop, (unsigned long)stats->ring_dropped,
+		(unsigned long)stats->dedup_dropped,
+		(unsigned long)(stats->packets * 1000 / elapsed), (unsigned long)(stats->bytes * 1000 / elapsed),
+		(unsigned long)stats->batch_count, stats->batch_min, stats->batch_max,
+		(unsigned long)(stats->batch_count ? stats->batch_total / stats->batch_count : 0),
+		ring->table_size, (unsigned long)stats->occupancy_high_watermark);
+	for (int i = 0; i < RING_MAX_CONSUMER && length < STATS_MESSAGE_LEN; i++)
+	{
+		if (!__atomic_load_n(&ring->consumers[i].active, __ATOMIC_ACQUIRE))
+			continue;
+		length += snprintf(message + length, sizeof(message) - length, "%s{\"consumer\":%d,\"lag\":%lu}",
+			message[length - 1] == '[' ? "" : ",", i, (unsigned long)stats_consumer_lag(ring, i));
+	}
+	if (length < STATS_MESSAGE_LEN)
+		length += snprintf(message + length, sizeof(message) - length, "]}");
+	if (length >= STATS_MESSAGE_LEN)
+	{
+		syslog(LOG_ERR, "capture_stats_report : message trop long [%d]", length);
+		return -1;
+	}
+
+	// cpu of the capture over the interval, in percent
+	getrusage(RUSAGE_SELF, &usage);
+	cpu_time = stats_elapsed(&stats->last_usage.ru_utime, &usage.ru_utime)
+		+ stats_elapsed(&stats->last_usage.ru_stime, &usage.ru_stime);
+
+	notification.set_sourceid(stats->capture_id);
+	notification.set_sourcetype((Notifications_SourceType)STATS_SOURCE_CAPTURE);
+	notification.set_cpuusage(std::to_string(cpu_time * 100 / elapsed));
+	notification.set_ramusage(std::to_string(usage.ru_maxrss)); // kilobytes
+	notification.set_uptime(now.tv_sec - stats->start.tv_sec);
+	notification.set_priority(static_cast<decltype(notification.priority())>(STATS_PRIORITY_DEFAULT));
+	notification.set_notificationtype((Notifications_NotificationType)STATS_NOTIFICATION_STATS);
+	notification.set_sendingdate(time(NULL)); // date for the agent, the wall clock
+	notification.set_message(message, length);
+
+	// the counters of the next interval start now, even if the agent is not reachable
+	stats_reset(stats, &now, &usage);
+
+	if (!notification.SerializeToString(&buffer))
+	{
+		syslog(LOG_ERR, "capture_stats_report : serialisation de la notification");
+		return -1;
+	}
+	if (sendto(stats->socket, buffer.data(), buffer.size(), MSG_DONTWAIT,
+			(struct sockaddr *)&stats->agent_address, sizeof(stats->agent_address)) < 0)
+	{
+		syslog(LOG_WARNING, "capture_stats_report : sendto [%s]", strerror(errno));
+		return -1;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief send the stats block to the agent when the interval is elapsed, then reset the counters
+ * with a status page, the page is written at each call (memory only) and nothing is sent
+ * message of the notification (json):
+ * {"received", "dropped", "ifdropped", "ringDropped", "dedupDropped", "packetsPerSec", "bytesPerSec",
+ *  "batchCount", "batchMin", "batchMax", "batchAvg", "ringSize", "ringHighWatermark",
+ *  "consumerLag": [{"consumer", "lag"}]}
+ *
+ * @param stats
+ * @param hdl pcap handle for pcap_stats, can be NULL
+ * @param ring
+ * @return int 1 if the report was sent (or the page refreshed with pcap_stats), 0 if the interval is not elapsed, -1 on failure
+ */
+int		capture_stats_report(t_capture_stats *stats, pcap_t *hdl, const t_capture_memory *ring)
+{
+	return stats_report(stats, hdl, ring, 0);
+}
+
+/**
+ * @brief send the counters of the last interval, even shorter than stats->interval,
+ * then close the socket to the agent and the status page
+ * a capture stopping before its first interval still sends one report
+ *
+ * @param stats
+ * @param hdl pcap handle for pcap_stats, can be NULL
+ * @param ring
+ */
+void	capture_stats_close(t_capture_stats *stats, pcap_t *hdl, const t_capture_memory *ring)
+{
+	if (stats->socket >= 0 || stats->status_page != NULL)
+		stats_report(stats, hdl, ring, 1);
+	status_page_close(stats->status_page);
+	stats->status_page = NULL;
+	if (stats->socket >= 0)
+		close(stats->socket);
+	stats->socket = -1;
+}
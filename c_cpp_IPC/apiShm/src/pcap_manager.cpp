@@ -1,10 +1,15 @@
 #include "../include/apishm.hpp"
 
-int		pcap_manager(char *device, char	*error_buffer, char *sharedMem)
+// table of the packets already seen, 64 Ko: static rather than on the stack
+static t_dedup	dedup;
+
+int		pcap_manager(char *device, char	*error_buffer, char *sharedMem, u_int32_t capture_id, u_int32_t stats_interval)
 {
 	pcap_t				*hdl;
 	const __u_char 		*packet;
 	struct pcap_pkthdr	packet_header;
+	t_capture_stats		stats;
+	int					stats_enabled;
 	int					packet_count_limit = 1;
 	int					timeout_limit = 10000; // millisecond
 	int					ret = 0;
@@ -16,21 +21,42 @@ int		pcap_manager(char *device, char	*error_buffer, char *sharedMem)
 	
 	hdl = pcap_open_live(device, BUFSIZ, packet_count_limit, timeout_limit, error_buffer);
 
+	// capture_id et intervalle de la configuration (celui passe a init_sharedMem), pas lus dans la memoire partagee
+	// sans socket vers l'agent, la capture continue sans statistiques
+	stats_enabled = capture_stats_init(&stats, capture_id,
+			CAPTURE_STATS_HOST, CAPTURE_STATS_PORT, stats_interval) == 0;
+	if (!stats_enabled)
+		printf("Pas de statistiques envoyees a l'agent\n");
+	dedup_init(&dedup, DEDUP_WINDOW);
+
 	// lit le paquet suivant
 	packet = pcap_next(hdl, &packet_header);
 
 	if (packet == NULL)
 	{
 		printf("Absence de packet");
+		if (stats_enabled)
+			capture_stats_close(&stats, hdl, (t_capture_memory *)sharedMem);
 		return 2;
 	}
 
+	// copie d'un paquet deja recu par l'autre port miroir
+	if (dedup_is_duplicate(&dedup, &packet_header, packet))
+		stats.dedup_dropped++;
+	else if (ring_write((t_capture_memory *)sharedMem, &packet_header, packet) == -1)
+		stats.ring_dropped++;
+	if (stats_enabled)
+	{
+		capture_stats_batch(&stats, (t_capture_memory *)sharedMem, 1, packet_header.caplen);
+		capture_stats_report(&stats, hdl, (t_capture_memory *)sharedMem);
+	}
+
 	detectionFunc(packet, packet_header, sharedMem);	
 
 	visionFunc(device, sharedMem, indexShm, error_buffer);
 
-	printf("sharedmem : [%s]\n", sharedMem + 0);
-
+	if (stats_enabled)
+		capture_stats_close(&stats, hdl, (t_capture_memory *)sharedMem);
 	shmdt(sharedMem);
 
 	return 0;
@@ -0,0 +1,155 @@
+#include "../include/apishm.hpp"
+
+// suppression des doublons des ports miroir (SPAN) avant l'ecriture dans l'anneau
+// un paquet est identifie par un hash de ses champs invariants : l'entete ip sans
+// le ttl / hop limit ni le checksum (modifies par les routeurs entre les deux copies),
+// puis DEDUP_PREFIX octets a partir de l'entete transport
+//
+// le benchmark sur un pcap rejoue est dans bench/dedup_bench.cpp (make bench)
+
+#define DEDUP_MULTIPLIER 0x9e3779b97f4a7c15ULL
+
+static inline u_int64_t	dedup_mix(u_int64_t hash, u_int64_t value)
+{
+	hash ^= value * DEDUP_MULTIPLIER;
+	return (hash << 31 | hash >> 33) * DEDUP_MULTIPLIER;
+}
+
+/**
+ * @brief hash length bytes, 8 at a time
+ *
+ * @param hash
+ * @param data
+ * @param length
+ * @return u_int64_t
+ */
+static u_int64_t	dedup_hash(u_int64_t hash, const u_int8_t *data, u_int32_t length)
+{
+	u_int64_t	word;
+
+	while (length >= 8)
+	{
+		memcpy(&word, data, 8);
+		hash = dedup_mix(hash, word);
+		data += 8;
+		length -= 8;
+	}
+	if (length)
+	{
+		word = 0;
+		memcpy(&word, data, length);
+		hash = dedup_mix(hash, word | (u_int64_t)length << 56);
+	}
+	return hash;
+}
+
+/**
+ * @brief hash of the invariant fields of an ethernet frame
+ * the ethernet header is not hashed for ip packets, the two copies can come from different vlans
+ *
+ * @param packet_header
+ * @param packet
+ * @return u_int64_t
+ */
+static u_int64_t	dedup_packet_hash(const struct pcap_pkthdr *packet_header, const u_int8_t *packet)
+{
+	u_int32_t	caplen;
+	u_int32_t	offset;
+	u_int32_t	header_length;
+	u_int16_t	ether_type;
+	u_int64_t	hash;
+
+	caplen = packet_header->caplen;
+	hash = dedup_mix(0, packet_header->len);
+
+	offset = ETHER_HDR_LEN;
+	if (caplen < offset)
+		return dedup_hash(hash, packet, caplen);
+	ether_type = (packet[12] << 8) | packet[13];
+	if (ether_type == ETHERTYPE_VLAN && caplen >= offset + 4)
+	{
+		ether_type = (packet[16] << 8) | packet[17];
+		offset += 4;
+	}
+
+	if (ether_type == ETHERTYPE_IP && caplen >= offset + sizeof(struct ip))
+	{
+		header_length = (packet[offset] & 0x0f) * 4;
+		if (header_length < sizeof(struct ip) || caplen < offset + header_length)
+			header_length = sizeof(struct ip);
+		hash = dedup_hash(hash, packet + offset, 8); // version .. fragment offset
+		hash = dedup_mix(hash, packet[offset + 9]); // protocol, skip ttl (8) and checksum (10-11)
+		hash = dedup_hash(hash, packet + offset + 12, header_length - 12); // addresses, options
+		offset += header_length;
+	}
+	else if (ether_type == ETHERTYPE_IPV6 && caplen >= offset + 40)
+	{
+		hash = dedup_hash(hash, packet + offset, 7); // skip hop limit (7)
+		hash = dedup_hash(hash, packet + offset + 8, 32); // addresses
+		offset += 40;
+	}
+	else
+		offset = 0; // not ip: whole start of the frame
+
+	if (caplen - offset > DEDUP_PREFIX)
+		caplen = offset + DEDUP_PREFIX;
+	return dedup_hash(hash, packet + offset, caplen - offset);
+}
+
+/**
+ * @brief empty the table
+ *
+ * @param dedup
+ * @param window microsecond between two copies of a packet, 0 == DEDUP_WINDOW
+ */
+void	dedup_init(t_dedup *dedup, u_int32_t window)
+{
+	memset(dedup, 0, sizeof(*dedup));
+	dedup->window = window ? window : DEDUP_WINDOW;
+}
+
+/**
+ * @brief check if the packet was already seen within the window, else remember it
+ * the packet replaces the oldest entry of its bucket
+ *
+ * @param dedup
+ * @param packet_header
+ * @param packet
+ * @return int 1 if the packet is a duplicate and has to be dropped
+ */
+int		dedup_is_duplicate(t_dedup *dedup, const struct pcap_pkthdr *packet_header, const u_int8_t *packet)
+{
+	t_dedup_entry	*bucket;
+	t_dedup_entry	*oldest;
+	u_int64_t		hash;
+	u_int64_t		timestamp;
+	u_int64_t		age;
+
+	hash = dedup_packet_hash(packet_header, packet);
+	timestamp = (u_int64_t)packet_header->ts.tv_sec * 1000000 + packet_header->ts.tv_usec;
+	bucket = dedup->table[hash & (DEDUP_BUCKETS - 1)];
+	oldest = bucket;
+
+	dedup->checked++;
+	for (int i = 0; i < DEDUP_WAYS; i++)
+	{
+		if (bucket[i].hash == hash && bucket[i].timestamp)
+		{
+			// the two copies can be delivered slightly out of order
+			age = timestamp > bucket[i].timestamp ? timestamp - bucket[i].timestamp : bucket[i].timestamp - timestamp;
+			if (age <= dedup->window)
+			{
+				dedup->dropped++;
+				return 1;
+			}
+			oldest = &bucket[i]; // same packet out of the window: refresh its entry
+			break;
+		}
+		if (bucket[i].timestamp < oldest->timestamp)
+			oldest = &bucket[i];
+	}
+
+	oldest->hash = hash;
+	oldest->timestamp = timestamp;
+	return 0;
+}
@@ -1,6 +1,6 @@
 #include "../include/apishm.hpp"
 
-int		sharedMem_handler(int key, size_t size, char *sharedMem)
+int		sharedMem_handler(int key, size_t size, char **sharedMem)
 {
 	int shmid;
 
@@ -9,10 +9,11 @@ int		sharedMem_handler(int key, size_t size, char *sharedMem)
 	{
 		// remplacer par un syslog
 		printf("[capture] shmget: shmget returned %d\n", shmid);
+		return shmid;
 	}
 
 	// attach sharedmem to shmid
-	sharedMem = (char *) shmat(shmid, NULL, 0);
+	*sharedMem = (char *) shmat(shmid, NULL, 0);
 
 	return shmid;
 }
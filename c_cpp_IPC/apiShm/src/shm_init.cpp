@@ -1,16 +1,22 @@
 #include "../include/apishm.hpp"
 
-char	*init_sharedMem(int key, int size, int index_sharedMem)
+char	*init_sharedMem(int key, int size, u_int32_t capture_id)
 {
-	char	*sharedMem;
+	char	*sharedMem = NULL;
 	int		shmid; // return of shmget
 //	key_t	key = ftok(".", 36); // identifiant unique de la memoire paratagee
 
-	shmid = sharedMem_handler(key, size, sharedMem);
+	shmid = sharedMem_handler(key, size, &sharedMem);
+	if (shmid < 0 || sharedMem == (char *)-1)
+		return NULL;
 
-	// 6 au lieu de index_sharedMem
-	memcpy(sharedMem, "toto_", index_sharedMem);
-	printf("sharedMem [%s]\n", sharedMem);
+	// la memoire partagee commence par l'entete de l'anneau : rien d'autre n'est ecrit a l'offset 0
+	if (ring_init((t_capture_memory *)sharedMem, capture_id, size) == -1)
+	{
+		printf("[capture] memoire partagee trop petite pour l'anneau : [%d]\n", size);
+		shmdt(sharedMem);
+		return NULL;
+	}
 
 	return (sharedMem);
 }
@@ -0,0 +1,324 @@
+#include "../include/apishm.hpp"
+
+// anneau de paquets de taille variable en memoire partagee
+// un seul ecrivain (capture), des lecteurs (vision, detection) sans verrou
+//
+// reader loop:
+//	consumer = ring_consumer_register(ring, snaplen);
+//	while ((record = ring_read(ring, &position)) != NULL)
+//	{
+//		length = record->record_length;
+//		... use record->packet + record->network_offset ...
+//		if (ring_is_valid(ring, position))
+//			position += length;
+//	}
+//	ring_consumer_commit(ring, consumer, position);
+
+#define RING_MAX_SNAPLEN 65535
+
+/**
+ * @brief set the header of the ring placed at the start of the shared memory
+ *
+ * @param ring
+ * @param capture_id
+ * @param shared_size size in bytes of the whole shared memory (sharedDataSize)
+ * @return int 0 on success, -1 if the shared memory is too small
+ */
+int		ring_init(t_capture_memory *ring, u_int32_t capture_id, size_t shared_size)
+{
+	size_t	table_size;
+
+	if (shared_size < sizeof(t_capture_memory) + RING_ALIGN)
+		return -1;
+
+	table_size = (shared_size - sizeof(t_capture_memory)) & ~((size_t)RING_ALIGN - 1);
+
+	ring->capture_id = capture_id;
+	ring->table_size = table_size;
+	ring->table_index = 0;
+	ring->table_size_packet = RING_ALIGN_SIZE(sizeof(t_memory_packet) + RING_MAX_SNAPLEN);
+	if (ring->table_size_packet > table_size / 2)
+		ring->table_size_packet = table_size / 2 & ~((size_t)RING_ALIGN - 1);
+	ring->write_reserve = 0;
+	ring->consumer_generation = 0;
+	ring->snaplen = 0;
+	ring->snaplen_generation = 0;
+	memset(ring->consumers, 0, sizeof(ring->consumers));
+	__atomic_store_n(&ring->write_position, 0, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+/**
+ * @brief biggest snaplen of the registered consumers, 0 if one of them wants the whole packet
+ * recomputed by the writer only when a consumer registered or left
+ *
+ * @param ring
+ * @return u_int32_t
+ */
+static u_int32_t	ring_snaplen(t_capture_memory *ring)
+{
+	u_int32_t	generation;
+	u_int32_t	snaplen;
+	int			consumer_count;
+
+	generation = __atomic_load_n(&ring->consumer_generation, __ATOMIC_ACQUIRE);
+	if (generation == ring->snaplen_generation)
+		return ring->snaplen;
+
+	snaplen = 0;
+	consumer_count = 0;
+	for (int i = 0; i < RING_MAX_CONSUMER; i++)
+	{
+		if (!__atomic_load_n(&ring->consumers[i].active, __ATOMIC_ACQUIRE))
+			continue;
+		consumer_count++;
+		if (ring->consumers[i].snaplen == 0)
+		{
+			snaplen = 0;
+			break;
+		}
+		if (ring->consumers[i].snaplen > snaplen)
+			snaplen = ring->consumers[i].snaplen;
+	}
+
+	// no consumer yet: keep the whole packet
+	ring->snaplen = consumer_count ? snaplen : 0;
+	ring->snaplen_generation = generation;
+	return ring->snaplen;
+}
+
+/**
+ * @brief offsets of the ip, transport and payload headers in an ethernet frame
+ * only the first vlan tag, ipv4 and ipv6 without extension headers are followed
+ *
+ * @param record [out]
+ * @param packet
+ * @param caplen
+ */
+static void	ring_packet_offsets(t_memory_packet *record, const u_int8_t *packet, u_int32_t caplen)
+{
+	u_int32_t	offset;
+	u_int16_t	ether_type;
+	u_int8_t	protocol;
+
+	record->network_offset = 0;
+	record->transport_offset = 0;
+	record->payload_offset = 0;
+
+	offset = ETHER_HDR_LEN;
+	if (caplen < offset)
+		return;
+	ether_type = (packet[12] << 8) | packet[13];
+	if (ether_type == ETHERTYPE_VLAN && caplen >= offset + 4)
+	{
+		ether_type = (packet[16] << 8) | packet[17];
+		offset += 4;
+	}
+
+	if (ether_type == ETHERTYPE_IP && caplen >= offset + sizeof(struct ip))
+	{
+		record->network_offset = offset;
+		protocol = packet[offset + 9];
+		offset += (packet[offset] & 0x0f) * 4;
+	}
+	else if (ether_type == ETHERTYPE_IPV6 && caplen >= offset + 40)
+	{
+		record->network_offset = offset;
+		protocol = packet[offset + 6];
+		offset += 40;
+	}
+	else
+		return;
+
+	if (protocol == IPPROTO_TCP && caplen >= offset + 20)
+	{
+		record->transport_offset = offset;
+		offset += (packet[offset + 12] >> 4) * 4;
+	}
+	else if (protocol == IPPROTO_UDP && caplen >= offset + 8)
+	{
+		record->transport_offset = offset;
+		offset += 8;
+	}
+	else
+		return;
+
+	if (offset <= caplen)
+		record->payload_offset = offset;
+}
+
+/**
+ * @brief copy a packet in the next record of the ring
+ * when the record does not fit before the end of the ring, the end is filled
+ * with a padding record and the packet is written at the start
+ *
+ * @param ring
+ * @param packet_header
+ * @param packet
+ * @return int 0 on success, -1 if the packet is bigger than table_size_packet
+ * the packet is truncated to the biggest snaplen of the consumers
+ */
+int		ring_write(t_capture_memory *ring, const struct pcap_pkthdr *packet_header, const u_int8_t *packet)
+{
+	t_memory_packet	*record;
+	size_t			record_length;
+	size_t			remaining;
+	u_int64_t		position;
+	u_int32_t		snaplen;
+	u_int32_t		length;
+
+	// no consumer reads further than the biggest snaplen, the rest of the packet is not copied
+	snaplen = ring_snaplen(ring);
+	length = packet_header->caplen;
+	if (snaplen && length > snaplen)
+		length = snaplen;
+
+	record_length = RING_ALIGN_SIZE(sizeof(t_memory_packet) + length);
+	if (record_length > ring->table_size_packet)
+		return -1;
+
+	position = ring->write_position;
+	remaining = ring->table_size - position % ring->table_size;
+
+	// readers check write_reserve after reading a record, it has to be visible before the copy
+	if (record_length > remaining)
+		__atomic_store_n(&ring->write_reserve, position + remaining + record_length, __ATOMIC_RELAXED);
+	else
+		__atomic_store_n(&ring->write_reserve, position + record_length, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	if (record_length > remaining)
+	{
+		record = (t_memory_packet *)((char *)ring->table_packet + position % ring->table_size);
+		record->record_length = remaining;
+		record->type = RING_RECORD_PADDING;
+		position += remaining;
+	}
+
+	record = (t_memory_packet *)((char *)ring->table_packet + position % ring->table_size);
+	record->record_length = record_length;
+	record->type = RING_RECORD_PACKET;
+	record->id = ring->table_index++;
+	record->length = length;
+	record->wire_length = packet_header->len;
+	record->timestamp = packet_header->ts;
+	ring_packet_offsets(record, packet, length);
+	memcpy(record->packet, packet, length);
+
+	__atomic_store_n(&ring->write_position, position + record_length, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+/**
+ * @brief get the record at read_position, padding records are skipped
+ * a reader overtaken by the writer is moved to the last written record
+ *
+ * @param ring
+ * @param read_position [in/out] position of the returned record
+ * @return const t_memory_packet* NULL if there is no new record
+ */
+const t_memory_packet	*ring_read(const t_capture_memory *ring, u_int64_t *read_position)
+{
+	const t_memory_packet	*record;
+	u_int64_t				write_position;
+	size_t					offset;
+
+	write_position = __atomic_load_n(&ring->write_position, __ATOMIC_ACQUIRE);
+
+	while (*read_position < write_position)
+	{
+		if (!ring_is_valid(ring, *read_position))
+		{
+			*read_position = write_position;
+			return NULL;
+		}
+
+		offset = *read_position % ring->table_size;
+		record = (const t_memory_packet *)((const char *)ring->table_packet + offset);
+
+		if (record->type != RING_RECORD_PADDING)
+			return record;
+
+		if (record->record_length == 0 || record->record_length > ring->table_size - offset)
+		{
+			*read_position = write_position;
+			return NULL;
+		}
+		*read_position += record->record_length;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief check that the record at read_position has not been overwritten
+ * to call after reading a record, before trusting what was read
+ *
+ * @param ring
+ * @param read_position
+ * @return int 1 if the record is still valid
+ */
+int		ring_is_valid(const t_capture_memory *ring, u_int64_t read_position)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return (__atomic_load_n(&ring->write_reserve, __ATOMIC_RELAXED) - read_position <= ring->table_size);
+}
+
+/**
+ * @brief register a reader of the ring
+ * the packets are written truncated to the biggest snaplen of the registered consumers,
+ * a consumer which only reads the headers should give a snaplen covering them (ex. 128)
+ *
+ * @param ring
+ * @param snaplen bytes of each packet the consumer reads, 0 == whole packet
+ * @return int index of the consumer, -1 if all the consumers are taken
+ */
+int		ring_consumer_register(t_capture_memory *ring, u_int32_t snaplen)
+{
+	u_int32_t	inactive;
+
+	for (int i = 0; i < RING_MAX_CONSUMER; i++)
+	{
+		inactive = 0;
+		if (!__atomic_compare_exchange_n(&ring->consumers[i].active, &inactive, 1, false,
+				__ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+			continue;
+
+		ring->consumers[i].snaplen = snaplen;
+		__atomic_store_n(&ring->consumers[i].read_position,
+			__atomic_load_n(&ring->write_position, __ATOMIC_ACQUIRE), __ATOMIC_RELAXED);
+		__atomic_add_fetch(&ring->consumer_generation, 1, __ATOMIC_RELEASE);
+		return i;
+	}
+	return -1;
+}
+
+/**
+ * @brief release the consumer slot
+ *
+ * @param ring
+ * @param consumer index returned by ring_consumer_register
+ */
+void	ring_consumer_unregister(t_capture_memory *ring, int consumer)
+{
+	if (consumer < 0 || consumer >= RING_MAX_CONSUMER)
+		return;
+	__atomic_store_n(&ring->consumers[consumer].active, 0, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&ring->consumer_generation, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief publish the read position of a consumer (lag of the consumer for the capture stats)
+ *
+ * @param ring
+ * @param consumer
+ * @param read_position
+ */
+void	ring_consumer_commit(t_capture_memory *ring, int consumer, u_int64_t read_position)
+{
+	if (consumer < 0 || consumer >= RING_MAX_CONSUMER)
+		return;
+	__atomic_store_n(&ring->consumers[consumer].read_position, read_position, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,105 @@
+#include "../include/apishm.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+
+// page de statut partagee avec l'agent local : compteurs, heartbeat et etat du module
+// l'agent la cree avant de lancer le module et en donne le nom dans STATUS_PAGE_ENV,
+// il la lit a chaque tick sans appel systeme (seqlock), le module n'envoie plus ses stats en udp
+//
+// module:
+//	page = status_page_open(); // NULL : pas d'agent local, stats en udp
+//	while (...)
+//		status_page_update(page, STATUS_RUNNING, counters, count);
+//	status_page_close(page);
+
+/**
+ * @brief map the status page created by the agent
+ *
+ * @return t_status_page* NULL without agent, or if the page is not of this version
+ */
+t_status_page	*status_page_open(void)
+{
+	const char		*name;
+	t_status_page	*page;
+	int				fd;
+
+	if ((name = getenv(STATUS_PAGE_ENV)) == NULL)
+		return NULL;
+
+	if ((fd = shm_open(name, O_RDWR | O_CLOEXEC, 0)) < 0)
+	{
+		syslog(LOG_WARNING, "status_page_open : shm_open [%s] [%s]", name, strerror(errno));
+		return NULL;
+	}
+	page = (t_status_page *)mmap(NULL, STATUS_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (page == MAP_FAILED)
+	{
+		syslog(LOG_WARNING, "status_page_open : mmap [%s] [%s]", name, strerror(errno));
+		return NULL;
+	}
+
+	if (__atomic_load_n(&page->magic, __ATOMIC_ACQUIRE) != STATUS_PAGE_MAGIC || page->version != STATUS_PAGE_VERSION)
+	{
+		syslog(LOG_WARNING, "status_page_open : page [%s] de version %u, %u attendue", name, page->version, STATUS_PAGE_VERSION);
+		munmap(page, STATUS_PAGE_SIZE);
+		return NULL;
+	}
+
+	__atomic_store_n(&page->pid, (int32_t)getpid(), __ATOMIC_RELAXED);
+	status_page_update(page, STATUS_STARTING, NULL, 0);
+	return page;
+}
+
+/**
+ * @brief write the state, the counters and the heartbeat (seqlock, no system call)
+ * sequence odd -> fields -> sequence even : the agent retries a copy taken in between
+ *
+ * @param page can be NULL
+ * @param state STATUS_RUNNING ...
+ * @param counters totals, count values
+ * @param count truncated to STATUS_PAGE_COUNTERS
+ */
+void	status_page_update(t_status_page *page, u_int32_t state, const u_int64_t *counters, u_int32_t count)
+{
+	struct timespec	now;
+	u_int32_t		sequence;
+
+	if (page == NULL)
+		return;
+	if (count > STATUS_PAGE_COUNTERS)
+		count = STATUS_PAGE_COUNTERS;
+
+	// vdso, no system call
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	sequence = __atomic_load_n(&page->sequence, __ATOMIC_RELAXED);
+	__atomic_store_n(&page->sequence, sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	__atomic_store_n(&page->state, state, __ATOMIC_RELAXED);
+	__atomic_store_n(&page->heartbeat, (u_int64_t)now.tv_sec * 1000000000 + now.tv_nsec, __ATOMIC_RELAXED);
+	if (counters != NULL)
+	{
+		for (u_int32_t i = 0; i < count; i++)
+			__atomic_store_n(&page->counters[i], counters[i], __ATOMIC_RELAXED);
+		__atomic_store_n(&page->counter_count, count, __ATOMIC_RELAXED);
+	}
+
+	__atomic_store_n(&page->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief tell the agent the module stops, then unmap the page
+ *
+ * @param page can be NULL
+ */
+void	status_page_close(t_status_page *page)
+{
+	if (page == NULL)
+		return;
+	status_page_update(page, STATUS_STOPPING, NULL, 0);
+	munmap(page, STATUS_PAGE_SIZE);
+}
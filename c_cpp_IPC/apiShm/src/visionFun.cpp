@@ -43,8 +43,9 @@ char	*visionFunc(char *device, char *sharedMem, int indexShm, char *error_buffer
 
 	printf("Device : [%s] | IP address : [%s]\n", device, ip);
 
-	// 5 au lieu de index_sharedMem	
-	memcpy((sharedMem + indexShm), ip, 13);
+	// plus de copie de l'ip dans la memoire partagee : l'offset 0 est l'entete de l'anneau (ring_init)
+	(void)sharedMem;
+	(void)indexShm;
 
 	return 0;
 }